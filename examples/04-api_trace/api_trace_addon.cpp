@@ -4,7 +4,16 @@
  */
 
 #include <reshade.hpp>
+#include "api_trace_format.hpp"
+#include "api_trace_to_string.hpp"
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <type_traits>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <shared_mutex>
 #include <unordered_set>
@@ -14,331 +23,140 @@ using namespace reshade::api;
 namespace
 {
 	bool s_do_capture = false;
+	// Write a compact binary trace instead of a text line to the log for every call, which is much faster for capturing frames with many calls (see api_trace_decode for converting it to text)
+	bool s_binary_trace = false;
+	unsigned int s_binary_trace_index = 0;
+#ifndef NDEBUG
 	std::shared_mutex s_mutex;
 	std::unordered_set<uint64_t> s_samplers;
 	std::unordered_set<uint64_t> s_resources;
 	std::unordered_set<uint64_t> s_resource_views;
 	std::unordered_set<uint64_t> s_pipelines;
+#endif
 
-	inline auto to_string(shader_stage value)
-	{
-		switch (value)
-		{
-		case shader_stage::vertex:
-			return "vertex";
-		case shader_stage::hull:
-			return "hull";
-		case shader_stage::domain:
-			return "domain";
-		case shader_stage::geometry:
-			return "geometry";
-		case shader_stage::pixel:
-			return "pixel";
-		case shader_stage::compute:
-			return "compute";
-		case shader_stage::amplification:
-			return "amplification";
-		case shader_stage::mesh:
-			return "mesh";
-		case shader_stage::raygen:
-			return "raygen";
-		case shader_stage::any_hit:
-			return "any_hit";
-		case shader_stage::closest_hit:
-			return "closest_hit";
-		case shader_stage::miss:
-			return "miss";
-		case shader_stage::intersection:
-			return "intersection";
-		case shader_stage::callable:
-			return "callable";
-		case shader_stage::all:
-			return "all";
-		case shader_stage::all_graphics:
-			return "all_graphics";
-		case shader_stage::all_ray_tracing:
-			return "all_raytracing";
-		default:
-			return "unknown";
-		}
-	}
-	inline auto to_string(pipeline_stage value)
+	// Every thread appends records to its own buffer, so that threads recording command lists in parallel do not have to synchronize with each other
+	// The lock is only contended when the buffers are written to the file at the end of a frame
+	struct trace_thread_buffer
 	{
-		switch (value)
-		{
-		case pipeline_stage::vertex_shader:
-			return "vertex_shader";
-		case pipeline_stage::hull_shader:
-			return "hull_shader";
-		case pipeline_stage::domain_shader:
-			return "domain_shader";
-		case pipeline_stage::geometry_shader:
-			return "geometry_shader";
-		case pipeline_stage::pixel_shader:
-			return "pixel_shader";
-		case pipeline_stage::compute_shader:
-			return "compute_shader";
-		case pipeline_stage::amplification_shader:
-			return "amplification_shader";
-		case pipeline_stage::mesh_shader:
-			return "mesh_shader";
-		case pipeline_stage::input_assembler:
-			return "input_assembler";
-		case pipeline_stage::stream_output:
-			return "stream_output";
-		case pipeline_stage::rasterizer:
-			return "rasterizer";
-		case pipeline_stage::depth_stencil:
-			return "depth_stencil";
-		case pipeline_stage::output_merger:
-			return "output_merger";
-		case pipeline_stage::all:
-			return "all";
-		case pipeline_stage::all_graphics:
-			return "all_graphics";
-		case pipeline_stage::all_ray_tracing:
-			return "all_ray_tracing";
-		case pipeline_stage::all_shader_stages:
-			return "all_shader_stages";
-		default:
-			return "unknown";
-		}
-	}
-	inline auto to_string(descriptor_type value)
+		std::atomic_flag lock = ATOMIC_FLAG_INIT;
+		uint32_t thread_id = 0;
+		std::vector<uint64_t> data;
+	};
+
+	std::mutex s_trace_mutex;
+	FILE *s_trace_file = nullptr;
+	std::vector<std::unique_ptr<trace_thread_buffer>> s_trace_buffers;
+
+	constexpr size_t trace_buffer_size = 64 * 1024; // In 64-bit words
+
+	trace_thread_buffer &get_trace_thread_buffer()
 	{
-		switch (value)
+		thread_local trace_thread_buffer *buffer = nullptr;
+		if (buffer == nullptr)
 		{
-		case descriptor_type::sampler:
-			return "sampler";
-		case descriptor_type::sampler_with_resource_view:
-			return "sampler_with_resource_view";
-		case descriptor_type::shader_resource_view:
-			return "shader_resource_view";
-		case descriptor_type::unordered_access_view:
-			return "unordered_access_view";
-		case descriptor_type::constant_buffer:
-			return "constant_buffer";
-		case descriptor_type::acceleration_structure:
-			return "acceleration_structure";
-		default:
-			return "unknown";
+			const std::unique_lock<std::mutex> lock(s_trace_mutex);
+
+			buffer = s_trace_buffers.emplace_back(std::make_unique<trace_thread_buffer>()).get();
+			buffer->thread_id = GetCurrentThreadId();
+			buffer->data.reserve(trace_buffer_size);
 		}
+		return *buffer;
 	}
-	inline auto to_string(dynamic_state value)
+
+	// Expects 's_trace_mutex' and the lock of the buffer to be held
+	void write_trace_buffer(trace_thread_buffer &buffer)
 	{
-		switch (value)
+		if (s_trace_file != nullptr && !buffer.data.empty())
 		{
-		default:
-		case dynamic_state::unknown:
-			return "unknown";
-		case dynamic_state::alpha_test_enable:
-			return "alpha_test_enable";
-		case dynamic_state::alpha_reference_value:
-			return "alpha_reference_value";
-		case dynamic_state::alpha_func:
-			return "alpha_func";
-		case dynamic_state::srgb_write_enable:
-			return "srgb_write_enable";
-		case dynamic_state::primitive_topology:
-			return "primitive_topology";
-		case dynamic_state::sample_mask:
-			return "sample_mask";
-		case dynamic_state::alpha_to_coverage_enable:
-			return "alpha_to_coverage_enable";
-		case dynamic_state::blend_enable:
-			return "blend_enable";
-		case dynamic_state::logic_op_enable:
-			return "logic_op_enable";
-		case dynamic_state::color_blend_op:
-			return "color_blend_op";
-		case dynamic_state::source_color_blend_factor:
-			return "src_color_blend_factor";
-		case dynamic_state::dest_color_blend_factor:
-			return "dst_color_blend_factor";
-		case dynamic_state::alpha_blend_op:
-			return "alpha_blend_op";
-		case dynamic_state::source_alpha_blend_factor:
-			return "src_alpha_blend_factor";
-		case dynamic_state::dest_alpha_blend_factor:
-			return "dst_alpha_blend_factor";
-		case dynamic_state::logic_op:
-			return "logic_op";
-		case dynamic_state::blend_constant:
-			return "blend_constant";
-		case dynamic_state::render_target_write_mask:
-			return "render_target_write_mask";
-		case dynamic_state::fill_mode:
-			return "fill_mode";
-		case dynamic_state::cull_mode:
-			return "cull_mode";
-		case dynamic_state::front_counter_clockwise:
-			return "front_counter_clockwise";
-		case dynamic_state::depth_bias:
-			return "depth_bias";
-		case dynamic_state::depth_bias_clamp:
-			return "depth_bias_clamp";
-		case dynamic_state::depth_bias_slope_scaled:
-			return "depth_bias_slope_scaled";
-		case dynamic_state::depth_clip_enable:
-			return "depth_clip_enable";
-		case dynamic_state::scissor_enable:
-			return "scissor_enable";
-		case dynamic_state::multisample_enable:
-			return "multisample_enable";
-		case dynamic_state::antialiased_line_enable:
-			return "antialiased_line_enable";
-		case dynamic_state::depth_enable:
-			return "depth_enable";
-		case dynamic_state::depth_write_mask:
-			return "depth_write_mask";
-		case dynamic_state::depth_func:
-			return "depth_func";
-		case dynamic_state::stencil_enable:
-			return "stencil_enable";
-		case dynamic_state::front_stencil_read_mask:
-			return "front_stencil_read_mask";
-		case dynamic_state::front_stencil_write_mask:
-			return "front_stencil_write_mask";
-		case dynamic_state::front_stencil_reference_value:
-			return "front_stencil_reference_value";
-		case dynamic_state::front_stencil_func:
-			return "front_stencil_func";
-		case dynamic_state::front_stencil_pass_op:
-			return "front_stencil_pass_op";
-		case dynamic_state::front_stencil_fail_op:
-			return "front_stencil_fail_op";
-		case dynamic_state::front_stencil_depth_fail_op:
-			return "front_stencil_depth_fail_op";
-		case dynamic_state::back_stencil_read_mask:
-			return "back_stencil_read_mask";
-		case dynamic_state::back_stencil_write_mask:
-			return "back_stencil_write_mask";
-		case dynamic_state::back_stencil_reference_value:
-			return "back_stencil_reference_value";
-		case dynamic_state::back_stencil_func:
-			return "back_stencil_func";
-		case dynamic_state::back_stencil_pass_op:
-			return "back_stencil_pass_op";
-		case dynamic_state::back_stencil_fail_op:
-			return "back_stencil_fail_op";
-		case dynamic_state::back_stencil_depth_fail_op:
-			return "back_stencil_depth_fail_op";
+			api_trace::chunk_header chunk;
+			chunk.thread_id = buffer.thread_id;
+			chunk.size = static_cast<uint32_t>(buffer.data.size() * sizeof(uint64_t));
+
+			fwrite(&chunk, sizeof(chunk), 1, s_trace_file);
+			fwrite(buffer.data.data(), sizeof(uint64_t), buffer.data.size(), s_trace_file);
 		}
+
+		buffer.data.clear();
 	}
-	inline auto to_string(resource_usage value)
+
+	// Appends a record to the buffer of the current thread and returns a pointer to its arguments, which the caller fills in before calling 'end_trace_record'
+	// This keeps the lock of the buffer held in between, so arguments can be written directly without copying them to a temporary first
+	uint64_t *begin_trace_record(trace_thread_buffer &buffer, api_trace::event event, size_t arg_count)
 	{
-		switch (value)
-		{
-		default:
-		case resource_usage::undefined:
-			return "undefined";
-		case resource_usage::index_buffer:
-			return "index_buffer";
-		case resource_usage::vertex_buffer:
-			return "vertex_buffer";
-		case resource_usage::constant_buffer:
-			return "constant_buffer";
-		case resource_usage::stream_output:
-			return "stream_output";
-		case resource_usage::indirect_argument:
-			return "indirect_argument";
-		case resource_usage::depth_stencil:
-		case resource_usage::depth_stencil_read:
-		case resource_usage::depth_stencil_write:
-			return "depth_stencil";
-		case resource_usage::render_target:
-			return "render_target";
-		case resource_usage::shader_resource:
-		case resource_usage::shader_resource_pixel:
-		case resource_usage::shader_resource_non_pixel:
-			return "shader_resource";
-		case resource_usage::unordered_access:
-			return "unordered_access";
-		case resource_usage::copy_dest:
-			return "copy_dest";
-		case resource_usage::copy_source:
-			return "copy_source";
-		case resource_usage::resolve_dest:
-			return "resolve_dest";
-		case resource_usage::resolve_source:
-			return "resolve_source";
-		case resource_usage::acceleration_structure:
-			return "acceleration_structure";
-		case resource_usage::general:
-			return "general";
-		case resource_usage::present:
-			return "present";
-		case resource_usage::cpu_access:
-			return "cpu_access";
-		}
+		LARGE_INTEGER timestamp;
+		QueryPerformanceCounter(&timestamp);
+
+		api_trace::record_header header;
+		header.timestamp = static_cast<uint64_t>(timestamp.QuadPart);
+		header.event = static_cast<uint16_t>(event);
+		header.arg_count = static_cast<uint16_t>(arg_count);
+		header.reserved = 0;
+
+		while (buffer.lock.test_and_set(std::memory_order_acquire))
+			continue;
+
+		const size_t offset = buffer.data.size();
+		buffer.data.resize(offset + sizeof(header) / sizeof(uint64_t) + arg_count);
+		std::memcpy(buffer.data.data() + offset, &header, sizeof(header));
+
+		return buffer.data.data() + offset + sizeof(header) / sizeof(uint64_t);
 	}
-	inline auto to_string(query_type value)
+	void end_trace_record(trace_thread_buffer &buffer)
 	{
-		switch (value)
+		const bool buffer_full = buffer.data.size() >= trace_buffer_size;
+
+		buffer.lock.clear(std::memory_order_release);
+
+		// Write out full buffers right away, instead of letting them grow for the rest of the frame
+		// This has to take 's_trace_mutex' before the buffer lock, to match the order used when writing all buffers at the end of a frame
+		if (buffer_full)
 		{
-		case query_type::occlusion:
-			return "occlusion";
-		case query_type::binary_occlusion:
-			return "binary_occlusion";
-		case query_type::timestamp:
-			return "timestamp";
-		case query_type::pipeline_statistics:
-			return "pipeline_statistics";
-		case query_type::stream_output_statistics_0:
-			return "stream_output_statistics_0";
-		case query_type::stream_output_statistics_1:
-			return "stream_output_statistics_1";
-		case query_type::stream_output_statistics_2:
-			return "stream_output_statistics_2";
-		case query_type::stream_output_statistics_3:
-			return "stream_output_statistics_3";
-		default:
-			return "unknown";
+			const std::unique_lock<std::mutex> lock(s_trace_mutex);
+
+			while (buffer.lock.test_and_set(std::memory_order_acquire))
+				continue;
+			write_trace_buffer(buffer);
+			buffer.lock.clear(std::memory_order_release);
 		}
 	}
-	inline auto to_string(acceleration_structure_type value)
+
+	void write_trace_record(api_trace::event event, const uint64_t *args, size_t arg_count)
 	{
-		switch (value)
-		{
-		case acceleration_structure_type::top_level:
-			return "top_level";
-		case acceleration_structure_type::bottom_level:
-			return "bottom_level";
-		default:
-		case acceleration_structure_type::generic:
-			return "generic";
-		}
+		trace_thread_buffer &buffer = get_trace_thread_buffer();
+
+		uint64_t *const record_args = begin_trace_record(buffer, event, arg_count);
+		std::memcpy(record_args, args, arg_count * sizeof(uint64_t));
+		end_trace_record(buffer);
 	}
-	inline auto to_string(acceleration_structure_copy_mode value)
+
+	template <typename T>
+	inline uint64_t to_trace_arg(T value)
 	{
-		switch (value)
+		if constexpr (std::is_floating_point_v<T>)
 		{
-		case acceleration_structure_copy_mode::clone:
-			return "clone";
-		case acceleration_structure_copy_mode::compact:
-			return "compact";
-		case acceleration_structure_copy_mode::serialize:
-			return "serialize";
-		case acceleration_structure_copy_mode::deserialize:
-			return "deserialize";
-		default:
-			return "unknown";
+			const float float_value = static_cast<float>(value);
+			uint32_t bits;
+			std::memcpy(&bits, &float_value, sizeof(bits));
+			return bits;
 		}
+		else if constexpr (std::is_enum_v<T>)
+			return static_cast<uint64_t>(value);
+		else if constexpr (std::is_integral_v<T>)
+			return static_cast<uint64_t>(static_cast<int64_t>(value)); // Sign extend signed integers
+		else
+			return value.handle;
 	}
-	inline auto to_string(acceleration_structure_build_mode value)
+
+	template <typename... Args>
+	inline void trace(api_trace::event event, Args... args)
 	{
-		switch (value)
-		{
-		case acceleration_structure_build_mode::build:
-			return "build";
-		case acceleration_structure_build_mode::update:
-			return "update";
-		default:
-			return "unknown";
-		}
+		const uint64_t values[sizeof...(Args) + 1] = { to_trace_arg(args)... };
+		write_trace_record(event, values, sizeof...(Args));
 	}
 }
 
+// Only need to track objects for validating handles in debug builds, so avoid the locking overhead otherwise
+#ifndef NDEBUG
 static void on_init_swapchain(swapchain *swapchain, bool)
 {
 	const std::unique_lock<std::shared_mutex> lock(s_mutex);
@@ -422,6 +240,7 @@ static void on_destroy_pipeline(device *device, pipeline handle)
 	assert(s_pipelines.find(handle.handle) != s_pipelines.end());
 	s_pipelines.erase(handle.handle);
 }
+#endif
 
 static void on_barrier(command_list *, uint32_t num_resources, const resource *resources, const resource_usage *old_states, const resource_usage *new_states)
 {
@@ -436,6 +255,13 @@ static void on_barrier(command_list *, uint32_t num_resources, const resource *r
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		for (uint32_t i = 0; i < num_resources; ++i)
+			trace(api_trace::event::barrier, resources[i], old_states[i], new_states[i]);
+		return;
+	}
+
 	for (uint32_t i = 0; i < num_resources; ++i)
 	{
 		std::stringstream s;
@@ -449,6 +275,18 @@ static void on_begin_render_pass(command_list *, uint32_t count, const render_pa
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		trace_thread_buffer &buffer = get_trace_thread_buffer();
+
+		uint64_t *const args = begin_trace_record(buffer, api_trace::event::begin_render_pass, 1 + count);
+		args[0] = ds != nullptr ? ds->view.handle : 0;
+		for (uint32_t i = 0; i < count; ++i)
+			args[1 + i] = rts[i].view.handle;
+		end_trace_record(buffer);
+		return;
+	}
+
 	std::stringstream s;
 	s << "begin_render_pass(" << count << ", { ";
 	for (uint32_t i = 0; i < count; ++i)
@@ -462,6 +300,12 @@ static void on_end_render_pass(command_list *)
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::end_render_pass);
+		return;
+	}
+
 	std::stringstream s;
 	s << "end_render_pass()";
 
@@ -481,6 +325,18 @@ static void on_bind_render_targets_and_depth_stencil(command_list *, uint32_t co
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace_thread_buffer &buffer = get_trace_thread_buffer();
+
+		uint64_t *const args = begin_trace_record(buffer, api_trace::event::bind_render_targets_and_depth_stencil, 1 + count);
+		args[0] = dsv.handle;
+		for (uint32_t i = 0; i < count; ++i)
+			args[1 + i] = rtvs[i].handle;
+		end_trace_record(buffer);
+		return;
+	}
+
 	std::stringstream s;
 	s << "bind_render_targets_and_depth_stencil(" << count << ", { ";
 	for (uint32_t i = 0; i < count; ++i)
@@ -502,6 +358,12 @@ static void on_bind_pipeline(command_list *, pipeline_stage type, pipeline pipel
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::bind_pipeline, type, pipeline);
+		return;
+	}
+
 	std::stringstream s;
 	s << "bind_pipeline(" << to_string(type) << ", " << (void *)pipeline.handle << ")";
 
@@ -512,6 +374,13 @@ static void on_bind_pipeline_states(command_list *, uint32_t count, const dynami
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+			trace(api_trace::event::bind_pipeline_state, states[i], values[i]);
+		return;
+	}
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		std::stringstream s;
@@ -524,6 +393,12 @@ static void on_bind_viewports(command_list *, uint32_t first, uint32_t count, co
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::bind_viewports, first, count);
+		return;
+	}
+
 	std::stringstream s;
 	s << "bind_viewports(" << first << ", " << count << ", { ... })";
 
@@ -534,6 +409,12 @@ static void on_bind_scissor_rects(command_list *, uint32_t first, uint32_t count
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::bind_scissor_rects, first, count);
+		return;
+	}
+
 	std::stringstream s;
 	s << "bind_scissor_rects(" << first << ", " << count << ", { ... })";
 
@@ -544,6 +425,21 @@ static void on_push_constants(command_list *, shader_stage stages, pipeline_layo
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		trace_thread_buffer &buffer = get_trace_thread_buffer();
+
+		uint64_t *const args = begin_trace_record(buffer, api_trace::event::push_constants, 4 + count);
+		args[0] = to_trace_arg(stages);
+		args[1] = layout.handle;
+		args[2] = param_index;
+		args[3] = first;
+		for (uint32_t i = 0; i < count; ++i)
+			args[4 + i] = static_cast<const uint32_t *>(values)[i];
+		end_trace_record(buffer);
+		return;
+	}
+
 	std::stringstream s;
 	s << "push_constants(" << to_string(stages) << ", " << (void *)layout.handle << ", " << param_index << ", " << first << ", " << count << ", { ";
 	for (uint32_t i = 0; i < count; ++i)
@@ -586,6 +482,12 @@ static void on_push_descriptors(command_list *, shader_stage stages, pipeline_la
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::push_descriptors, stages, layout, param_index, update.type, update.binding, update.count);
+		return;
+	}
+
 	std::stringstream s;
 	s << "push_descriptors(" << to_string(stages) << ", " << (void *)layout.handle << ", " << param_index << ", { " << to_string(update.type) << ", " << update.binding << ", " << update.count << " })";
 
@@ -596,6 +498,13 @@ static void on_bind_descriptor_tables(command_list *, shader_stage stages, pipel
 	if (!s_do_capture)
 		return;
 
+	if (s_binary_trace)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+			trace(api_trace::event::bind_descriptor_table, stages, layout, first + i, tables[i]);
+		return;
+	}
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		std::stringstream s;
@@ -615,6 +524,12 @@ static void on_bind_index_buffer(command_list *, resource buffer, uint64_t offse
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::bind_index_buffer, buffer, offset, index_size);
+		return;
+	}
+
 	std::stringstream s;
 	s << "bind_index_buffer(" << (void *)buffer.handle << ", " << offset << ", " << index_size << ")";
 
@@ -633,6 +548,13 @@ static void on_bind_vertex_buffers(command_list *, uint32_t first, uint32_t coun
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+			trace(api_trace::event::bind_vertex_buffer, first + i, buffers[i], offsets != nullptr ? offsets[i] : 0, strides != nullptr ? strides[i] : 0);
+		return;
+	}
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		std::stringstream s;
@@ -646,6 +568,12 @@ static bool on_draw(command_list *, uint32_t vertices, uint32_t instances, uint3
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::draw, vertices, instances, first_vertex, first_instance);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "draw(" << vertices << ", " << instances << ", " << first_vertex << ", " << first_instance << ")";
 
@@ -658,6 +586,12 @@ static bool on_draw_indexed(command_list *, uint32_t indices, uint32_t instances
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::draw_indexed, indices, instances, first_index, vertex_offset, first_instance);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "draw_indexed(" << indices << ", " << instances << ", " << first_index << ", " << vertex_offset << ", " << first_instance << ")";
 
@@ -670,6 +604,12 @@ static bool on_dispatch(command_list *, uint32_t group_count_x, uint32_t group_c
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::dispatch, group_count_x, group_count_y, group_count_z);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "dispatch(" << group_count_x << ", " << group_count_y << ", " << group_count_z << ")";
 
@@ -682,6 +622,12 @@ static bool on_dispatch_mesh(command_list *, uint32_t group_count_x, uint32_t gr
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::dispatch_mesh, group_count_x, group_count_y, group_count_z);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "dispatch_mesh(" << group_count_x << ", " << group_count_y << ", " << group_count_z << ")";
 
@@ -694,6 +640,12 @@ static bool on_dispatch_rays(command_list *, resource raygen, uint64_t raygen_of
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::dispatch_rays, raygen, raygen_offset, raygen_size, miss, miss_offset, miss_size, miss_stride, hit_group, hit_group_offset, hit_group_size, hit_group_stride, callable, callable_offset, callable_size, callable_stride, width, height, depth);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "dispatch_rays(" << (void *)raygen.handle << ", " << raygen_offset << ", " << raygen_size << ", " << (void *)miss.handle << ", " << miss_offset << ", " << miss_size << ", " << miss_stride << (void *)hit_group.handle << ", " << hit_group_offset << ", " << hit_group_size << ", " << hit_group_stride << ", " << (void *)callable.handle << ", " << callable_offset << ", " << callable_size << ", " << callable_stride << ", " << width << ", " << height << ", " << depth << ")";
 
@@ -706,6 +658,12 @@ static bool on_draw_or_dispatch_indirect(command_list *, indirect_command type,
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::draw_or_dispatch_indirect, type, buffer, offset, draw_count, stride);
+		return false;
+	}
+
 	std::stringstream s;
 	switch (type)
 	{
@@ -747,6 +705,12 @@ static bool on_copy_resource(command_list *, resource src, resource dst)
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_resource, src, dst);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_resource(" << (void *)src.handle << ", " << (void *)dst.handle << ")";
 
@@ -767,6 +731,12 @@ static bool on_copy_buffer_region(command_list *, resource src, uint64_t src_off
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_buffer_region, src, src_offset, dst, dst_offset, size);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_buffer_region(" << (void *)src.handle << ", " << src_offset << ", " << (void *)dst.handle << ", " << dst_offset << ", " << size << ")";
 
@@ -787,6 +757,12 @@ static bool on_copy_buffer_to_texture(command_list *, resource src, uint64_t src
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_buffer_to_texture, src, src_offset, row_length, slice_height, dst, dst_subresource);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_buffer_to_texture(" << (void *)src.handle << ", " << src_offset << ", " << row_length << ", " << slice_height << ", " << (void *)dst.handle << ", " << dst_subresource << ")";
 
@@ -807,6 +783,12 @@ static bool on_copy_texture_region(command_list *, resource src, uint32_t src_su
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_texture_region, src, src_subresource, dst, dst_subresource, filter);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_texture_region(" << (void *)src.handle << ", " << src_subresource << ", " << (void *)dst.handle << ", " << dst_subresource << ", " << (uint32_t)filter << ")";
 
@@ -827,6 +809,12 @@ static bool on_copy_texture_to_buffer(command_list *, resource src, uint32_t src
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_texture_to_buffer, src, src_subresource, dst, dst_offset, row_length, slice_height);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_texture_to_buffer(" << (void *)src.handle << ", " << src_subresource << ", " << (void *)dst.handle << ", " << dst_offset << ", " << row_length << ", " << slice_height << ")";
 
@@ -847,6 +835,12 @@ static bool on_resolve_texture_region(command_list *, resource src, uint32_t src
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::resolve_texture_region, src, src_subresource, dst, dst_subresource, dst_x, dst_y, dst_z, format);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "resolve_texture_region(" << (void *)src.handle << ", " << src_subresource << ", { ... }, " << (void *)dst.handle << ", " << dst_subresource << ", " << dst_x << ", " << dst_y << ", " << dst_z << ", " << (uint32_t)format << ")";
 
@@ -867,6 +861,12 @@ static bool on_clear_depth_stencil_view(command_list *, resource_view dsv, const
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::clear_depth_stencil_view, dsv, depth != nullptr ? *depth : 0.0f, stencil != nullptr ? *stencil : 0);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "clear_depth_stencil_view(" << (void *)dsv.handle << ", " << (depth != nullptr ? *depth : 0.0f) << ", " << (stencil != nullptr ? *stencil : 0) << ")";
 
@@ -886,6 +886,12 @@ static bool on_clear_render_target_view(command_list *, resource_view rtv, const
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::clear_render_target_view, rtv, color[0], color[1], color[2], color[3]);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "clear_render_target_view(" << (void *)rtv.handle << ", { " << color[0] << ", " << color[1] << ", " << color[2] << ", " << color[3] << " })";
 
@@ -905,6 +911,12 @@ static bool on_clear_unordered_access_view_uint(command_list *, resource_view ua
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::clear_unordered_access_view_uint, uav, values[0], values[1], values[2], values[3]);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "clear_unordered_access_view_uint(" << (void *)uav.handle << ", { " << values[0] << ", " << values[1] << ", " << values[2] << ", " << values[3] << " })";
 
@@ -924,6 +936,12 @@ static bool on_clear_unordered_access_view_float(command_list *, resource_view u
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::clear_unordered_access_view_float, uav, values[0], values[1], values[2], values[3]);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "clear_unordered_access_view_float(" << (void *)uav.handle << ", { " << values[0] << ", " << values[1] << ", " << values[2] << ", " << values[3] << " })";
 
@@ -944,6 +962,12 @@ static bool on_copy_acceleration_structure(command_list *, resource_view source,
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_acceleration_structure, source, dest, mode);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_acceleration_structure(" << (void *)source.handle << ", " << (void *)dest.handle << ", " << to_string(mode) << ")";
 
@@ -963,6 +987,12 @@ static bool on_build_acceleration_structure(command_list *, acceleration_structu
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::build_acceleration_structure, type, flags, input_count, scratch, scratch_offset, source, dest, mode);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "build_acceleration_structure(" << to_string(type) << ", " << std::hex << static_cast<uint32_t>(flags) << std::dec << ", " << input_count << ", { ... }, " << (void *)scratch.handle << ", " << scratch_offset << ", " << (void *)source.handle << ", " << (void *)dest.handle << ", " << to_string(mode) << ")";
 
@@ -983,6 +1013,12 @@ static bool on_generate_mipmaps(command_list *, resource_view srv)
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::generate_mipmaps, srv);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "generate_mipmaps(" << (void *)srv.handle << ")";
 
@@ -996,6 +1032,12 @@ static bool on_begin_query(command_list *cmd_list, query_heap heap, query_type t
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::begin_query, heap, type, index);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "begin_query(" << (void *)heap.handle << ", " << to_string(type) << ", " << index << ")";
 
@@ -1008,6 +1050,12 @@ static bool on_end_query(command_list *cmd_list, query_heap heap, query_type typ
 	if (!s_do_capture)
 		return false;
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::end_query, heap, type, index);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "end_query(" << (void *)heap.handle << ", " << to_string(type) << ", " << index << ")";
 
@@ -1027,6 +1075,12 @@ static bool on_copy_query_heap_results(command_list *cmd_list, query_heap heap,
 	}
 #endif
 
+	if (s_binary_trace)
+	{
+		trace(api_trace::event::copy_query_heap_results, heap, type, first, count, dest, dest_offset, stride);
+		return false;
+	}
+
 	std::stringstream s;
 	s << "copy_query_heap_results(" << (void *)heap.handle << ", " << to_string(type) << ", " << first << ", " << count << (void *)dest.handle << ", " << dest_offset << ", " << stride << ")";
 
@@ -1035,10 +1089,75 @@ static bool on_copy_query_heap_results(command_list *cmd_list, query_heap heap,
 	return false;
 }
 
+static void begin_binary_trace()
+{
+	const std::unique_lock<std::mutex> lock(s_trace_mutex);
+
+	char file_name[32];
+	std::snprintf(file_name, sizeof(file_name), "api_trace_%u.trace", s_binary_trace_index++);
+
+	if (fopen_s(&s_trace_file, file_name, "wb") != 0)
+	{
+		s_trace_file = nullptr;
+		reshade::log::message(reshade::log::level::error, "Failed to open binary trace file!");
+		return;
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	api_trace::file_header header;
+	header.magic = api_trace::file_magic;
+	header.version = api_trace::file_version;
+	header.timestamp_frequency = static_cast<uint64_t>(frequency.QuadPart);
+	fwrite(&header, sizeof(header), 1, s_trace_file);
+
+	// Discard any records that were added after the previous capture ended
+	for (const std::unique_ptr<trace_thread_buffer> &buffer : s_trace_buffers)
+	{
+		while (buffer->lock.test_and_set(std::memory_order_acquire))
+			continue;
+		buffer->data.clear();
+		buffer->lock.clear(std::memory_order_release);
+	}
+
+	char message[64];
+	std::snprintf(message, sizeof(message), "--- Frame --- (writing binary trace to \"%s\")", file_name);
+	reshade::log::message(reshade::log::level::info, message);
+}
+static void end_binary_trace()
+{
+	const std::unique_lock<std::mutex> lock(s_trace_mutex);
+
+	for (const std::unique_ptr<trace_thread_buffer> &buffer : s_trace_buffers)
+	{
+		while (buffer->lock.test_and_set(std::memory_order_acquire))
+			continue;
+		write_trace_buffer(*buffer);
+		buffer->lock.clear(std::memory_order_release);
+	}
+
+	if (s_trace_file != nullptr)
+	{
+		fclose(s_trace_file);
+		s_trace_file = nullptr;
+	}
+
+	reshade::log::message(reshade::log::level::info, "--- End Frame ---");
+}
+
 static void on_present(effect_runtime *runtime)
 {
 	if (s_do_capture)
 	{
+		if (s_binary_trace)
+		{
+			trace(api_trace::event::present);
+			s_do_capture = false;
+			end_binary_trace();
+			return;
+		}
+
 		reshade::log::message(reshade::log::level::info, "present()");
 		reshade::log::message(reshade::log::level::info, "--- End Frame ---");
 		s_do_capture = false;
@@ -1048,6 +1167,14 @@ static void on_present(effect_runtime *runtime)
 		// The keyboard shortcut to trigger logging
 		if (runtime->is_key_pressed(VK_F10))
 		{
+			if (s_binary_trace)
+			{
+				begin_binary_trace();
+				trace(api_trace::event::frame_begin);
+				s_do_capture = true;
+				return;
+			}
+
 			s_do_capture = true;
 			reshade::log::message(reshade::log::level::info, "--- Frame ---");
 		}
@@ -1055,7 +1182,7 @@ static void on_present(effect_runtime *runtime)
 }
 
 extern "C" __declspec(dllexport) const char *NAME = "API Trace";
-extern "C" __declspec(dllexport) const char *DESCRIPTION = "Example add-on that logs the graphics API calls done by the application of the next frame after pressing a keyboard shortcut.";
+extern "C" __declspec(dllexport) const char *DESCRIPTION = "Example add-on that logs the graphics API calls done by the application of the next frame after pressing a keyboard shortcut (either as text to the log or, with \"BinaryTrace=1\" in the [API_TRACE] section, as a compact binary trace file).";
 
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 {
@@ -1065,6 +1192,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		if (!reshade::register_addon(hModule))
 			return FALSE;
 
+		reshade::get_config_value(nullptr, "API_TRACE", "BinaryTrace", s_binary_trace);
+
+#ifndef NDEBUG
 		reshade::register_event<reshade::addon_event::init_swapchain>(on_init_swapchain);
 		reshade::register_event<reshade::addon_event::destroy_swapchain>(on_destroy_swapchain);
 		reshade::register_event<reshade::addon_event::init_sampler>(on_init_sampler);
@@ -1075,6 +1205,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		reshade::register_event<reshade::addon_event::destroy_resource_view>(on_destroy_resource_view);
 		reshade::register_event<reshade::addon_event::init_pipeline>(on_init_pipeline);
 		reshade::register_event<reshade::addon_event::destroy_pipeline>(on_destroy_pipeline);
+#endif
 
 		reshade::register_event<reshade::addon_event::barrier>(on_barrier);
 		reshade::register_event<reshade::addon_event::begin_render_pass>(on_begin_render_pass);
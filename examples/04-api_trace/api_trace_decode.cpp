@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#include "api_trace_format.hpp"
+#include "api_trace_to_string.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace reshade::api;
+
+struct decoded_record
+{
+	uint32_t thread_id;
+	api_trace::record_header header;
+	size_t arg_offset;
+};
+
+static const char *get_event_name(const decoded_record &record, const std::vector<uint64_t> &args)
+{
+	const auto event = static_cast<api_trace::event>(record.header.event);
+
+	// The indirect command type is the first argument, so print the name of the actual command instead
+	if (event == api_trace::event::draw_or_dispatch_indirect && record.header.arg_count != 0)
+	{
+		switch (static_cast<indirect_command>(args[record.arg_offset]))
+		{
+		case indirect_command::draw:
+			return "draw_indirect";
+		case indirect_command::draw_indexed:
+			return "draw_indexed_indirect";
+		case indirect_command::dispatch:
+			return "dispatch_indirect";
+		case indirect_command::dispatch_mesh:
+			return "dispatch_mesh_indirect";
+		case indirect_command::dispatch_rays:
+			return "dispatch_rays_indirect";
+		default:
+			break;
+		}
+	}
+
+	if (record.header.event < static_cast<uint16_t>(api_trace::event::count))
+		return api_trace::event_infos[record.header.event].name;
+	else
+		return "unknown";
+}
+
+static std::string format_args(const decoded_record &record, const std::vector<uint64_t> &args)
+{
+	const char *format = "";
+	if (record.header.event < static_cast<uint16_t>(api_trace::event::count))
+		format = api_trace::event_infos[record.header.event].args;
+
+	std::string result;
+	char buffer[64];
+
+	for (size_t i = 0, format_index = 0; i < record.header.arg_count; ++i)
+	{
+		const uint64_t value = args[record.arg_offset + i];
+
+		// Repeat the previous character if the next one is a '*', and fall back to hexadecimal once the format string is exhausted
+		char type = 'x';
+		if (format[format_index] == '*')
+			type = format_index != 0 ? format[format_index - 1] : 'x';
+		else if (format[format_index] != '\0')
+			type = format[format_index++];
+
+		if (i != 0)
+			result += ", ";
+
+		switch (type)
+		{
+		case 'u':
+			std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+			result += buffer;
+			break;
+		case 'i':
+			std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+			result += buffer;
+			break;
+		case 'h':
+		case 'x':
+			std::snprintf(buffer, sizeof(buffer), "%#llx", static_cast<unsigned long long>(value));
+			result += buffer;
+			break;
+		case 'f':
+		{
+			const uint32_t bits = static_cast<uint32_t>(value);
+			float float_value;
+			std::memcpy(&float_value, &bits, sizeof(float_value));
+			std::snprintf(buffer, sizeof(buffer), "%f", float_value);
+			result += buffer;
+			break;
+		}
+		case 'S':
+			result += to_string(static_cast<shader_stage>(value));
+			break;
+		case 'P':
+			result += to_string(static_cast<pipeline_stage>(value));
+			break;
+		case 'D':
+			result += to_string(static_cast<descriptor_type>(value));
+			break;
+		case 'Y':
+			result += to_string(static_cast<dynamic_state>(value));
+			break;
+		case 'R':
+			result += to_string(static_cast<resource_usage>(value));
+			break;
+		case 'Q':
+			result += to_string(static_cast<query_type>(value));
+			break;
+		case 'A':
+			result += to_string(static_cast<acceleration_structure_type>(value));
+			break;
+		case 'C':
+			result += to_string(static_cast<acceleration_structure_copy_mode>(value));
+			break;
+		case 'B':
+			result += to_string(static_cast<acceleration_structure_build_mode>(value));
+			break;
+		}
+	}
+
+	return result;
+}
+
+static bool read_trace(FILE *file, api_trace::file_header &header, std::vector<decoded_record> &records, std::vector<uint64_t> &args)
+{
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != api_trace::file_magic)
+	{
+		std::fprintf(stderr, "Input is not a binary API trace file.\n");
+		return false;
+	}
+	if (header.version != api_trace::file_version)
+	{
+		std::fprintf(stderr, "Unsupported binary API trace file version %u.\n", header.version);
+		return false;
+	}
+
+	api_trace::chunk_header chunk;
+	std::vector<uint64_t> chunk_data;
+	while (fread(&chunk, sizeof(chunk), 1, file) == 1)
+	{
+		chunk_data.resize(chunk.size / sizeof(uint64_t));
+		if (fread(chunk_data.data(), sizeof(uint64_t), chunk_data.size(), file) != chunk_data.size())
+		{
+			std::fprintf(stderr, "Binary API trace file is truncated.\n");
+			return false;
+		}
+
+		constexpr size_t header_size = sizeof(api_trace::record_header) / sizeof(uint64_t);
+
+		for (size_t offset = 0; offset + header_size <= chunk_data.size();)
+		{
+			decoded_record &record = records.emplace_back();
+			record.thread_id = chunk.thread_id;
+			std::memcpy(&record.header, chunk_data.data() + offset, sizeof(record.header));
+			offset += header_size;
+
+			record.header.arg_count = static_cast<uint16_t>(std::min<size_t>(record.header.arg_count, chunk_data.size() - offset));
+			record.arg_offset = args.size();
+			args.insert(args.end(), chunk_data.begin() + offset, chunk_data.begin() + offset + record.header.arg_count);
+			offset += record.header.arg_count;
+		}
+	}
+
+	// Chunks of different threads are interleaved in the order their buffers were written, so restore the order in which the calls happened
+	std::stable_sort(records.begin(), records.end(),
+		[](const decoded_record &lhs, const decoded_record &rhs) { return lhs.header.timestamp < rhs.header.timestamp; });
+
+	return true;
+}
+
+static void write_text(FILE *file, const api_trace::file_header &header, const std::vector<decoded_record> &records, const std::vector<uint64_t> &args)
+{
+	const uint64_t base_timestamp = records.empty() ? 0 : records.front().header.timestamp;
+
+	for (const decoded_record &record : records)
+	{
+		const double time = static_cast<double>(record.header.timestamp - base_timestamp) * 1000000.0 / static_cast<double>(header.timestamp_frequency);
+
+		std::fprintf(file, "%12.3f us [%5u] %s(%s)\n", time, record.thread_id, get_event_name(record, args), format_args(record, args).c_str());
+	}
+}
+
+static void write_chrome_trace(FILE *file, const api_trace::file_header &header, const std::vector<decoded_record> &records, const std::vector<uint64_t> &args)
+{
+	const uint64_t base_timestamp = records.empty() ? 0 : records.front().header.timestamp;
+
+	std::fprintf(file, "{\"traceEvents\":[\n");
+
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		const decoded_record &record = records[i];
+		const double time = static_cast<double>(record.header.timestamp - base_timestamp) * 1000000.0 / static_cast<double>(header.timestamp_frequency);
+
+		// Render passes and the frame itself are shown as durations, everything else as instant events
+		const char *phase = "i";
+		const char *name = get_event_name(record, args);
+		switch (static_cast<api_trace::event>(record.header.event))
+		{
+		case api_trace::event::frame_begin:
+			phase = "B";
+			name = "frame";
+			break;
+		case api_trace::event::present:
+			phase = "E";
+			name = "frame";
+			break;
+		case api_trace::event::begin_render_pass:
+			phase = "B";
+			name = "render_pass";
+			break;
+		case api_trace::event::end_render_pass:
+			phase = "E";
+			name = "render_pass";
+			break;
+		default:
+			break;
+		}
+
+		// Arguments only contain numbers, identifiers and commas, so do not need escaping
+		std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"%s\",%s\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"args\":\"%s\"}}%s\n",
+			name, phase, phase[0] == 'i' ? "\"s\":\"t\"," : "", time, record.thread_id, format_args(record, args).c_str(), i + 1 < records.size() ? "," : "");
+	}
+
+	std::fprintf(file, "]}\n");
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--chrome") == 0))
+	{
+		std::fprintf(stderr, "usage: %s <input.trace> [--chrome <output.json>]\n", argv[0]);
+		return 1;
+	}
+
+	FILE *input_file = nullptr;
+	if (fopen_s(&input_file, argv[1], "rb") != 0 || input_file == nullptr)
+	{
+		std::fprintf(stderr, "Failed to open input file \"%s\".\n", argv[1]);
+		return 1;
+	}
+
+	api_trace::file_header header = {};
+	std::vector<decoded_record> records;
+	std::vector<uint64_t> args;
+	const bool success = read_trace(input_file, header, records, args);
+
+	fclose(input_file);
+
+	if (!success)
+		return 1;
+
+	if (argc == 4)
+	{
+		FILE *output_file = nullptr;
+		if (fopen_s(&output_file, argv[3], "w") != 0 || output_file == nullptr)
+		{
+			std::fprintf(stderr, "Failed to open output file \"%s\".\n", argv[3]);
+			return 1;
+		}
+
+		write_chrome_trace(output_file, header, records, args);
+
+		fclose(output_file);
+	}
+	else
+	{
+		write_text(stdout, header, records, args);
+	}
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause OR MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary trace files consist of a file header, followed by any number of chunks
+// Each chunk contains the records a single thread wrote since its buffer was last written to the file, which are a record header followed by a number of 64-bit arguments
+namespace api_trace
+{
+	constexpr uint32_t file_magic = 0x52545352; // 'RSTR'
+	constexpr uint32_t file_version = 1;
+
+	struct file_header
+	{
+		uint32_t magic;
+		uint32_t version;
+		// Number of timestamp ticks per second
+		uint64_t timestamp_frequency;
+	};
+
+	struct chunk_header
+	{
+		uint32_t thread_id;
+		// Size of all records in this chunk in bytes
+		uint32_t size;
+	};
+
+	struct record_header
+	{
+		uint64_t timestamp;
+		uint16_t event;
+		uint16_t arg_count;
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(file_header) == 16 && sizeof(chunk_header) == 8 && sizeof(record_header) == 16);
+
+	enum class event : uint16_t
+	{
+		frame_begin,
+		present,
+		barrier,
+		begin_render_pass,
+		end_render_pass,
+		bind_render_targets_and_depth_stencil,
+		bind_pipeline,
+		bind_pipeline_state,
+		bind_viewports,
+		bind_scissor_rects,
+		push_constants,
+		push_descriptors,
+		bind_descriptor_table,
+		bind_index_buffer,
+		bind_vertex_buffer,
+		draw,
+		draw_indexed,
+		dispatch,
+		dispatch_mesh,
+		dispatch_rays,
+		draw_or_dispatch_indirect,
+		copy_resource,
+		copy_buffer_region,
+		copy_buffer_to_texture,
+		copy_texture_region,
+		copy_texture_to_buffer,
+		resolve_texture_region,
+		clear_depth_stencil_view,
+		clear_render_target_view,
+		clear_unordered_access_view_uint,
+		clear_unordered_access_view_float,
+		copy_acceleration_structure,
+		build_acceleration_structure,
+		generate_mipmaps,
+		begin_query,
+		end_query,
+		copy_query_heap_results,
+
+		count
+	};
+
+	struct event_info
+	{
+		const char *name;
+		// One character per argument describing how to print it:
+		//   'u' = unsigned integer, 'i' = signed integer, 'x' = hexadecimal integer, 'h' = handle, 'f' = float
+		//   'S' = shader_stage, 'P' = pipeline_stage, 'D' = descriptor_type, 'Y' = dynamic_state, 'R' = resource_usage, 'Q' = query_type
+		//   'A' = acceleration_structure_type, 'C' = acceleration_structure_copy_mode, 'B' = acceleration_structure_build_mode
+		// A trailing '*' repeats the previous character for all remaining arguments
+		const char *args;
+	};
+
+	constexpr event_info event_infos[] = {
+		{ "frame_begin", "" },
+		{ "present", "" },
+		{ "barrier", "hRR" },
+		{ "begin_render_pass", "hh*" }, // Depth-stencil view, followed by render target views
+		{ "end_render_pass", "" },
+		{ "bind_render_targets_and_depth_stencil", "hh*" }, // Depth-stencil view, followed by render target views
+		{ "bind_pipeline", "Ph" },
+		{ "bind_pipeline_state", "Yu" },
+		{ "bind_viewports", "uu" },
+		{ "bind_scissor_rects", "uu" },
+		{ "push_constants", "Shuux*" }, // Stages, layout, parameter index, first, followed by the constant values
+		{ "push_descriptors", "ShuDuu" },
+		{ "bind_descriptor_table", "Shuh" },
+		{ "bind_index_buffer", "huu" },
+		{ "bind_vertex_buffer", "uhuu" },
+		{ "draw", "uuuu" },
+		{ "draw_indexed", "uuuiu" },
+		{ "dispatch", "uuu" },
+		{ "dispatch_mesh", "uuu" },
+		{ "dispatch_rays", "huuhuuuhuuuhuuuuuu" },
+		{ "draw_or_dispatch_indirect", "uhuuu" },
+		{ "copy_resource", "hh" },
+		{ "copy_buffer_region", "huhuu" },
+		{ "copy_buffer_to_texture", "huuuhu" },
+		{ "copy_texture_region", "huhuu" },
+		{ "copy_texture_to_buffer", "huhuuu" },
+		{ "resolve_texture_region", "huhuiiiu" },
+		{ "clear_depth_stencil_view", "hfu" },
+		{ "clear_render_target_view", "hffff" },
+		{ "clear_unordered_access_view_uint", "huuuu" },
+		{ "clear_unordered_access_view_float", "hffff" },
+		{ "copy_acceleration_structure", "hhC" },
+		{ "build_acceleration_structure", "AxuhuhhB" },
+		{ "generate_mipmaps", "h" },
+		{ "begin_query", "hQu" },
+		{ "end_query", "hQu" },
+		{ "copy_query_heap_results", "hQuuhuu" },
+	};
+
+	static_assert(sizeof(event_infos) / sizeof(event_infos[0]) == static_cast<size_t>(event::count));
+}
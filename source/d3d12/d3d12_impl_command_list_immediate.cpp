@@ -12,8 +12,11 @@ thread_local reshade::d3d12::command_list_immediate_impl *reshade::d3d12::comman
 
 reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_impl *device, ID3D12CommandQueue *queue) :
 	command_list_impl(device, nullptr),
-	_parent_queue(queue)
+	_parent_queue(queue),
+	_type(queue->GetDesc().Type)
 {
+	assert(_type == D3D12_COMMAND_LIST_TYPE_DIRECT || _type == D3D12_COMMAND_LIST_TYPE_COMPUTE);
+
 	// Create multiple command allocators to buffer for multiple frames
 	for (uint32_t i = 0; i < NUM_COMMAND_FRAMES; ++i)
 	{
@@ -21,7 +24,7 @@ reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_
 
 		if (FAILED(_device_impl->_orig->CreateFence(_fence_value[i], D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence[i]))))
 			return;
-		if (FAILED(_device_impl->_orig->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&_cmd_alloc[i]))))
+		if (FAILED(_device_impl->_orig->CreateCommandAllocator(_type, IID_PPV_ARGS(&_cmd_alloc[i]))))
 			return;
 	}
 
@@ -31,13 +34,15 @@ reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_
 		return;
 
 	// Create and open the command list for recording
-	if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
+	if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, _type, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
 	{
 		_orig->SetName(L"ReShade immediate command list");
 		on_init();
 	}
 
-	s_last_immediate_command_list = this;
+	// Compute command lists cannot execute all the commands that 'device_impl::get_immediate_command_list' is used for, so never pick them there
+	if (_type == D3D12_COMMAND_LIST_TYPE_DIRECT)
+		s_last_immediate_command_list = this;
 }
 reshade::d3d12::command_list_immediate_impl::~command_list_immediate_impl()
 {
@@ -107,7 +112,8 @@ void reshade::d3d12::command_list_immediate_impl::query_acceleration_structures(
 
 bool reshade::d3d12::command_list_immediate_impl::flush()
 {
-	s_last_immediate_command_list = this;
+	if (_type == D3D12_COMMAND_LIST_TYPE_DIRECT)
+		s_last_immediate_command_list = this;
 
 	if (!_has_commands)
 		return true;
@@ -128,7 +134,7 @@ bool reshade::d3d12::command_list_immediate_impl::flush()
 
 		// A command list that failed to close can never be reset, so destroy it and create a new one
 		_orig->Release(); _orig = nullptr;
-		if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
+		if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, _type, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
 		{
 			_orig->SetName(L"ReShade immediate command list");
 			on_init();
@@ -27,6 +27,7 @@ namespace reshade::d3d12
 
 	private:
 		ID3D12CommandQueue *const _parent_queue;
+		const D3D12_COMMAND_LIST_TYPE _type;
 		UINT32 _cmd_index = 0;
 		HANDLE _fence_event = nullptr;
 		UINT64 _fence_value[NUM_COMMAND_FRAMES] = {};
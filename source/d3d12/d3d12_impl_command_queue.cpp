@@ -9,15 +9,20 @@
 
 extern void encode_pix3blob(UINT64(&pix3blob)[64], const char *label, const float color[4]);
 
-reshade::d3d12::command_queue_impl::command_queue_impl(device_impl *device, ID3D12CommandQueue *queue) :
+reshade::d3d12::command_queue_impl::command_queue_impl(device_impl *device, ID3D12CommandQueue *queue, bool internal) :
 	api_object_impl(queue),
-	_device_impl(device)
+	_device_impl(device),
+	_internal(internal)
 {
 	// Register queue to device (technically need to lock here, since queues may be created on multiple threads simultaneously via 'ID3D12Device::CreateCommandQueue', but it is unlikely an application actually does that)
-	_device_impl->_queues.push_back(this);
+	// Queues created by ReShade itself are not registered, so that they are not visible to add-ons or used as fallback for the device immediate command list
+	if (!_internal)
+		_device_impl->_queues.push_back(this);
 
 	// Only create an immediate command list for graphics queues (since the implemented commands do not work on other queue types)
-	if (queue->GetDesc().Type == D3D12_COMMAND_LIST_TYPE_DIRECT)
+	// Compute queues created by ReShade itself are the exception, since only compute commands are ever recorded on those
+	if (const D3D12_COMMAND_LIST_TYPE type = queue->GetDesc().Type;
+		type == D3D12_COMMAND_LIST_TYPE_DIRECT || (internal && type == D3D12_COMMAND_LIST_TYPE_COMPUTE))
 	{
 		_immediate_cmd_list = new command_list_immediate_impl(device, queue);
 		// Ensure the immediate command list was initialized successfully, otherwise disable it
@@ -46,7 +51,8 @@ reshade::d3d12::command_queue_impl::~command_queue_impl()
 	delete _immediate_cmd_list;
 
 	// Unregister queue from device
-	_device_impl->_queues.erase(std::find(_device_impl->_queues.begin(), _device_impl->_queues.end(), this));
+	if (!_internal)
+		_device_impl->_queues.erase(std::find(_device_impl->_queues.begin(), _device_impl->_queues.end(), this));
 }
 
 reshade::api::device *reshade::d3d12::command_queue_impl::get_device()
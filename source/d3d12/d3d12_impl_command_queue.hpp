@@ -13,7 +13,7 @@ namespace reshade::d3d12
 	class command_queue_impl : public api::api_object_impl<ID3D12CommandQueue *, api::command_queue>
 	{
 	public:
-		command_queue_impl(device_impl *device, ID3D12CommandQueue *queue);
+		command_queue_impl(device_impl *device, ID3D12CommandQueue *queue, bool internal = false);
 		~command_queue_impl();
 
 		api::device *get_device() final;
@@ -40,6 +40,7 @@ namespace reshade::d3d12
 
 	private:
 		device_impl *const _device_impl;
+		const bool _internal;
 		command_list_immediate_impl *_immediate_cmd_list = nullptr;
 
 		HANDLE _wait_idle_fence_event = nullptr;
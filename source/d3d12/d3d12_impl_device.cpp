@@ -11,6 +11,7 @@
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
 #include <cwchar> // std::wcslen
+#include <cstddef> // offsetof
 #include <cstring> // std::memcmp, std::memcpy, std::strlen
 #include <algorithm> // std::copy_n, std::find, std::find_if, std::max, std::min
 #include <utf8/unchecked.h>
@@ -60,6 +61,27 @@ static auto adapter_from_device(ID3D12Device *device, DXGI_ADAPTER_DESC *adapter
 	return dxgi_adapter;
 }
 
+static void hash_combine_bytes(size_t &hash, const void *data, size_t size)
+{
+	hash ^= std::hash<std::string_view>()(std::string_view(static_cast<const char *>(data), size)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+// Hashes members one by one, since hashing whole structures would include their padding bytes, which are uninitialized for descriptions built on the stack
+template <typename... T>
+static void hash_combine_values(size_t &hash, const T &... values)
+{
+	(hash_combine_bytes(hash, &values, sizeof(values)), ...);
+}
+static bool hash_combine_root_signature(size_t &hash, ID3D12RootSignature *signature)
+{
+	reshade::d3d12::pipeline_layout_extra_data extra_data;
+	UINT extra_data_size = sizeof(extra_data);
+	if (signature == nullptr || FAILED(signature->GetPrivateData(reshade::d3d12::extra_data_guid, &extra_data_size, &extra_data)))
+		return false;
+
+	hash_combine_values(hash, extra_data.signature_hash);
+	return true;
+}
+
 reshade::d3d12::device_impl::device_impl(ID3D12Device *device) :
 	api_object_impl(device),
 	_view_heaps {
@@ -824,6 +846,10 @@ void reshade::d3d12::device_impl::update_texture_region(const api::subresource_d
 }
 
 bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline)
+{
+	return create_pipeline(layout, subobject_count, subobjects, out_pipeline, false);
+}
+bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline, bool use_pipeline_library)
 {
 	api::shader_desc vs_desc = {};
 	api::shader_desc hs_desc = {};
@@ -1199,7 +1225,7 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 		convert_shader_desc(cs_desc, internal_desc.CS);
 
 		if (com_ptr<ID3D12PipelineState> pipeline;
-			SUCCEEDED(_orig->CreateComputePipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
+			create_compute_pipeline_state(internal_desc, pipeline, use_pipeline_library))
 		{
 			*out_pipeline = to_handle(pipeline.release());
 			return true;
@@ -1299,7 +1325,7 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 		internal_desc.SampleDesc.Count = sample_count;
 
 		if (com_ptr<ID3D12PipelineState> pipeline;
-			SUCCEEDED(_orig->CreateGraphicsPipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
+			create_graphics_pipeline_state(internal_desc, pipeline, use_pipeline_library))
 		{
 			pipeline_extra_data extra_data;
 			extra_data.topology = convert_primitive_topology(topology);
@@ -1520,6 +1546,7 @@ bool reshade::d3d12::device_impl::create_pipeline_layout(uint32_t param_count, c
 		{
 			extra_data.ranges = new std::pair<D3D12_DESCRIPTOR_HEAP_TYPE, UINT>[param_count];
 			std::copy_n(set_ranges.begin(), param_count, const_cast<std::pair<D3D12_DESCRIPTOR_HEAP_TYPE, UINT> *>(extra_data.ranges));
+			extra_data.signature_hash = std::hash<std::string_view>()(std::string_view(static_cast<const char *>(signature_blob->GetBufferPointer()), signature_blob->GetBufferSize()));
 
 			signature->SetPrivateData(extra_data_guid, sizeof(extra_data), &extra_data);
 		}
@@ -2165,6 +2192,197 @@ reshade::d3d12::command_list_immediate_impl *reshade::d3d12::device_impl::get_im
 	return nullptr;
 }
 
+reshade::api::command_queue *reshade::d3d12::device_impl::create_async_compute_queue()
+{
+	// Create the queue on the original device, so that it is not visible to add-ons or the application
+	D3D12_COMMAND_QUEUE_DESC queue_desc = {};
+	queue_desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+
+	com_ptr<ID3D12CommandQueue> queue;
+	if (FAILED(_orig->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(&queue))))
+		return nullptr;
+	queue->SetName(L"ReShade async compute queue");
+
+	const auto queue_impl = new command_queue_impl(this, queue.get(), true);
+	if (queue_impl->get_immediate_command_list() == nullptr)
+	{
+		delete queue_impl;
+		return nullptr;
+	}
+
+	// The queue implementation does not hold a reference to the queue, so keep the one created above until 'destroy_async_compute_queue'
+	queue.release();
+
+	return queue_impl;
+}
+void reshade::d3d12::device_impl::destroy_async_compute_queue(api::command_queue *queue)
+{
+	if (queue == nullptr)
+		return;
+
+	const auto queue_impl = static_cast<command_queue_impl *>(queue);
+	ID3D12CommandQueue *const queue_orig = queue_impl->_orig;
+
+	queue_impl->wait_idle();
+	delete queue_impl;
+
+	queue_orig->Release();
+}
+
+bool reshade::d3d12::device_impl::create_pipeline_library(std::string &&serialized_data)
+{
+	const std::unique_lock<std::shared_mutex> lock(_pipeline_library_mutex);
+
+	if (_pipeline_library != nullptr)
+		return true;
+
+	com_ptr<ID3D12Device1> device1;
+	if (FAILED(_orig->QueryInterface(&device1)))
+		return false;
+
+	_pipeline_library_data = std::move(serialized_data);
+
+	if (!_pipeline_library_data.empty() &&
+		SUCCEEDED(device1->CreatePipelineLibrary(_pipeline_library_data.data(), _pipeline_library_data.size(), IID_PPV_ARGS(&_pipeline_library))))
+		return true;
+
+	// Serialized data is rejected after a driver or adapter change, so simply start over with an empty library in that case
+	_pipeline_library_data.clear();
+
+	return SUCCEEDED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&_pipeline_library)));
+}
+bool reshade::d3d12::device_impl::serialize_pipeline_library(std::string &data) const
+{
+	const com_ptr<ID3D12PipelineLibrary> library = get_pipeline_library();
+	if (library == nullptr)
+		return false;
+
+	data.resize(library->GetSerializedSize());
+	return SUCCEEDED(library->Serialize(data.data(), data.size()));
+}
+
+com_ptr<ID3D12PipelineLibrary> reshade::d3d12::device_impl::get_pipeline_library() const
+{
+	const std::shared_lock<std::shared_mutex> lock(_pipeline_library_mutex);
+
+	return _pipeline_library;
+}
+void reshade::d3d12::device_impl::replace_pipeline_library(const com_ptr<ID3D12PipelineLibrary> &stale_library, const std::wstring &name, ID3D12PipelineState *pipeline)
+{
+	com_ptr<ID3D12PipelineLibrary> library;
+	{
+		const std::unique_lock<std::shared_mutex> lock(_pipeline_library_mutex);
+
+		// Pipelines cannot be removed from a library, so start over with an empty one, unless another thread already did so
+		// Keep the serialized data the stale library was created from, since other threads may still be using that library
+		if (_pipeline_library == stale_library)
+		{
+			com_ptr<ID3D12Device1> device1;
+			if (FAILED(_orig->QueryInterface(&device1)) ||
+				FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library))))
+				return;
+
+			_pipeline_library = library;
+		}
+		else
+		{
+			library = _pipeline_library;
+		}
+	}
+
+	if (library != nullptr && SUCCEEDED(library->StorePipeline(name.c_str(), pipeline)))
+		_pipeline_library_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool reshade::d3d12::device_impl::create_compute_pipeline_state(const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc, com_ptr<ID3D12PipelineState> &out_pipeline, bool use_pipeline_library)
+{
+	com_ptr<ID3D12PipelineLibrary> library;
+	if (use_pipeline_library)
+		library = get_pipeline_library();
+
+	// Loading a pipeline fails if it was stored with a different root signature, so include it in the name to have pipelines for different root signatures stored side by side
+	size_t hash = 0;
+	if (library == nullptr || !hash_combine_root_signature(hash, desc.pRootSignature))
+		return SUCCEEDED(_orig->CreateComputePipelineState(&desc, IID_PPV_ARGS(&out_pipeline)));
+
+	hash_combine_bytes(hash, desc.CS.pShaderBytecode, desc.CS.BytecodeLength);
+	hash_combine_values(hash, desc.NodeMask, desc.Flags);
+
+	const std::wstring name = L"compute-" + std::to_wstring(hash);
+
+	{
+		const std::unique_lock<std::mutex> lock(_pipeline_library_load_mutexes[hash % std::size(_pipeline_library_load_mutexes)]);
+
+		// This fails if there is no pipeline with that name, or if the stored pipeline does not match the description (e.g. because of a different root signature)
+		if (SUCCEEDED(library->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(&out_pipeline))))
+			return true;
+	}
+
+	if (FAILED(_orig->CreateComputePipelineState(&desc, IID_PPV_ARGS(&out_pipeline))))
+		return false;
+
+	// Storing fails if there already is a pipeline with the same name, which is fine if another thread stored a matching one in the meantime
+	// Otherwise the stored one is stale (since loading it failed above) and has to be replaced, or it would never be loaded successfully again
+	if (SUCCEEDED(library->StorePipeline(name.c_str(), out_pipeline.get())))
+		_pipeline_library_generation.fetch_add(1, std::memory_order_relaxed);
+	else if (com_ptr<ID3D12PipelineState> existing_pipeline;
+		FAILED(library->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(&existing_pipeline))))
+		replace_pipeline_library(library, name, out_pipeline.get());
+
+	return true;
+}
+bool reshade::d3d12::device_impl::create_graphics_pipeline_state(const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc, com_ptr<ID3D12PipelineState> &out_pipeline, bool use_pipeline_library)
+{
+	com_ptr<ID3D12PipelineLibrary> library;
+	// Stream output is not used by effects, so do not bother storing pipelines using it
+	if (use_pipeline_library && desc.StreamOutput.NumEntries == 0)
+		library = get_pipeline_library();
+
+	size_t hash = 0;
+	if (library == nullptr || !hash_combine_root_signature(hash, desc.pRootSignature))
+		return SUCCEEDED(_orig->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&out_pipeline)));
+
+	for (const D3D12_SHADER_BYTECODE &shader : { desc.VS, desc.PS, desc.DS, desc.HS, desc.GS })
+		hash_combine_bytes(hash, shader.pShaderBytecode, shader.BytecodeLength);
+	hash_combine_values(hash, desc.BlendState.AlphaToCoverageEnable, desc.BlendState.IndependentBlendEnable);
+	for (const D3D12_RENDER_TARGET_BLEND_DESC &target : desc.BlendState.RenderTarget)
+		hash_combine_values(hash, target.BlendEnable, target.LogicOpEnable, target.SrcBlend, target.DestBlend, target.BlendOp, target.SrcBlendAlpha, target.DestBlendAlpha, target.BlendOpAlpha, target.LogicOp, target.RenderTargetWriteMask);
+	hash_combine_values(hash, desc.SampleMask);
+	hash_combine_values(hash, desc.RasterizerState.FillMode, desc.RasterizerState.CullMode, desc.RasterizerState.FrontCounterClockwise, desc.RasterizerState.DepthBias, desc.RasterizerState.DepthBiasClamp, desc.RasterizerState.SlopeScaledDepthBias, desc.RasterizerState.DepthClipEnable, desc.RasterizerState.MultisampleEnable, desc.RasterizerState.AntialiasedLineEnable, desc.RasterizerState.ForcedSampleCount, desc.RasterizerState.ConservativeRaster);
+	hash_combine_values(hash, desc.DepthStencilState.DepthEnable, desc.DepthStencilState.DepthWriteMask, desc.DepthStencilState.DepthFunc, desc.DepthStencilState.StencilEnable, desc.DepthStencilState.StencilReadMask, desc.DepthStencilState.StencilWriteMask);
+	for (const D3D12_DEPTH_STENCILOP_DESC &face : { desc.DepthStencilState.FrontFace, desc.DepthStencilState.BackFace })
+		hash_combine_values(hash, face.StencilFailOp, face.StencilDepthFailOp, face.StencilPassOp, face.StencilFunc);
+	for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+	{
+		const D3D12_INPUT_ELEMENT_DESC &element = desc.InputLayout.pInputElementDescs[i];
+		hash_combine_bytes(hash, element.SemanticName, std::strlen(element.SemanticName));
+		hash_combine_values(hash, element.SemanticIndex, element.Format, element.InputSlot, element.AlignedByteOffset, element.InputSlotClass, element.InstanceDataStepRate);
+	}
+	hash_combine_values(hash, desc.IBStripCutValue, desc.PrimitiveTopologyType);
+	hash_combine_bytes(hash, desc.RTVFormats, desc.NumRenderTargets * sizeof(*desc.RTVFormats));
+	hash_combine_values(hash, desc.DSVFormat, desc.SampleDesc.Count, desc.SampleDesc.Quality, desc.NodeMask, desc.Flags);
+
+	const std::wstring name = L"graphics-" + std::to_wstring(hash);
+
+	{
+		const std::unique_lock<std::mutex> lock(_pipeline_library_load_mutexes[hash % std::size(_pipeline_library_load_mutexes)]);
+
+		if (SUCCEEDED(library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&out_pipeline))))
+			return true;
+	}
+
+	if (FAILED(_orig->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&out_pipeline))))
+		return false;
+
+	if (SUCCEEDED(library->StorePipeline(name.c_str(), out_pipeline.get())))
+		_pipeline_library_generation.fetch_add(1, std::memory_order_relaxed);
+	else if (com_ptr<ID3D12PipelineState> existing_pipeline;
+		FAILED(library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&existing_pipeline))))
+		replace_pipeline_library(library, name, out_pipeline.get());
+
+	return true;
+}
+
 #if RESHADE_ADDON >= 2
 bool reshade::d3d12::device_impl::resolve_gpu_address(D3D12_GPU_VIRTUAL_ADDRESS address, api::resource *out_resource, uint64_t *out_offset, bool *out_acceleration_structure) const
 {
@@ -8,6 +8,8 @@
 #include "descriptor_heap.hpp"
 #include "reshade_api_object_impl.hpp"
 #include <map>
+#include <mutex>
+#include <atomic>
 #include <unordered_map>
 #include <concurrent_vector.h>
 
@@ -56,6 +58,7 @@ namespace reshade::d3d12
 		void update_buffer_region(const void *data, api::resource resource, uint64_t offset, uint64_t size) final;
 		void update_texture_region(const api::subresource_data &data, api::resource resource, uint32_t subresource, const api::subresource_box *box) final;
 
+		bool create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline, bool use_pipeline_library);
 		bool create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline) final;
 		void destroy_pipeline(api::pipeline pipeline) final;
 
@@ -100,6 +103,13 @@ namespace reshade::d3d12
 
 		command_list_immediate_impl *get_immediate_command_list();
 
+		api::command_queue *create_async_compute_queue();
+		void destroy_async_compute_queue(api::command_queue *queue);
+
+		bool create_pipeline_library(std::string &&serialized_data);
+		bool serialize_pipeline_library(std::string &data) const;
+		uint32_t get_pipeline_library_generation() const { return _pipeline_library_generation.load(std::memory_order_relaxed); }
+
 #if RESHADE_ADDON >= 2
 		bool resolve_gpu_address(D3D12_GPU_VIRTUAL_ADDRESS address, api::resource *out_resource, uint64_t *out_offset, bool *out_acceleration_structure = nullptr) const;
 
@@ -142,6 +152,11 @@ namespace reshade::d3d12
 #endif
 
 	private:
+		com_ptr<ID3D12PipelineLibrary> get_pipeline_library() const;
+		void replace_pipeline_library(const com_ptr<ID3D12PipelineLibrary> &stale_library, const std::wstring &name, ID3D12PipelineState *pipeline);
+		bool create_compute_pipeline_state(const D3D12_COMPUTE_PIPELINE_STATE_DESC &desc, com_ptr<ID3D12PipelineState> &out_pipeline, bool use_pipeline_library);
+		bool create_graphics_pipeline_state(const D3D12_GRAPHICS_PIPELINE_STATE_DESC &desc, com_ptr<ID3D12PipelineState> &out_pipeline, bool use_pipeline_library);
+
 		std::vector<command_queue_impl *> _queues;
 
 		UINT _descriptor_handle_size[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
@@ -159,5 +174,14 @@ namespace reshade::d3d12
 
 		com_ptr<ID3D12PipelineState> _mipmap_pipeline;
 		com_ptr<ID3D12RootSignature> _mipmap_signature;
+
+		// The serialized data has to stay alive for as long as the pipeline library that was created from it
+		std::string _pipeline_library_data;
+		com_ptr<ID3D12PipelineLibrary> _pipeline_library;
+		// Only guards creation of the library, since the library itself is free-threaded
+		mutable std::shared_mutex _pipeline_library_mutex;
+		// Except for loading the same pipeline on multiple threads at once, so serialize loads of pipelines whose names share a slot
+		std::mutex _pipeline_library_load_mutexes[16];
+		std::atomic<uint32_t> _pipeline_library_generation = 0;
 	};
 }
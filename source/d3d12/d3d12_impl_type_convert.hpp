@@ -26,6 +26,7 @@ namespace reshade::d3d12
 	struct pipeline_layout_extra_data
 	{
 		const std::pair<D3D12_DESCRIPTOR_HEAP_TYPE, UINT> *ranges;
+		size_t signature_hash; // Hash of the serialized root signature, used to name pipelines in the pipeline library
 	};
 
 	struct query_heap_extra_data
@@ -4,6 +4,11 @@
  */
 
 #include "dll_log.hpp"
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <vector>
+#include <algorithm> // std::max, std::min
 #include <Windows.h>
 
 struct scoped_file_handle
@@ -27,8 +32,155 @@ private:
 
 static scoped_file_handle s_file_handle;
 
+// Log messages are queued in a ring buffer by the threads that log them and written to the file in the background, so that logging from render or hook threads does not have to wait on disk access
+// The ring buffer is a bounded multi-producer queue, in which each record has a sequence number that tells whether it is free for a position, or holds the message queued at a position (see http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue)
+struct log_record
+{
+	std::atomic<size_t> sequence;
+	std::string line;
+};
+
+static struct log_ring
+{
+	log_ring()
+	{
+		for (size_t i = 0; i < std::size(records); ++i)
+			records[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	log_record records[1024];
+	std::atomic<size_t> write_position = 0;
+	// Only accessed by the thread that currently holds 'draining'
+	size_t read_position = 0;
+	std::atomic<bool> draining = false;
+} s_ring;
+
+// Queued records are written by thread pool callbacks, each of which holds a reference to this module only while it runs, so that the module can still be unloaded in between
+static std::atomic<bool> s_sink_enabled = false;
+static std::atomic<bool> s_sink_scheduled = false;
+static bool s_process_terminating = false;
+
+// Most recent lines are kept in memory as well, so that the overlay can show them without reading the log file again
+static std::mutex s_recent_lines_mutex;
+static std::deque<std::string> s_recent_lines;
+static size_t s_recent_lines_end = 0;
+
+static bool drain_log_records(bool force = false)
+{
+	if (s_ring.draining.exchange(true, std::memory_order_acquire) && !force)
+		return false; // Another thread is already writing queued records
+
+	std::string data;
+	std::vector<std::string> lines;
+
+	for (;; ++s_ring.read_position)
+	{
+		log_record &record = s_ring.records[s_ring.read_position % std::size(s_ring.records)];
+		if (record.sequence.load(std::memory_order_acquire) != s_ring.read_position + 1)
+			break; // No more records were queued
+
+		lines.push_back(std::move(record.line));
+		record.line.clear();
+
+		// Mark record as free for the position one round later
+		record.sequence.store(s_ring.read_position + std::size(s_ring.records), std::memory_order_release);
+	}
+
+	if (!lines.empty())
+	{
+		for (const std::string &line : lines)
+		{
+			data.reserve(data.size() + line.size() + 16);
+
+			// Replace all LF with CRLF
+			for (const char c : line)
+			{
+				if (c == '\n')
+					data += '\r';
+				data += c;
+			}
+		}
+
+		// Write all records that were queued at once
+		if (s_file_handle != INVALID_HANDLE_VALUE)
+		{
+			DWORD written = 0;
+			WriteFile(s_file_handle, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+			assert(written == data.size());
+		}
+
+		const std::unique_lock<std::mutex> lock(s_recent_lines_mutex);
+
+		// Split messages spanning multiple lines, so that every entry is a single line
+		for (const std::string &line : lines)
+		{
+			for (size_t offset = 0, next; offset < line.size(); offset = next + 1)
+			{
+				next = std::min(line.find('\n', offset), line.size());
+				s_recent_lines.emplace_back(line, offset, next - offset);
+				s_recent_lines_end++;
+			}
+		}
+
+		while (s_recent_lines.size() > reshade::log::max_recent_lines)
+			s_recent_lines.pop_front();
+	}
+
+	s_ring.draining.store(false, std::memory_order_release);
+	return true;
+}
+static void wait_and_drain_log_records()
+{
+	// All other threads were already terminated during process exit, including one that may have been writing at that moment, so take over from it right away instead of waiting for it
+	if (s_process_terminating)
+	{
+		drain_log_records(true);
+		return;
+	}
+
+	// Give up after a while, in case the thread that was writing was terminated while doing so
+	for (int attempt = 0; !drain_log_records() && attempt < 1000; ++attempt)
+		Sleep(1);
+}
+
+static void CALLBACK log_sink_callback(PTP_CALLBACK_INSTANCE instance, PVOID module)
+{
+	// Release the module reference taken when this callback was submitted (see 'schedule_log_sink') only after it returned
+	FreeLibraryWhenCallbackReturns(instance, static_cast<HMODULE>(module));
+
+	// Allow scheduling another callback before writing, so that records queued while writing are not missed
+	s_sink_scheduled.store(false, std::memory_order_release);
+
+	// Retry if another thread was writing, since it may have missed records that were queued after it checked
+	wait_and_drain_log_records();
+}
+
+static bool schedule_log_sink()
+{
+	if (!s_sink_enabled.load(std::memory_order_acquire))
+		return false;
+	if (s_sink_scheduled.exchange(true, std::memory_order_acq_rel))
+		return true; // A callback is already pending and will pick up this record too
+
+	if (HMODULE module = nullptr;
+		GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&log_sink_callback), &module))
+	{
+		if (TrySubmitThreadpoolCallback(&log_sink_callback, module, nullptr))
+			return true;
+
+		FreeLibrary(module);
+	}
+
+	s_sink_scheduled.store(false, std::memory_order_release);
+	return false;
+}
+
 bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_code &ec)
 {
+	// Prevent background writes to the file while it is replaced
+	while (s_ring.draining.exchange(true, std::memory_order_acquire))
+		Sleep(0);
+
 	// Close the previous file first
 	// Do this here, instead of in 'scoped_file_handle::operator=', so that the old handle is closed before the new handle is created
 	if (s_file_handle != INVALID_HANDLE_VALUE)
@@ -37,8 +189,19 @@ bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_c
 	// Open the log file for writing (and flush on each write) and clear previous contents
 	s_file_handle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_WRITE_THROUGH, NULL);
 
+	{	const std::unique_lock<std::mutex> lock(s_recent_lines_mutex);
+
+		s_recent_lines.clear();
+	}
+
+	s_ring.draining.store(false, std::memory_order_release);
+
 	if (s_file_handle != INVALID_HANDLE_VALUE)
 	{
+		// Write records in the background from now on
+		if (!s_process_terminating)
+			s_sink_enabled.store(true, std::memory_order_release);
+
 		// Last error may be ERROR_ALREADY_EXISTS if an existing file was overwritten, which can be ignored
 		ec.clear();
 		return true;
@@ -49,6 +212,35 @@ bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_c
 		return false;
 	}
 }
+void reshade::log::stop_log_sink(bool process_terminating)
+{
+	s_sink_enabled.store(false, std::memory_order_release);
+	s_process_terminating = process_terminating;
+}
+void reshade::log::close_log_file()
+{
+	s_sink_enabled.store(false, std::memory_order_release);
+
+	// Write out any records that are still queued
+	wait_and_drain_log_records();
+
+	if (s_file_handle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(s_file_handle);
+		s_file_handle = INVALID_HANDLE_VALUE;
+	}
+}
+
+void reshade::log::get_recent_lines(size_t &next_line, std::vector<std::string> &lines)
+{
+	const std::unique_lock<std::mutex> lock(s_recent_lines_mutex);
+
+	const size_t first_line = s_recent_lines_end - s_recent_lines.size();
+	for (size_t line = std::max(next_line, first_line); line < s_recent_lines_end; ++line)
+		lines.push_back(s_recent_lines[line - first_line]);
+
+	next_line = s_recent_lines_end;
+}
 
 void reshade::log::message(level level, const char *format, ...)
 {
@@ -93,20 +285,41 @@ void reshade::log::message(level level, const char *format, ...)
 
 	line_string += '\n'; // Terminate line with line feed
 
-	// Replace all LF with CRLF
-	for (size_t offset = 0; (offset = line_string.find('\n', offset)) != std::string::npos; offset += 2)
-		line_string.replace(offset, 1, "\r\n", 2);
-
-	// Write line to the log file
-	if (s_file_handle != INVALID_HANDLE_VALUE)
-	{
-		DWORD written = 0;
-		WriteFile(s_file_handle, line_string.data(), static_cast<DWORD>(line_string.size()), &written, nullptr);
-		assert(written == line_string.size());
-	}
-
 #ifndef NDEBUG
 	// Write line to the debug output
 	OutputDebugStringA(line_string.c_str());
 #endif
+
+	// Claim the next free record in the ring buffer
+	log_record *record = nullptr;
+	size_t position = s_ring.write_position.load(std::memory_order_relaxed);
+	while (true)
+	{
+		record = &s_ring.records[position % std::size(s_ring.records)];
+
+		const ptrdiff_t difference = static_cast<ptrdiff_t>(record->sequence.load(std::memory_order_acquire)) - static_cast<ptrdiff_t>(position);
+		if (difference == 0)
+		{
+			if (s_ring.write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			// Ring buffer is full, so write queued records from this thread rather than waiting for the background writes to catch up
+			if (!drain_log_records())
+				Sleep(0);
+			position = s_ring.write_position.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			position = s_ring.write_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	record->line = std::move(line_string);
+	record->sequence.store(position + 1, std::memory_order_release);
+
+	// Records are not written in the background before a log file was opened or after the sink was stopped, so have to write directly
+	if (!schedule_log_sink())
+		wait_and_drain_log_records();
 }
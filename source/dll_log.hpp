@@ -8,6 +8,7 @@
 #include <cassert>
 #include <cinttypes>
 #include <string>
+#include <vector>
 #include <filesystem>
 
 namespace reshade::log
@@ -41,9 +42,31 @@ namespace reshade::log
 	/// <param name="path">Path to the log file.</param>
 	/// <param name="ec">Error code that is set on failure.</param>
 	bool open_log_file(const std::filesystem::path &path, std::error_code &ec);
+	/// <summary>
+	/// Stops writing log messages to the log file in the background, so that any further messages are written directly by the thread that logs them.
+	/// This has to be called before the module is unloaded, since background writes would otherwise take a new reference to it.
+	/// </summary>
+	/// <param name="process_terminating">Whether the process is exiting, in which case all other threads were already terminated, possibly while writing log messages.</param>
+	void stop_log_sink(bool process_terminating);
+	/// <summary>
+	/// Stops writing log messages in the background, writes any messages that are still queued and closes the log file.
+	/// </summary>
+	void close_log_file();
+
+	/// <summary>
+	/// Maximum number of recently logged lines that are kept in memory.
+	/// </summary>
+	constexpr size_t max_recent_lines = 4096;
+
+	/// <summary>
+	/// Gets the most recently logged lines that are still kept in memory (up to <see cref="max_recent_lines"/>).
+	/// </summary>
+	/// <param name="next_line">Index of the first line to get, which is updated to the index following the last line that was logged.</param>
+	/// <param name="lines">List the lines are appended to.</param>
+	void get_recent_lines(size_t &next_line, std::vector<std::string> &lines);
 
 	/// <summary>
-	/// Constructs a single log message including current time and level and writes it to the open log file.
+	/// Constructs a single log message including current time and level and queues it for writing to the open log file.
 	/// </summary>
 	void message(level level, const char *format, ...);
 
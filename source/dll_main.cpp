@@ -124,7 +124,7 @@ std::filesystem::path get_module_path(HMODULE module)
 
 #ifndef RESHADE_TEST_APPLICATION
 
-BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID lpReserved)
 {
 	switch (fdwReason)
 	{
@@ -348,6 +348,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		}
 		case DLL_PROCESS_DETACH:
 		{
+			// The module is being unloaded, so cannot write log messages in the background any longer ('lpReserved' is not null when the process is exiting)
+			reshade::log::stop_log_sink(lpReserved != nullptr);
+
 			reshade::log::message(reshade::log::level::info, "Exiting ...");
 
 #if RESHADE_ADDON
@@ -374,6 +377,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 #endif
 
 			reshade::log::message(reshade::log::level::info, "Finished exiting.");
+
+			// Make sure all queued log messages are written before the module is unloaded
+			reshade::log::close_log_file();
 			break;
 		}
 	}
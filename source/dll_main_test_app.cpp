@@ -11,12 +11,19 @@
 #include "addon_manager.hpp"
 #include "com_ptr.hpp"
 #include "ini_file.hpp"
+#include "runtime.hpp"
+#include "runtime_manager.hpp"
+#include "null/null_impl_device_context.hpp"
+#include "null/null_impl_swapchain.hpp"
 #include <d3d9.h>
 #include <d3d11.h>
 #include <d3d12.h>
 #include <D3D12Downlevel.h>
 #include <GL/gl3w.h>
 #include <vulkan/vulkan.h>
+#include <atomic>
+#include <crtdbg.h>
+#include <chrono>
 
 extern HMODULE g_module_handle;
 extern std::filesystem::path g_reshade_dll_path;
@@ -63,6 +70,117 @@ static LONG APIENTRY HookD3DKMTQueryAdapterInfo(const void *pData)
 	return reshade::hooks::call(HookD3DKMTQueryAdapterInfo)(pData);
 }
 
+#ifdef _DEBUG
+// Count heap allocations, so that the null device benchmark can report how many the effect runtime makes per frame
+// This goes through the debug CRT allocation hook, which is only installed while measuring, so the rest of the application is not affected
+static std::atomic<size_t> s_allocation_count = 0;
+
+static int __cdecl count_allocation_hook(int alloc_type, void *, size_t, int block_type, long, const unsigned char *, int)
+{
+	// Ignore allocations the CRT makes internally
+	if (alloc_type == _HOOK_ALLOC && block_type != _CRT_BLOCK)
+		s_allocation_count++;
+	return TRUE;
+}
+#endif
+
+static int run_null_benchmark(LPCSTR lpCmdLine)
+{
+	uint32_t width = 1920;
+	if (LPCSTR width_arg = std::strstr(lpCmdLine, "-width "))
+		width = std::strtoul(width_arg + 7, nullptr, 10);
+	uint32_t height = 1080;
+	if (LPCSTR height_arg = std::strstr(lpCmdLine, "-height "))
+		height = std::strtoul(height_arg + 8, nullptr, 10);
+	uint32_t frame_count = 1000;
+	if (LPCSTR frames_arg = std::strstr(lpCmdLine, "-frames "))
+		frame_count = std::max(1ul, std::strtoul(frames_arg + 8, nullptr, 10));
+
+	reshade::null::device_impl device;
+	reshade::null::device_context_impl queue(&device);
+
+	{
+		reshade::null::swapchain_impl swapchain(&device, width, height);
+
+		reshade::create_effect_runtime(&swapchain, &queue);
+		reshade::init_effect_runtime(&swapchain);
+
+		const auto runtime = swapchain.get_private_data<reshade::runtime>();
+		if (runtime == nullptr)
+		{
+			reshade::log::message(reshade::log::level::error, "Failed to create effect runtime for null device benchmark!");
+			reshade::destroy_effect_runtime(&swapchain);
+			return EXIT_FAILURE;
+		}
+
+		// Effects are loaded and compiled asynchronously, so keep presenting until that finished before starting to measure
+		do
+		{
+			reshade::present_effect_runtime(&swapchain, &queue);
+			swapchain.present();
+		}
+		while (runtime->is_loading());
+
+		size_t command_counts[static_cast<size_t>(reshade::null::command_type::count)] = {};
+		queue.clear_recorded_commands();
+
+		std::chrono::high_resolution_clock::duration cpu_time = {};
+
+#ifdef _DEBUG
+		s_allocation_count = 0;
+		const _CRT_ALLOC_HOOK previous_alloc_hook = _CrtSetAllocHook(count_allocation_hook);
+#endif
+
+		for (uint32_t i = 0; i < frame_count; ++i)
+		{
+			const auto frame_start = std::chrono::high_resolution_clock::now();
+
+			reshade::present_effect_runtime(&swapchain, &queue);
+			swapchain.present();
+
+			cpu_time += std::chrono::high_resolution_clock::now() - frame_start;
+
+			for (size_t type = 0; type < static_cast<size_t>(reshade::null::command_type::count); ++type)
+				command_counts[type] += queue.get_recorded_command_count(static_cast<reshade::null::command_type>(type));
+			queue.clear_recorded_commands();
+		}
+
+#ifdef _DEBUG
+		_CrtSetAllocHook(previous_alloc_hook);
+#endif
+
+		size_t total_command_count = 0;
+		for (const size_t count : command_counts)
+			total_command_count += count;
+
+		const auto per_frame = [frame_count](size_t count) { return static_cast<double>(count) / frame_count; };
+
+		reshade::log::message(reshade::log::level::info, "Null device benchmark with %u frames at %ux%u:", frame_count, width, height);
+		reshade::log::message(reshade::log::level::info, "  CPU time per frame: %.3f ms", std::chrono::duration<double, std::milli>(cpu_time).count() / frame_count);
+#ifdef _DEBUG
+		reshade::log::message(reshade::log::level::info, "  Heap allocations per frame: %.1f", per_frame(s_allocation_count));
+#else
+		reshade::log::message(reshade::log::level::info, "  Heap allocations per frame: not counted (requires a debug build)");
+#endif
+		reshade::log::message(reshade::log::level::info, "  Commands per frame: %.1f (%.1f draws, %.1f dispatches, %.1f barriers, %.1f render passes, %.1f pipeline binds, %.1f descriptor updates)",
+			per_frame(total_command_count),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::draw)] + command_counts[static_cast<size_t>(reshade::null::command_type::draw_indexed)]),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::dispatch)]),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::barrier)]),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::begin_render_pass)]),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::bind_pipeline)]),
+			per_frame(command_counts[static_cast<size_t>(reshade::null::command_type::push_descriptors)] + command_counts[static_cast<size_t>(reshade::null::command_type::bind_descriptor_tables)]));
+
+		reshade::reset_effect_runtime(&swapchain);
+		reshade::destroy_effect_runtime(&swapchain);
+	}
+
+	if (device.get_live_object_count() != 0)
+		reshade::log::message(reshade::log::level::warning, "Null device benchmark leaked %zu objects.", device.get_live_object_count());
+
+	return EXIT_SUCCESS;
+}
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow)
 {
 	g_module_handle = hInstance;
@@ -77,6 +195,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow
 
 	reshade::hooks::install("D3DKMTQueryAdapterInfo", GetProcAddress(GetModuleHandleW(L"gdi32.dll"), "D3DKMTQueryAdapterInfo"), HookD3DKMTQueryAdapterInfo);
 
+	// Run the effect runtime on the null device without creating a window or graphics device
+	if (strstr(lpCmdLine, "-null"))
+		return run_null_benchmark(lpCmdLine);
+
 	static UINT s_resize_w = 0, s_resize_h = 0;
 
 	// Register window class
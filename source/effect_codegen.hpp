@@ -7,7 +7,8 @@
 
 #include "effect_module.hpp"
 #include <memory> // std::unique_ptr
-#include <algorithm> // std::find_if
+#include <algorithm> // std::find_if, std::sort, std::unique
+#include <unordered_map>
 
 namespace reshadefx
 {
@@ -370,12 +371,64 @@ namespace reshadefx
 		{
 			return const_cast<codegen *>(this)->find_function(unique_name);
 		}
+		/// <summary>
+		/// Collects the specified entry point and all functions it references, in the order they were defined in.
+		/// </summary>
+		/// <param name="entry_point">Entry point function to collect the referenced functions of.</param>
+		/// <returns>List of function definitions that have to be part of the code for this entry point.</returns>
+		std::vector<const function *> collect_referenced_functions(const function &entry_point) const
+		{
+			// The function list only grows, so only need to rebuild the lookup table when new functions were added since the last call
+			if (_function_indices.size() != _functions.size())
+			{
+				_function_indices.clear();
+				_function_indices.reserve(_functions.size());
+				for (size_t i = 0; i < _functions.size(); ++i)
+					_function_indices.emplace(_functions[i]->id, i);
+			}
+
+			// The list of referenced functions is already the transitive closure of all calls (see 'parser::parse_expression_unary'), so only need to sort it into definition order
+			std::vector<size_t> indices;
+			indices.reserve(entry_point.referenced_functions.size() + 1);
+			indices.push_back(_function_indices.at(entry_point.id));
+			for (const id func_id : entry_point.referenced_functions)
+				if (const auto it = _function_indices.find(func_id); it != _function_indices.end())
+					indices.push_back(it->second);
+			std::sort(indices.begin(), indices.end());
+			indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+			std::vector<const function *> functions;
+			functions.reserve(indices.size());
+			for (const size_t index : indices)
+				functions.push_back(_functions[index].get());
+			return functions;
+		}
+
+		/// <summary>
+		/// A reference to a code block with its binding index replaced, which avoids having to copy the block just to patch the index.
+		/// </summary>
+		struct binding_segment
+		{
+			const std::string *code;
+			size_t replace_beg;
+			size_t replace_end;
+			std::string binding;
+
+			size_t size() const { return code->size() - (replace_end - replace_beg) + binding.size(); }
+			void append_to(std::string &s) const
+			{
+				s.append(*code, 0, replace_beg);
+				s += binding;
+				s.append(*code, replace_end, std::string::npos);
+			}
+		};
 
 		id make_id() { return _next_id++; }
 
 		effect_module _module;
 		std::vector<struct_type> _structs;
 		std::vector<std::unique_ptr<function>> _functions;
+		mutable std::unordered_map<id, size_t> _function_indices;
 
 		id _next_id = 1;
 		id _last_block = 0;
@@ -407,5 +460,6 @@ namespace reshadefx
 	/// <param name="uniforms_to_spec_constants">Whether to convert uniform variables to specialization constants.</param>
 	/// <param name="enable_16bit_types">Use real 16-bit types for the minimum precision types "min16int", "min16uint" and "min16float".</param>
 	/// <param name="flip_vert_y">Insert code to flip the Y component of the output position in vertex shaders.</param>
-	codegen *create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types = false, bool flip_vert_y = false);
+	/// <param name="optimize">Run the built-in optimization passes (dead function elimination, constant and type deduplication, store-to-load forwarding and dead store elimination) when finalizing code.</param>
+	codegen *create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types = false, bool flip_vert_y = false, bool optimize = false);
 }
@@ -9,7 +9,7 @@
 #include <cassert>
 #include <cstring> // std::memcmp
 #include <charconv> // std::from_chars, std::to_chars
-#include <algorithm> // std::find, std::find_if, std::max
+#include <algorithm> // std::find_if, std::max
 #include <unordered_set>
 
 using namespace reshadefx;
@@ -197,47 +197,49 @@ private:
 				"#define memoryBarrier()\n"
 				"#define groupMemoryBarrier()\n";
 
-		const auto replace_binding =
-			[](std::string &code, uint32_t binding) {
-				const size_t beg = code.find("layout(binding = ") + 17;
-				const size_t end = code.find_first_of("),", beg);
-				code.replace(beg, end - beg, std::to_string(binding));
+		// Collect all segments the code for this entry point is made of first, so that the final string only has to be reallocated once with the exact size
+		std::vector<binding_segment> binding_segments;
+		binding_segments.reserve(entry_point->referenced_samplers.size() + entry_point->referenced_storages.size());
+
+		const auto add_binding_segment =
+			[this, &binding_segments](id block, uint32_t binding) {
+				const std::string &block_code = _blocks.at(block);
+				const size_t beg = block_code.find("layout(binding = ") + 17;
+				const size_t end = block_code.find_first_of("),", beg);
+				binding_segments.push_back({ &block_code, beg, end, std::to_string(binding) });
 			};
 
 		// Add referenced sampler definitions
 		for (uint32_t binding = 0; binding < entry_point->referenced_samplers.size(); ++binding)
-		{
-			if (entry_point->referenced_samplers[binding] == 0)
-				continue;
-
-			std::string block_code = _blocks.at(entry_point->referenced_samplers[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
-		}
+			if (entry_point->referenced_samplers[binding] != 0)
+				add_binding_segment(entry_point->referenced_samplers[binding], binding);
 
 		// Add referenced storage definitions
 		for (uint32_t binding = 0; binding < entry_point->referenced_storages.size(); ++binding)
-		{
-			if (entry_point->referenced_storages[binding] == 0)
-				continue;
+			if (entry_point->referenced_storages[binding] != 0)
+				add_binding_segment(entry_point->referenced_storages[binding], binding);
 
-			std::string block_code = _blocks.at(entry_point->referenced_storages[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
-		}
+		// Add referenced function definitions
+		const std::vector<const function *> referenced_functions = collect_referenced_functions(*entry_point);
+
+		size_t code_size = code.size() + _blocks.at(0).size();
+		for (const binding_segment &segment : binding_segments)
+			code_size += segment.size();
+		for (const function *func : referenced_functions)
+			code_size += _blocks.at(func->id).size();
+
+		code.reserve(code_size);
+
+		for (const binding_segment &segment : binding_segments)
+			segment.append_to(code);
 
 		// Add global definitions (struct types, global variables, ...)
 		code += _blocks.at(0);
 
-		// Add referenced function definitions
-		for (const std::unique_ptr<function> &func : _functions)
-		{
-			if (func->id != entry_point->id &&
-				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
-				continue;
-
+		for (const function *func : referenced_functions)
 			code += _blocks.at(func->id);
-		}
+
+		assert(code.size() == code_size);
 
 		return code;
 	}
@@ -10,7 +10,7 @@
 #include <cassert>
 #include <cstring> // stricmp, std::memcmp
 #include <charconv> // std::from_chars, std::to_chars
-#include <algorithm> // std::equal, std::find, std::find_if, std::max
+#include <algorithm> // std::equal, std::find_if, std::max
 
 using namespace reshadefx;
 
@@ -282,7 +282,19 @@ private:
 
 	std::string finalize_code() const override
 	{
-		std::string code = finalize_preamble();
+		const std::string preamble = finalize_preamble();
+
+		size_t code_size = preamble.size() + _blocks.at(0).size();
+		for (const sampler &info : _module.samplers)
+			code_size += _blocks.at(info.id).size();
+		for (const storage &info : _module.storages)
+			code_size += _blocks.at(info.id).size();
+		for (const std::unique_ptr<function> &func : _functions)
+			code_size += _blocks.at(func->id).size();
+
+		std::string code;
+		code.reserve(code_size);
+		code += preamble;
 
 		// Add global definitions (struct types, global variables, sampler state declarations, ...)
 		code += _blocks.at(0);
@@ -307,53 +319,62 @@ private:
 		if (entry_point == nullptr)
 			return {};
 
-		std::string code = finalize_preamble();
+		const std::string preamble = finalize_preamble();
 
-		if (_shader_model < 40 && entry_point->type == shader_type::pixel)
-			// Overwrite position semantic in pixel shaders
-			code += "#define POSITION VPOS\n";
+		// Overwrite position semantic in pixel shaders
+		static constexpr char position_semantic_define[] = "#define POSITION VPOS\n";
+		const bool overwrite_position_semantic = _shader_model < 40 && entry_point->type == shader_type::pixel;
 
-		// Add global definitions (struct types, global variables, sampler state declarations, ...)
-		code += _blocks.at(0);
+		// Collect all segments the code for this entry point is made of first, so that the final string can be allocated once with the exact size
+		std::vector<binding_segment> binding_segments;
+		binding_segments.reserve(entry_point->referenced_samplers.size() + entry_point->referenced_storages.size());
 
-		const auto replace_binding =
-			[](std::string &code, uint32_t binding) {
-				const size_t beg = code.find(": register(") + 12;
-				const size_t end = code.find(')', beg);
-				code.replace(beg, end - beg, std::to_string(binding));
+		const auto add_binding_segment =
+			[this, &binding_segments](id block, uint32_t binding) {
+				const std::string &block_code = _blocks.at(block);
+				const size_t beg = block_code.find(": register(") + 12;
+				const size_t end = block_code.find(')', beg);
+				binding_segments.push_back({ &block_code, beg, end, std::to_string(binding) });
 			};
 
 		// Add referenced texture and sampler definitions
 		for (uint32_t binding = 0; binding < entry_point->referenced_samplers.size(); ++binding)
-		{
-			if (entry_point->referenced_samplers[binding] == 0)
-				continue;
-
-			std::string block_code = _blocks.at(entry_point->referenced_samplers[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
-		}
+			if (entry_point->referenced_samplers[binding] != 0)
+				add_binding_segment(entry_point->referenced_samplers[binding], binding);
 
 		// Add referenced storage definitions
 		for (uint32_t binding = 0; binding < entry_point->referenced_storages.size(); ++binding)
-		{
-			if (entry_point->referenced_storages[binding] == 0)
-				continue;
-
-			std::string block_code = _blocks.at(entry_point->referenced_storages[binding]);
-			replace_binding(block_code, binding);
-			code += block_code;
-		}
+			if (entry_point->referenced_storages[binding] != 0)
+				add_binding_segment(entry_point->referenced_storages[binding], binding);
 
 		// Add referenced function definitions
-		for (const std::unique_ptr<function> &func : _functions)
-		{
-			if (func->id != entry_point->id &&
-				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
-				continue;
+		const std::vector<const function *> referenced_functions = collect_referenced_functions(*entry_point);
+
+		size_t code_size = preamble.size() + _blocks.at(0).size();
+		if (overwrite_position_semantic)
+			code_size += sizeof(position_semantic_define) - 1;
+		for (const binding_segment &segment : binding_segments)
+			code_size += segment.size();
+		for (const function *func : referenced_functions)
+			code_size += _blocks.at(func->id).size();
+
+		std::string code;
+		code.reserve(code_size);
+		code += preamble;
+
+		if (overwrite_position_semantic)
+			code += position_semantic_define;
 
+		// Add global definitions (struct types, global variables, sampler state declarations, ...)
+		code += _blocks.at(0);
+
+		for (const binding_segment &segment : binding_segments)
+			segment.append_to(code);
+
+		for (const function *func : referenced_functions)
 			code += _blocks.at(func->id);
-		}
+
+		assert(code.size() == code_size);
 
 		return code;
 	}
@@ -8,7 +8,9 @@
 #include <cassert>
 #include <cstring> // std::memcmp
 #include <charconv> // std::from_chars
-#include <algorithm> // std::find_if, std::max, std::sort
+#include <limits> // std::numeric_limits
+#include <algorithm> // std::copy_if, std::find_if, std::max, std::remove_if, std::sort
+#include <map>
 #include <unordered_set>
 
 // Use the C++ variant of the SPIR-V headers
@@ -133,17 +135,111 @@ struct spirv_basic_block
 	}
 };
 
+/// <summary>
+/// Calls the specified callback for the type and every operand of an instruction that references another ID (as opposed to a literal value).
+/// </summary>
+template <typename F>
+void for_each_id_operand(spirv_instruction &inst, F callback)
+{
+	const auto visit = [&inst, &callback](size_t first, size_t last = std::numeric_limits<size_t>::max()) {
+		for (size_t i = first; i < std::min(last, inst.operands.size()); ++i)
+			callback(inst.operands[i]);
+	};
+
+	if (inst.type != 0)
+		callback(inst.type);
+
+	switch (inst.op)
+	{
+	case spv::OpNop:
+	case spv::OpSource:
+	case spv::OpString:
+	case spv::OpCapability:
+	case spv::OpExtInstImport:
+	case spv::OpMemoryModel:
+	case spv::OpTypeVoid:
+	case spv::OpTypeBool:
+	case spv::OpTypeInt:
+	case spv::OpTypeFloat:
+	case spv::OpConstant:
+	case spv::OpConstantTrue:
+	case spv::OpConstantFalse:
+	case spv::OpConstantNull:
+	case spv::OpSpecConstant:
+	case spv::OpSpecConstantTrue:
+	case spv::OpSpecConstantFalse:
+		break;
+	case spv::OpName:
+	case spv::OpMemberName:
+	case spv::OpLine:
+	case spv::OpDecorate:
+	case spv::OpMemberDecorate:
+	case spv::OpExecutionMode:
+	case spv::OpTypeVector:
+	case spv::OpTypeMatrix:
+	case spv::OpTypeImage:
+	case spv::OpLoad:
+	case spv::OpCompositeExtract:
+	case spv::OpSelectionMerge:
+		visit(0, 1);
+		break;
+	case spv::OpEntryPoint:
+		visit(1, 2);
+		visit(2 + (std::strlen(reinterpret_cast<const char *>(&inst.operands[2])) + 4) / 4);
+		break;
+	case spv::OpTypePointer:
+	case spv::OpVariable:
+	case spv::OpFunction:
+		visit(1);
+		break;
+	case spv::OpStore:
+	case spv::OpCompositeInsert:
+	case spv::OpVectorShuffle:
+	case spv::OpLoopMerge:
+		visit(0, 2);
+		break;
+	case spv::OpExtInst:
+		visit(0, 1);
+		visit(2);
+		break;
+	case spv::OpBranchConditional:
+		visit(0, 3);
+		break;
+	case spv::OpSwitch:
+		visit(0, 2);
+		for (size_t i = 3; i < inst.operands.size(); i += 2)
+			callback(inst.operands[i]); // Skip case literals
+		break;
+	case spv::OpImageSampleImplicitLod:
+	case spv::OpImageSampleExplicitLod:
+	case spv::OpImageFetch:
+	case spv::OpImageRead:
+		visit(0, 2);
+		visit(3); // Skip image operands mask
+		break;
+	case spv::OpImageGather:
+	case spv::OpImageWrite:
+		visit(0, 3);
+		visit(4); // Skip image operands mask
+		break;
+	default:
+		visit(0);
+		break;
+	}
+}
+
 class codegen_spirv final : public codegen
 {
 	static_assert(sizeof(id) == sizeof(spv::Id), "unexpected SPIR-V id type size");
 
 public:
-	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y) :
+	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y, bool optimize) :
 		_debug_info(debug_info),
 		_vulkan_semantics(vulkan_semantics),
 		_uniforms_to_spec_constants(uniforms_to_spec_constants),
 		_enable_16bit_types(enable_16bit_types),
-		_flip_vert_y(flip_vert_y)
+		_flip_vert_y(flip_vert_y),
+		_optimize(optimize)
 	{
 		_glsl_ext = make_id();
 	}
@@ -179,12 +275,22 @@ private:
 			return lhs.return_type == rhs.return_type;
 		}
 	};
+	struct optimized_module
+	{
+		spirv_basic_block debug_b;
+		spirv_basic_block annotations;
+		spirv_basic_block types_and_constants;
+		spirv_basic_block variables;
+		std::vector<spv::Id> global_ubo_types;
+		std::vector<function_blocks> functions_blocks;
+	};
 
 	bool _debug_info = false;
 	bool _vulkan_semantics = false;
 	bool _uniforms_to_spec_constants = false;
 	bool _enable_16bit_types = false;
 	bool _flip_vert_y = false;
+	bool _optimize = false;
 
 	spirv_basic_block _entries;
 	spirv_basic_block _execution_modes;
@@ -308,10 +414,10 @@ private:
 				inst.write(spirv);
 		}
 	}
-	void finalize_type_and_constants_section(std::basic_string<char> &spirv) const
+	void finalize_type_and_constants_section(std::basic_string<char> &spirv, const spirv_basic_block &types_and_constants, const std::vector<spv::Id> &global_ubo_types) const
 	{
 		// All type declarations
-		for (const spirv_instruction &inst : _types_and_constants.instructions)
+		for (const spirv_instruction &inst : types_and_constants.instructions)
 			inst.write(spirv);
 
 		// Initialize the UBO type now that all member types are known
@@ -321,7 +427,7 @@ private:
 		const id global_ubo_type_ptr = _global_ubo_type + 1;
 
 		spirv_instruction(spv::OpTypeStruct, _global_ubo_type)
-			.add(_global_ubo_types.begin(), _global_ubo_types.end())
+			.add(global_ubo_types.begin(), global_ubo_types.end())
 			.write(spirv);
 		spirv_instruction(spv::OpTypePointer, global_ubo_type_ptr)
 			.add(spv::StorageClassUniform)
@@ -335,6 +441,23 @@ private:
 
 	std::basic_string<char> finalize_code() const override
 	{
+		optimized_module optimized;
+		if (_optimize)
+		{
+			std::vector<spv::Id> entry_point_ids;
+			for (const spirv_instruction &inst : _entries.instructions)
+				entry_point_ids.push_back(inst.operands[1]);
+
+			optimize_module(optimized, entry_point_ids);
+		}
+
+		const spirv_basic_block &debug_b = _optimize ? optimized.debug_b : _debug_b;
+		const spirv_basic_block &annotations = _optimize ? optimized.annotations : _annotations;
+		const spirv_basic_block &types_and_constants = _optimize ? optimized.types_and_constants : _types_and_constants;
+		const spirv_basic_block &variables = _optimize ? optimized.variables : _variables;
+		const std::vector<spv::Id> &global_ubo_types = _optimize ? optimized.global_ubo_types : _global_ubo_types;
+		const std::vector<function_blocks> &functions_blocks = _optimize ? optimized.functions_blocks : _functions_blocks;
+
 		std::basic_string<char> spirv;
 		finalize_header_section(spirv);
 
@@ -348,20 +471,20 @@ private:
 
 		finalize_debug_info_section(spirv);
 
-		for (const spirv_instruction &inst : _debug_b.instructions)
+		for (const spirv_instruction &inst : debug_b.instructions)
 			inst.write(spirv);
 
 		// All annotation instructions
-		for (const spirv_instruction &inst : _annotations.instructions)
+		for (const spirv_instruction &inst : annotations.instructions)
 			inst.write(spirv);
 
-		finalize_type_and_constants_section(spirv);
+		finalize_type_and_constants_section(spirv, types_and_constants, global_ubo_types);
 
-		for (const spirv_instruction &inst : _variables.instructions)
+		for (const spirv_instruction &inst : variables.instructions)
 			inst.write(spirv);
 
 		// All function definitions
-		for (const function_blocks &func : _functions_blocks)
+		for (const function_blocks &func : functions_blocks)
 		{
 			if (func.definition.instructions.empty())
 				continue;
@@ -387,6 +510,17 @@ private:
 		if (entry_point == nullptr)
 			return {};
 
+		optimized_module optimized;
+		if (_optimize)
+			optimize_module(optimized, { entry_point->id });
+
+		const spirv_basic_block &debug_b = _optimize ? optimized.debug_b : _debug_b;
+		const spirv_basic_block &annotations = _optimize ? optimized.annotations : _annotations;
+		const spirv_basic_block &types_and_constants = _optimize ? optimized.types_and_constants : _types_and_constants;
+		const spirv_basic_block &variables = _optimize ? optimized.variables : _variables;
+		const std::vector<spv::Id> &global_ubo_types = _optimize ? optimized.global_ubo_types : _global_ubo_types;
+		const std::vector<function_blocks> &functions_blocks = _optimize ? optimized.functions_blocks : _functions_blocks;
+
 		// Build list of IDs to remove
 		std::vector<spv::Id> variables_to_remove;
 		std::vector<spv::Id> functions_to_remove;
@@ -427,7 +561,7 @@ private:
 
 		finalize_debug_info_section(spirv);
 
-		for (const spirv_instruction &inst : _debug_b.instructions)
+		for (const spirv_instruction &inst : debug_b.instructions)
 		{
 			// Remove all names of interface variables and functions for non-matching entry points
 			if (std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.operands[0]) != variables_to_remove.end() ||
@@ -438,7 +572,7 @@ private:
 		}
 
 		// All annotation instructions
-		for (spirv_instruction inst : _annotations.instructions)
+		for (spirv_instruction inst : annotations.instructions)
 		{
 			if (inst.op == spv::OpDecorate)
 			{
@@ -462,9 +596,9 @@ private:
 			inst.write(spirv);
 		}
 
-		finalize_type_and_constants_section(spirv);
+		finalize_type_and_constants_section(spirv, types_and_constants, global_ubo_types);
 
-		for (const spirv_instruction &inst : _variables.instructions)
+		for (const spirv_instruction &inst : variables.instructions)
 		{
 			// Remove all declarations of the interface variables for non-matching entry points
 			if (inst.op == spv::OpVariable && std::find(variables_to_remove.begin(), variables_to_remove.end(), inst.result) != variables_to_remove.end())
@@ -474,7 +608,7 @@ private:
 		}
 
 		// All referenced function definitions
-		for (const function_blocks &function : _functions_blocks)
+		for (const function_blocks &function : functions_blocks)
 		{
 			if (function.definition.instructions.empty())
 				continue;
@@ -501,6 +635,249 @@ private:
 		return spirv;
 	}
 
+	static spv::Id function_definition_id(const function_blocks &func)
+	{
+		const auto it = std::find_if(func.declaration.instructions.begin(), func.declaration.instructions.end(),
+			[](const spirv_instruction &inst) { return inst.op == spv::OpFunction; });
+		return it != func.declaration.instructions.end() ? it->result : 0;
+	}
+
+	/// <summary>
+	/// Runs the built-in optimization passes on a copy of the module sections, keeping only what is reachable from the specified entry points.
+	/// </summary>
+	void optimize_module(optimized_module &module, const std::vector<spv::Id> &entry_point_ids) const
+	{
+		// IDs whose definition was removed, so that any names and decorations targeting them are stripped as well
+		std::unordered_set<spv::Id> removed_ids;
+		// IDs that were replaced by another equivalent one
+		std::unordered_map<spv::Id, spv::Id> replaced_ids;
+
+		const auto resolve_id = [&replaced_ids](spv::Id id) {
+			for (auto it = replaced_ids.find(id); it != replaced_ids.end(); it = replaced_ids.find(id))
+				id = it->second;
+			return id;
+		};
+		const auto replace_ids = [&resolve_id](spirv_instruction &inst) {
+			for_each_id_operand(inst, [&resolve_id](spv::Id &id) { id = resolve_id(id); });
+		};
+
+		// Dead function elimination: Only keep functions that are transitively called from the entry points
+		{
+			std::unordered_set<spv::Id> reachable_functions;
+			std::vector<spv::Id> worklist = entry_point_ids;
+			while (!worklist.empty())
+			{
+				const spv::Id function_id = worklist.back();
+				worklist.pop_back();
+
+				if (!reachable_functions.insert(function_id).second)
+					continue;
+
+				const auto it = std::find_if(_functions_blocks.begin(), _functions_blocks.end(),
+					[function_id](const function_blocks &func) { return function_definition_id(func) == function_id; });
+				if (it == _functions_blocks.end())
+					continue;
+
+				for (const spirv_instruction &inst : it->definition.instructions)
+					if (inst.op == spv::OpFunctionCall)
+						worklist.push_back(inst.operands[0]);
+			}
+
+			for (const function_blocks &func : _functions_blocks)
+			{
+				if (reachable_functions.find(function_definition_id(func)) != reachable_functions.end())
+				{
+					module.functions_blocks.push_back(func);
+					continue;
+				}
+
+				for (const spirv_basic_block *block : { &func.declaration, &func.variables, &func.definition })
+					for (const spirv_instruction &inst : block->instructions)
+						if (inst.result != 0)
+							removed_ids.insert(inst.result);
+			}
+		}
+
+		// Constant and type deduplication: Merge declarations with identical opcode, result type and operands (e.g. constants of "min16float" and "float" type, which map to the same SPIR-V type)
+		{
+			std::unordered_set<spv::Id> decorated_ids;
+			for (const spirv_instruction &inst : _annotations.instructions)
+				decorated_ids.insert(inst.operands[0]);
+
+			std::map<std::vector<uint32_t>, spv::Id> declarations;
+			module.types_and_constants.instructions.reserve(_types_and_constants.instructions.size());
+
+			for (spirv_instruction inst : _types_and_constants.instructions)
+			{
+				replace_ids(inst);
+
+				switch (inst.op)
+				{
+				case spv::OpTypeVoid:
+				case spv::OpTypeBool:
+				case spv::OpTypeInt:
+				case spv::OpTypeFloat:
+				case spv::OpTypeVector:
+				case spv::OpTypeMatrix:
+				case spv::OpTypeImage:
+				case spv::OpTypeSampledImage:
+				case spv::OpTypePointer:
+				case spv::OpTypeFunction:
+				case spv::OpConstant:
+				case spv::OpConstantTrue:
+				case spv::OpConstantFalse:
+				case spv::OpConstantNull:
+				case spv::OpConstantComposite:
+				case spv::OpUndef:
+					if (decorated_ids.find(inst.result) == decorated_ids.end())
+					{
+						std::vector<uint32_t> key;
+						key.reserve(2 + inst.operands.size());
+						key.push_back(inst.op);
+						key.push_back(inst.type);
+						key.insert(key.end(), inst.operands.begin(), inst.operands.end());
+
+						if (const auto insert = declarations.emplace(std::move(key), inst.result);
+							!insert.second)
+						{
+							replaced_ids[inst.result] = insert.first->second;
+							continue;
+						}
+					}
+					break;
+				}
+
+				module.types_and_constants.instructions.push_back(std::move(inst));
+			}
+
+			module.global_ubo_types = _global_ubo_types;
+			for (spv::Id &type_id : module.global_ubo_types)
+				type_id = resolve_id(type_id);
+		}
+
+		// Store-to-load forwarding and dead store elimination on function-local variables that are only ever accessed through direct loads and stores (so they cannot alias)
+		for (function_blocks &func : module.functions_blocks)
+		{
+			std::unordered_set<spv::Id> local_variables;
+			for (const spirv_instruction &inst : func.variables.instructions)
+				if (inst.op == spv::OpVariable)
+					local_variables.insert(inst.result);
+
+			for (spirv_instruction &inst : func.definition.instructions)
+			{
+				// Any use other than as the pointer operand of a load or store (e.g. in an access chain or as a function call argument) disqualifies a variable
+				for_each_id_operand(inst, [&inst, &local_variables](spv::Id &id) {
+					if ((inst.op != spv::OpLoad && inst.op != spv::OpStore) || &id != inst.operands.data())
+						local_variables.erase(id);
+				});
+			}
+
+			if (local_variables.empty())
+				continue;
+
+			std::vector<bool> dead_instructions(func.definition.instructions.size());
+			std::unordered_map<spv::Id, spv::Id> known_values;
+			std::unordered_map<spv::Id, size_t> pending_stores;
+
+			for (size_t i = 0; i < func.definition.instructions.size(); ++i)
+			{
+				spirv_instruction &inst = func.definition.instructions[i];
+
+				switch (inst.op)
+				{
+				case spv::OpLabel:
+					// Only forward within a basic block, since there is no information about the control flow reaching it
+					known_values.clear();
+					pending_stores.clear();
+					break;
+				case spv::OpStore:
+					if (const spv::Id pointer = inst.operands[0];
+						local_variables.find(pointer) != local_variables.end())
+					{
+						// A previous store to the same variable in this block that was not read in between is overwritten
+						if (const auto it = pending_stores.find(pointer);
+							it != pending_stores.end())
+							dead_instructions[it->second] = true;
+
+						known_values[pointer] = resolve_id(inst.operands[1]);
+						pending_stores[pointer] = i;
+					}
+					break;
+				case spv::OpLoad:
+					if (const spv::Id pointer = inst.operands[0];
+						local_variables.find(pointer) != local_variables.end())
+					{
+						if (const auto it = known_values.find(pointer);
+							it != known_values.end())
+						{
+							replaced_ids[inst.result] = it->second;
+							dead_instructions[i] = true;
+						}
+						else
+						{
+							known_values[pointer] = inst.result;
+						}
+					}
+					break;
+				}
+			}
+
+			// Variables that are never loaded from anymore can be removed entirely, along with all stores to them
+			std::unordered_set<spv::Id> unused_variables = local_variables;
+			for (size_t i = 0; i < func.definition.instructions.size(); ++i)
+				if (func.definition.instructions[i].op == spv::OpLoad && !dead_instructions[i])
+					unused_variables.erase(func.definition.instructions[i].operands[0]);
+
+			for (size_t i = 0; i < func.definition.instructions.size(); ++i)
+				if (func.definition.instructions[i].op == spv::OpStore && unused_variables.find(func.definition.instructions[i].operands[0]) != unused_variables.end())
+					dead_instructions[i] = true;
+
+			size_t k = 0;
+			for (size_t i = 0; i < func.definition.instructions.size(); ++i)
+			{
+				if (dead_instructions[i])
+				{
+					if (func.definition.instructions[i].result != 0)
+						removed_ids.insert(func.definition.instructions[i].result);
+					continue;
+				}
+
+				if (k != i)
+					func.definition.instructions[k] = std::move(func.definition.instructions[i]);
+				++k;
+			}
+			func.definition.instructions.resize(k);
+
+			func.variables.instructions.erase(
+				std::remove_if(func.variables.instructions.begin(), func.variables.instructions.end(),
+					[&unused_variables](const spirv_instruction &inst) { return inst.op == spv::OpVariable && unused_variables.find(inst.result) != unused_variables.end(); }),
+				func.variables.instructions.end());
+			removed_ids.insert(unused_variables.begin(), unused_variables.end());
+		}
+
+		// Update all references to replaced IDs (this has to happen after all passes, since e.g. phi instructions in loop headers may reference values that are defined later in the instruction stream)
+		module.variables = _variables;
+		for (spirv_instruction &inst : module.variables.instructions)
+			replace_ids(inst);
+
+		for (function_blocks &func : module.functions_blocks)
+			for (spirv_basic_block *block : { &func.declaration, &func.variables, &func.definition })
+				for (spirv_instruction &inst : block->instructions)
+					replace_ids(inst);
+
+		// Strip names and decorations of anything that no longer exists
+		const auto is_removed = [&removed_ids, &replaced_ids](const spirv_instruction &inst) {
+			return removed_ids.find(inst.operands[0]) != removed_ids.end() || replaced_ids.find(inst.operands[0]) != replaced_ids.end();
+		};
+
+		module.debug_b.instructions.reserve(_debug_b.instructions.size());
+		std::copy_if(_debug_b.instructions.begin(), _debug_b.instructions.end(), std::back_inserter(module.debug_b.instructions),
+			[&is_removed](const spirv_instruction &inst) { return !is_removed(inst); });
+		module.annotations.instructions.reserve(_annotations.instructions.size());
+		std::copy_if(_annotations.instructions.begin(), _annotations.instructions.end(), std::back_inserter(module.annotations.instructions),
+			[&is_removed](const spirv_instruction &inst) { return !is_removed(inst); });
+	}
+
 	spv::Id convert_type(type info, bool is_ptr = false, spv::StorageClass storage = spv::StorageClassFunction, spv::ImageFormat format = spv::ImageFormatUnknown, uint32_t array_stride = 0)
 	{
 		assert(array_stride == 0 || info.is_array());
@@ -2564,7 +2941,7 @@ private:
 	}
 };
 
-codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y)
+codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y, bool optimize)
 {
-	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, enable_16bit_types, flip_vert_y);
+	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, enable_16bit_types, flip_vert_y, optimize);
 }
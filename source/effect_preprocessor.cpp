@@ -7,7 +7,9 @@
 #include "effect_preprocessor.hpp"
 #include <cstdio> // fclose, fopen, fread, fseek
 #include <cassert>
-#include <algorithm> // std::find_if
+#include <algorithm> // std::all_of, std::find_if
+#include <mutex>
+#include <shared_mutex>
 
 #ifndef _WIN32
 	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
@@ -61,6 +63,232 @@ static const int s_precedence_lookup[] = {
 	11, 11, 11, 11 // unary operators
 };
 
+struct rpn_token
+{
+	int value;
+	bool is_op;
+};
+
+/// <summary>
+/// A '#if' or '#elif' expression converted to reverse polish notation, with macro references kept by name so that they can be resolved again whenever the expression is encountered.
+/// </summary>
+struct compiled_expression
+{
+	enum class operand_type : uint8_t
+	{
+		literal,
+		op,
+		macro,
+		defined
+	};
+
+	struct operand
+	{
+		operand_type type;
+		int value;
+		std::string name;
+	};
+
+	std::string text;
+	std::vector<operand> rpn;
+};
+
+// These caches are shared between all preprocessor instances, since the same headers are included by many effects
+static std::shared_mutex s_expression_cache_mutex;
+static std::unordered_map<std::string, compiled_expression> s_expression_cache;
+static std::shared_mutex s_include_guard_cache_mutex;
+static std::unordered_map<size_t, std::string> s_include_guard_cache;
+
+static const char *evaluate_rpn(const rpn_token *rpn, size_t rpn_index, int &result)
+{
+	size_t stack_index = 0;
+	const size_t STACK_SIZE = 128;
+	int stack[STACK_SIZE];
+
+#define UNARY_OPERATION(op) { \
+	if (stack_index < 1) \
+		return "invalid expression"; \
+	stack[stack_index - 1] = op stack[stack_index - 1]; \
+	}
+#define BINARY_OPERATION(op) { \
+	if (stack_index < 2) \
+		return "invalid expression"; \
+	stack[stack_index - 2] = stack[stack_index - 2] op stack[stack_index - 1]; \
+	stack_index--; \
+	}
+
+	// Evaluate reverse polish notation output
+	for (const rpn_token *token = rpn; rpn_index--; token++)
+	{
+		if (token->is_op)
+		{
+			switch (token->value)
+			{
+			case op_or:
+				BINARY_OPERATION(||);
+				break;
+			case op_and:
+				BINARY_OPERATION(&&);
+				break;
+			case op_bitor:
+				BINARY_OPERATION(|);
+				break;
+			case op_bitxor:
+				BINARY_OPERATION(^);
+				break;
+			case op_bitand:
+				BINARY_OPERATION(&);
+				break;
+			case op_not_equal:
+				BINARY_OPERATION(!=);
+				break;
+			case op_equal:
+				BINARY_OPERATION(==);
+				break;
+			case op_less:
+				BINARY_OPERATION(<);
+				break;
+			case op_greater:
+				BINARY_OPERATION(>);
+				break;
+			case op_less_equal:
+				BINARY_OPERATION(<=);
+				break;
+			case op_greater_equal:
+				BINARY_OPERATION(>=);
+				break;
+			case op_leftshift:
+				BINARY_OPERATION(<<);
+				break;
+			case op_rightshift:
+				BINARY_OPERATION(>>);
+				break;
+			case op_add:
+				BINARY_OPERATION(+);
+				break;
+			case op_subtract:
+				BINARY_OPERATION(-);
+				break;
+			case op_modulo:
+				if (stack_index < 2 || stack[stack_index - 1] == 0)
+					return stack_index < 2 ? "invalid expression" : "right operand of '%' is zero";
+				BINARY_OPERATION(%);
+				break;
+			case op_divide:
+				if (stack_index < 2 || stack[stack_index - 1] == 0)
+					return stack_index < 2 ? "invalid expression" : "division by zero";
+				BINARY_OPERATION(/);
+				break;
+			case op_multiply:
+				BINARY_OPERATION(*);
+				break;
+			case op_plus:
+				UNARY_OPERATION(+);
+				break;
+			case op_negate:
+				UNARY_OPERATION(-);
+				break;
+			case op_not:
+				UNARY_OPERATION(!);
+				break;
+			case op_bitnot:
+				UNARY_OPERATION(~);
+				break;
+			}
+		}
+		else
+		{
+			if (stack_index >= STACK_SIZE)
+				return "expression evaluator ran out of stack space";
+
+			stack[stack_index++] = token->value;
+		}
+	}
+
+#undef UNARY_OPERATION
+#undef BINARY_OPERATION
+
+	if (stack_index != 1)
+		return "invalid expression";
+
+	result = stack[0];
+	return nullptr;
+}
+
+static bool parse_integer_replacement_list(const std::string &replacement_list, int &value)
+{
+	// Only handle plain decimal numbers that fit into an integer, anything else is left to the normal macro expansion
+	if (replacement_list.empty() || replacement_list.size() > 9 || (replacement_list[0] == '0' && replacement_list.size() > 1) ||
+		!std::all_of(replacement_list.begin(), replacement_list.end(), [](char c) { return c >= '0' && c <= '9'; }))
+		return false;
+
+	value = std::stoi(replacement_list);
+	return true;
+}
+
+static std::string find_include_guard(const std::string &source_code)
+{
+	reshadefx::lexer lexer(
+		source_code,
+		true  /* ignore_comments */,
+		true  /* ignore_whitespace */,
+		false /* ignore_pp_directives */,
+		false /* ignore_line_directives */,
+		true  /* ignore_keywords */,
+		false /* escape_string_literals */);
+
+	// The file has to start with an '#ifndef' directive ...
+	if (lexer.lex() != reshadefx::tokenid::hash_ifndef)
+		return std::string();
+
+	reshadefx::token tok = lexer.lex();
+	if (tok != reshadefx::tokenid::identifier)
+		return std::string();
+
+	const std::string guard_name = std::move(tok.literal_as_string);
+
+	// ... and the matching '#endif' has to be the last token in the file, without any '#else' or '#elif' branches in between
+	for (int level = 1; level != 0;)
+	{
+		switch (lexer.lex())
+		{
+		case reshadefx::tokenid::hash_if:
+		case reshadefx::tokenid::hash_ifdef:
+		case reshadefx::tokenid::hash_ifndef:
+			level++;
+			break;
+		case reshadefx::tokenid::hash_else:
+		case reshadefx::tokenid::hash_elif:
+			if (level == 1)
+				return std::string();
+			break;
+		case reshadefx::tokenid::hash_endif:
+			level--;
+			break;
+		case reshadefx::tokenid::end_of_file:
+			return std::string();
+		default:
+			break;
+		}
+	}
+
+	if (lexer.lex() != reshadefx::tokenid::end_of_file)
+		return std::string();
+
+	return guard_name;
+}
+
+static bool is_builtin_macro(const std::string &name)
+{
+	return
+		name == "__LINE__" ||
+		name == "__FILE__" ||
+		name == "__FILE_STEM__" ||
+		name == "__FILE_STEM_HASH__" ||
+		name == "__FILE_NAME__" ||
+		name == "__FILE_NAME_HASH__";
+}
+
 static bool read_file(const std::filesystem::path &path, std::string &file_data)
 {
 	// Read file contents into memory
@@ -734,6 +962,14 @@ void reshadefx::preprocessor::parse_include()
 	std::string input;
 	if (const auto it = _file_cache.find(file_path_string); it != _file_cache.end())
 	{
+		// Skip files that were included before and are either marked with '#pragma once' or fully enclosed in an include guard that is defined by now, to avoid lexing them again just to discard all their tokens
+		if (it->second.empty() || is_include_guard_defined(it->second))
+		{
+			if (!expect(tokenid::end_of_line))
+				consume_until(tokenid::end_of_line);
+			return;
+		}
+
 		input = it->second;
 	}
 	else
@@ -757,18 +993,46 @@ void reshadefx::preprocessor::parse_include()
 
 bool reshadefx::preprocessor::evaluate_expression()
 {
-	struct rpn_token
-	{
-		int value;
-		bool is_op;
-	};
-
 	size_t rpn_index = 0;
 	size_t stack_index = 0;
 	const size_t STACK_SIZE = 128;
 	rpn_token rpn[STACK_SIZE];
 	int stack[STACK_SIZE];
 
+	// Expressions in files are cached by their location, so that they do not have to be parsed again when encountered another time (e.g. when the same header is included by multiple effects)
+	std::string cache_key, expression_text;
+	std::vector<std::pair<size_t, compiled_expression::operand>> references;
+	bool cacheable = false;
+	if (!_input_stack.empty() && _next_input_index == _current_input_index)
+	{
+		input_level &input = _input_stack[_current_input_index];
+
+		if (!input.name.empty() && input.hidden_macros.empty() &&
+			input.next_token != tokenid::end_of_line && input.next_token != tokenid::end_of_file)
+		{
+			const std::string &input_string = input.lexer->input_string();
+			const size_t line_end = input_string.find('\n', input.next_token.offset);
+			expression_text = input_string.substr(input.next_token.offset, line_end != std::string::npos ? line_end - input.next_token.offset : std::string::npos);
+
+			// Expressions continued on the next line (via a backslash or a multi-line comment) are not cached
+			const size_t text_end = expression_text.find_last_not_of('\r');
+			cacheable = expression_text.find("/*") == std::string::npos && (text_end == std::string::npos || expression_text[text_end] != '\\');
+
+			if (cacheable)
+			{
+				cache_key = input.name + '@' + std::to_string(input.next_token.offset);
+
+				if (int result = 0; evaluate_cached_expression(cache_key, expression_text, result))
+				{
+					// Skip the rest of the expression, so that the next token is the end of the line
+					input.lexer->skip_to_next_line();
+					input.next_token = input.lexer->lex();
+					return result != 0;
+				}
+			}
+		}
+	}
+
 	// Keep track of previous token to figure out data type of expression
 	tokenid previous_token = _token;
 
@@ -888,11 +1152,30 @@ bool reshadefx::preprocessor::evaluate_expression()
 				return error(_token.location, "unmatched ')'"), false;
 			break;
 		case tokenid::identifier:
+			if (cacheable && !is_builtin_macro(_token.literal_as_string))
+			{
+				// Substitute macros that are plain numbers directly, so that they can be resolved again when evaluating the cached expression
+				int value = 0;
+				if (const auto it = _macros.find(_token.literal_as_string);
+					it != _macros.end() && !it->second.is_function_like && parse_integer_replacement_list(it->second.replacement_list, value))
+				{
+					references.push_back({ rpn_index, { compiled_expression::operand_type::macro, 0, _token.literal_as_string } });
+					rpn[rpn_index++] = { value, false };
+					previous_token = tokenid::int_literal;
+					continue;
+				}
+			}
+
 			if (evaluate_identifier_as_macro())
+			{
+				cacheable = false;
 				continue;
+			}
 
 			if (_token.literal_as_string == "exists")
 			{
+				cacheable = false;
+
 				const bool has_parentheses = accept(tokenid::parenthesis_open);
 
 				while (accept(tokenid::identifier))
@@ -935,11 +1218,13 @@ bool reshadefx::preprocessor::evaluate_expression()
 				if (has_parentheses && !expect(tokenid::parenthesis_close))
 					return false;
 
+				references.push_back({ rpn_index, { compiled_expression::operand_type::defined, 0, macro_name } });
 				rpn[rpn_index++] = { is_defined(macro_name) ? 1 : 0, false };
 				continue;
 			}
 
 			// An identifier that cannot be replaced with a number becomes zero
+			references.push_back({ rpn_index, { compiled_expression::operand_type::macro, 0, _token.literal_as_string } });
 			rpn[rpn_index++] = { 0, false };
 			break;
 		case tokenid::int_literal:
@@ -981,107 +1266,76 @@ bool reshadefx::preprocessor::evaluate_expression()
 		rpn[rpn_index++] = { op, true };
 	}
 
-#define UNARY_OPERATION(op) { \
-	if (stack_index < 1) \
-		return error(_token.location, "invalid expression"), 0; \
-	stack[stack_index - 1] = op stack[stack_index - 1]; \
-	}
-#define BINARY_OPERATION(op) { \
-	if (stack_index < 2) \
-		return error(_token.location, "invalid expression"), 0; \
-	stack[stack_index - 2] = stack[stack_index - 2] op stack[stack_index - 1]; \
-	stack_index--; \
+	int result = 0;
+	if (const char *const message = evaluate_rpn(rpn, rpn_index, result))
+		return error(_token.location, message), false;
+
+	if (cacheable)
+	{
+		compiled_expression expression;
+		expression.text = std::move(expression_text);
+		expression.rpn.reserve(rpn_index);
+
+		for (size_t i = 0, k = 0; i < rpn_index; ++i)
+		{
+			if (k < references.size() && references[k].first == i)
+				expression.rpn.push_back(std::move(references[k++].second));
+			else
+				expression.rpn.push_back({ rpn[i].is_op ? compiled_expression::operand_type::op : compiled_expression::operand_type::literal, rpn[i].value });
+		}
+
+		const std::unique_lock<std::shared_mutex> lock(s_expression_cache_mutex);
+		s_expression_cache[std::move(cache_key)] = std::move(expression);
 	}
 
-	// Evaluate reverse polish notation output
-	for (rpn_token *token = rpn; rpn_index--; token++)
+	return result != 0;
+}
+bool reshadefx::preprocessor::evaluate_cached_expression(const std::string &cache_key, const std::string &expression_text, int &result) const
+{
+	const std::shared_lock<std::shared_mutex> lock(s_expression_cache_mutex);
+
+	const auto it = s_expression_cache.find(cache_key);
+	if (it == s_expression_cache.end() || it->second.text != expression_text)
+		return false;
+
+	size_t rpn_index = 0;
+	const size_t STACK_SIZE = 128;
+	rpn_token rpn[STACK_SIZE];
+	assert(it->second.rpn.size() <= STACK_SIZE);
+
+	for (const compiled_expression::operand &operand : it->second.rpn)
 	{
-		if (token->is_op)
+		switch (operand.type)
 		{
-			switch (token->value)
+		case compiled_expression::operand_type::literal:
+			rpn[rpn_index++] = { operand.value, false };
+			break;
+		case compiled_expression::operand_type::op:
+			rpn[rpn_index++] = { operand.value, true };
+			break;
+		case compiled_expression::operand_type::defined:
+			rpn[rpn_index++] = { is_defined(operand.name) ? 1 : 0, false };
+			break;
+		case compiled_expression::operand_type::macro:
+			if (const auto macro_it = _macros.find(operand.name); macro_it == _macros.end())
 			{
-			case op_or:
-				BINARY_OPERATION(||);
-				break;
-			case op_and:
-				BINARY_OPERATION(&&);
-				break;
-			case op_bitor:
-				BINARY_OPERATION(|);
-				break;
-			case op_bitxor:
-				BINARY_OPERATION(^);
-				break;
-			case op_bitand:
-				BINARY_OPERATION(&);
-				break;
-			case op_not_equal:
-				BINARY_OPERATION(!=);
-				break;
-			case op_equal:
-				BINARY_OPERATION(==);
-				break;
-			case op_less:
-				BINARY_OPERATION(<);
-				break;
-			case op_greater:
-				BINARY_OPERATION(>);
-				break;
-			case op_less_equal:
-				BINARY_OPERATION(<=);
-				break;
-			case op_greater_equal:
-				BINARY_OPERATION(>=);
-				break;
-			case op_leftshift:
-				BINARY_OPERATION(<<);
-				break;
-			case op_rightshift:
-				BINARY_OPERATION(>>);
-				break;
-			case op_add:
-				BINARY_OPERATION(+);
-				break;
-			case op_subtract:
-				BINARY_OPERATION(-);
-				break;
-			case op_modulo:
-				if (stack[stack_index - 1] == 0)
-					return error(_token.location, "right operand of '%' is zero"), 0;
-				BINARY_OPERATION(%);
-				break;
-			case op_divide:
-				if (stack[stack_index - 1] == 0)
-					return error(_token.location, "division by zero"), 0;
-				BINARY_OPERATION(/);
-				break;
-			case op_multiply:
-				BINARY_OPERATION(*);
-				break;
-			case op_plus:
-				UNARY_OPERATION(+);
-				break;
-			case op_negate:
-				UNARY_OPERATION(-);
-				break;
-			case op_not:
-				UNARY_OPERATION(!);
-				break;
-			case op_bitnot:
-				UNARY_OPERATION(~);
-				break;
+				rpn[rpn_index++] = { 0, false };
 			}
-		}
-		else
-		{
-			stack[stack_index++] = token->value;
+			else
+			{
+				// Fall back to a full evaluation of the expression if the macro changed into something that is not a plain number
+				int value = 0;
+				if (macro_it->second.is_function_like || !parse_integer_replacement_list(macro_it->second.replacement_list, value))
+					return false;
+
+				rpn[rpn_index++] = { value, false };
+			}
+			break;
 		}
 	}
 
-	if (stack_index != 1)
-		return error(_token.location, "invalid expression"), false;
-
-	return stack[0] != 0;
+	// Errors are reported by the full evaluation
+	return evaluate_rpn(rpn, rpn_index, result) == nullptr;
 }
 
 bool reshadefx::preprocessor::evaluate_identifier_as_macro()
@@ -1191,6 +1445,36 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	return true;
 }
 
+bool reshadefx::preprocessor::is_include_guard_defined(const std::string &source_code)
+{
+	const size_t source_code_hash = std::hash<std::string>()(source_code);
+
+	std::string guard_name;
+	if (std::shared_lock<std::shared_mutex> lock(s_include_guard_cache_mutex);
+		s_include_guard_cache.find(source_code_hash) != s_include_guard_cache.end())
+	{
+		guard_name = s_include_guard_cache.at(source_code_hash);
+	}
+	else
+	{
+		lock.unlock();
+
+		guard_name = find_include_guard(source_code);
+
+		const std::unique_lock<std::shared_mutex> lock_write(s_include_guard_cache_mutex);
+		s_include_guard_cache.emplace(source_code_hash, guard_name);
+	}
+
+	if (guard_name.empty() || !is_defined(guard_name))
+		return false;
+
+	// Add to used macro list like the '#ifndef' in the skipped file would
+	if (const auto it = _macros.find(guard_name); it == _macros.end() || it->second.is_predefined)
+		_used_macros.emplace(std::move(guard_name));
+
+	return true;
+}
+
 bool reshadefx::preprocessor::is_defined(const std::string &name) const
 {
 	return _macros.find(name) != _macros.end() ||
@@ -136,8 +136,10 @@ namespace reshadefx
 		void parse_include();
 
 		bool evaluate_expression();
+		bool evaluate_cached_expression(const std::string &cache_key, const std::string &expression_text, int &result) const;
 		bool evaluate_identifier_as_macro();
 
+		bool is_include_guard_defined(const std::string &source_code);
 		bool is_defined(const std::string &name) const;
 		void expand_macro(const std::string &name, const macro &macro, const std::vector<std::string> &arguments);
 		void create_macro_replacement_list(macro &macro);
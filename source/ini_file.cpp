@@ -4,14 +4,183 @@
  */
 
 #include "ini_file.hpp"
+#include <mutex>
+#include <atomic>
 #include <shared_mutex>
+#include <condition_variable>
 #include <cctype> // std::toupper
 #include <cassert>
-#include <algorithm> // std::min, std::sort, std::transform
+#include <algorithm> // std::all_of, std::find_if, std::min, std::lower_bound, std::sort, std::stable_sort, std::unique
 #include <utf8/core.h>
+#include <Windows.h>
 
-static std::shared_mutex s_ini_cache_mutex;
-static std::unordered_map<std::wstring, std::unique_ptr<ini_file>> s_ini_cache;
+// Cache is split into multiple shards with their own lock, so that threads accessing different files do not contend for the same lock
+struct alignas(64) ini_cache_shard
+{
+	std::shared_mutex mutex;
+	std::unordered_map<std::wstring, std::unique_ptr<ini_file>> files;
+};
+
+static ini_cache_shard s_ini_cache[16];
+static std::atomic<uint64_t> s_ini_cache_hits = 0;
+static std::atomic<uint64_t> s_ini_cache_misses = 0;
+static std::atomic<uint64_t> s_ini_cache_reloads = 0;
+
+static ini_cache_shard &get_cache_shard(const std::filesystem::path &path)
+{
+	return s_ini_cache[std::hash<std::wstring>()(path.native()) % std::size(s_ini_cache)];
+}
+
+// Time a file has to be left unmodified before it is saved by 'flush_cache', so that changes made in quick succession (e.g. while dragging a slider) only cause a single write
+static constexpr std::chrono::seconds s_flush_delay(1);
+
+// Replaces the file with the new data by writing to a temporary file first and then renaming it, so that the file is never left partially written
+static bool write_file(const std::filesystem::path &path, const std::string &data, std::filesystem::file_time_type modified_at, std::filesystem::file_time_type &written_at)
+{
+	std::error_code ec;
+	if (const std::filesystem::file_time_type modified_at_on_disk = std::filesystem::last_write_time(path, ec);
+		!ec && (modified_at_on_disk - modified_at) > std::chrono::seconds(2))
+		return false; // File exists and was modified on disk and therefore may have different data, so cannot save
+
+	std::filesystem::path temp_path = path;
+	temp_path += L".tmp";
+
+	FILE *const file = _wfsopen(temp_path.c_str(), L"w", SH_DENYWR);
+	if (file == nullptr)
+		return false;
+	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
+	const bool close_success = fclose(file) == 0;
+	if (file_size_written != data.size() || !close_success)
+	{
+		std::filesystem::remove(temp_path, ec);
+		return false;
+	}
+
+	// Replace the file in one step, so that a crash or concurrent read never sees a partially written file
+	std::filesystem::rename(temp_path, path, ec);
+	if (ec)
+	{
+		std::filesystem::remove(temp_path, ec);
+		return false;
+	}
+
+	written_at = std::filesystem::last_write_time(path, ec);
+
+	assert(!ec && std::filesystem::file_size(path, ec) > 0);
+
+	return true;
+}
+
+struct pending_write
+{
+	std::filesystem::path path;
+	std::string data;
+	std::filesystem::file_time_type modified_at;
+};
+struct finished_write
+{
+	bool success = true;
+	bool collected = false; // Whether 'flush_cache' already reported this result
+	std::filesystem::file_time_type modified_at;
+	std::filesystem::file_time_type written_at;
+};
+
+static std::mutex s_flush_mutex;
+static std::condition_variable s_flush_condition;
+static std::vector<pending_write> s_flush_queue;
+static std::unordered_map<std::wstring, finished_write> s_flush_results;
+static std::wstring s_flush_current_path;
+static bool s_flush_thread_running = false;
+static std::atomic<long long> s_flush_latency = 0;
+
+// Expects 's_flush_mutex' to be held
+static void write_queued_files(std::unique_lock<std::mutex> &lock)
+{
+	while (!s_flush_queue.empty())
+	{
+		pending_write write = std::move(s_flush_queue.front());
+		s_flush_queue.erase(s_flush_queue.begin());
+		s_flush_current_path = write.path.native();
+
+		lock.unlock();
+
+		const std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+
+		finished_write result;
+		result.modified_at = write.modified_at;
+		result.success = write_file(write.path, write.data, write.modified_at, result.written_at);
+
+		s_flush_latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+		lock.lock();
+
+		// Keep the result until the next write of the same file, so that 'wait_for_flush' can still report it after 'flush_cache' collected it
+		s_flush_results[write.path.native()] = result;
+		s_flush_current_path.clear();
+		s_flush_condition.notify_all();
+	}
+}
+
+static void CALLBACK flush_thread_callback(PTP_CALLBACK_INSTANCE instance, PVOID module)
+{
+	// Release the module reference taken when this callback was submitted (see 'queue_write') only after it returned, so that neither its code nor the static state it accesses is unloaded while it still runs
+	FreeLibraryWhenCallbackReturns(instance, static_cast<HMODULE>(module));
+
+	std::unique_lock<std::mutex> lock(s_flush_mutex);
+
+	write_queued_files(lock);
+
+	s_flush_thread_running = false;
+	s_flush_condition.notify_all();
+}
+
+static void queue_write(pending_write &&write)
+{
+	std::unique_lock<std::mutex> lock(s_flush_mutex);
+
+	// Replace data of a write to the same file that is still waiting in the queue, instead of writing the file twice
+	if (const auto it = std::find_if(s_flush_queue.begin(), s_flush_queue.end(), [&write](const pending_write &queued) { return queued.path == write.path; });
+		it != s_flush_queue.end())
+	{
+		it->data = std::move(write.data);
+		it->modified_at = write.modified_at;
+		return;
+	}
+
+	s_flush_queue.push_back(std::move(write));
+
+	if (s_flush_thread_running)
+		return;
+
+	// Files are written on a thread pool thread, which only runs as long as there are writes in the queue, so it does not need to be shut down explicitly
+	// Same as for log messages, it holds a reference to this module only while doing so, so that the module can still be unloaded once all writes finished
+	if (HMODULE module = nullptr;
+		GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&flush_thread_callback), &module))
+	{
+		if (TrySubmitThreadpoolCallback(&flush_thread_callback, module, nullptr))
+		{
+			s_flush_thread_running = true;
+			return;
+		}
+
+		FreeLibrary(module);
+	}
+
+	// Fall back to writing on this thread if the callback could not be submitted
+	write_queued_files(lock);
+}
+static bool is_write_pending(const std::wstring &path)
+{
+	return s_flush_current_path == path || std::find_if(s_flush_queue.begin(), s_flush_queue.end(), [&path](const pending_write &queued) { return queued.path.native() == path; }) != s_flush_queue.end();
+}
+static bool is_written_by_flush(const std::wstring &path, std::filesystem::file_time_type modified_at, std::filesystem::file_time_type modified_at_on_disk)
+{
+	const std::unique_lock<std::mutex> lock(s_flush_mutex);
+
+	// The file on disk still has the modification time of the last background write of it, and that write was of the data last serialized from an INI file with the specified modification time
+	const auto it = s_flush_results.find(path);
+	return it != s_flush_results.end() && it->second.success && it->second.modified_at == modified_at && it->second.written_at == modified_at_on_disk;
+}
 
 ini_file &reshade::global_config()
 {
@@ -25,40 +194,79 @@ ini_file::ini_file(const std::filesystem::path &path) : _path(path)
 
 bool ini_file::load()
 {
+	// Make sure a background write of this file finished, so that it is not read while it is being replaced
+	wait_for_flush(_path);
+
 	std::error_code ec;
 	const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(_path, ec);
 	if (!ec && _modified_at >= modified_at)
 		return true; // Skip loading if there was no modification to the file since it was last loaded
+	if (!ec && !_modified && is_written_by_flush(_path.native(), _modified_at, modified_at))
+	{
+		_modified_at = modified_at;
+		return true; // Skip loading if the last modification to the file was writing this data to it
+	}
 
 	// Clear when file does not exist too
 	_sections.clear();
+	_data.clear();
 
-	FILE *const file = _wfsopen(_path.c_str(), L"r", SH_DENYWR);
+	FILE *const file = _wfsopen(_path.c_str(), L"rb", SH_DENYWR);
 	if (file == nullptr)
 		return false;
 
 	_modified = false;
 	_modified_at = modified_at;
 
-	// Remove BOM (0xefbbbf means 0xfeff)
-	if (fgetc(file) != utf8::bom[0] || fgetc(file) != utf8::bom[1] || fgetc(file) != utf8::bom[2])
-		fseek(file, 0, SEEK_SET);
-
-	std::string line_data, section;
-	std::vector<std::string> section_lines;
-	std::unordered_map<std::string, std::vector<std::string>> section_data;
-	line_data.resize(BUFSIZ);
-	while (fgets(line_data.data(), static_cast<int>(line_data.size() + 1), file))
+	// Read the whole file at once, so that all keys and values can be parsed out of a single buffer without copying every line
+	if (fseek(file, 0, SEEK_END) == 0)
 	{
-		size_t line_length;
-		while ((line_length = std::strlen(line_data.data())) == line_data.size() && line_data.back() != '\n')
+		const long file_size = ftell(file);
+		if (file_size > 0)
 		{
-			line_data.resize(line_data.size() + BUFSIZ);
-			if (!fgets(line_data.data() + line_length, static_cast<int>(line_data.size() - line_length + 1), file))
-				break;
+			_data.resize(static_cast<size_t>(file_size));
+			fseek(file, 0, SEEK_SET);
+			_data.resize(fread(_data.data(), 1, _data.size(), file));
 		}
+	}
+
+	fclose(file);
 
-		const std::string_view line = trim(std::string_view(line_data.data(), line_length), " \t\r\n");
+	size_t offset = 0;
+	// Remove BOM (0xefbbbf means 0xfeff)
+	if (_data.size() >= 3 && _data[0] == static_cast<char>(utf8::bom[0]) && _data[1] == static_cast<char>(utf8::bom[1]) && _data[2] == static_cast<char>(utf8::bom[2]))
+		offset = 3;
+
+	const auto finish_section = [](section_entry &section) {
+		// Sort keys once after a section was read, instead of inserting each key at its sorted position
+		std::stable_sort(section.keys.begin(), section.keys.end(),
+			[](const key_entry &a, const key_entry &b) { return less(a.name, b.name); });
+
+		// Append values of keys that appear multiple times to the first occurrence
+		for (auto it = section.keys.begin(); it != section.keys.end() && std::next(it) != section.keys.end();)
+		{
+			if (const auto next = std::next(it);
+				it->name == next->name)
+			{
+				it->value.insert(it->value.end(), std::make_move_iterator(next->value.begin()), std::make_move_iterator(next->value.end()));
+				it->line_length = 0; // Merged key no longer matches a single line in the file
+				section.keys.erase(next);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	};
+
+	_sections.emplace_back();
+
+	const std::string_view data = _data;
+	while (offset < data.size())
+	{
+		const size_t line_end = std::min(data.find('\n', offset), data.size());
+		const std::string_view line = trim(data.substr(offset, line_end - offset), " \t\r\n");
+		offset = line_end + 1;
 
 		if (line.empty() || line[0] == ';' || line[0] == '/' || line[0] == '#')
 			continue;
@@ -66,21 +274,35 @@ bool ini_file::load()
 		// Read section name
 		if (line[0] == '[')
 		{
-			import_section(section_lines, section_data);
-			_sections.insert({ section, std::move(section_data) });
-			section_data.clear();
-			section_lines.clear();
+			finish_section(_sections.back());
 
-			section = trim(line.substr(0, line.find(']')), " \t[]");
+			_sections.emplace_back().name = trim(line.substr(0, line.find(']')), " \t[]");
 			continue;
 		}
 
-		section_lines.push_back(std::string(line));
+		key_entry &key = _sections.back().keys.emplace_back();
+		key.line_offset = line.data() - data.data();
+		key.line_length = line.size();
+
+		if (const size_t assign_index = line.find('=');
+			assign_index != std::string_view::npos)
+		{
+			key.name = trim(line.substr(0, assign_index));
+			parse_value(trim(line.substr(assign_index + 1)), key.value);
+		}
+		else
+		{
+			key.name = line;
+		}
 	}
-	import_section(section_lines, section_data);
-	_sections.insert({ section, section_data });
 
-	fclose(file);
+	finish_section(_sections.back());
+
+	std::stable_sort(_sections.begin(), _sections.end(),
+		[](const section_entry &a, const section_entry &b) { return less(a.name, b.name); });
+	// Only keep the first occurrence of sections that appear multiple times
+	_sections.erase(std::unique(_sections.begin(), _sections.end(),
+		[](const section_entry &a, const section_entry &b) { return a.name == b.name; }), _sections.end());
 
 	return true;
 }
@@ -88,55 +310,22 @@ bool ini_file::load()
 bool ini_file::import_section(const std::vector<std::string> &lines, std::unordered_map<std::string, std::vector<std::string>> &data)
 {
 	data.clear();
-	for (const auto &line : lines)
+	for (const std::string &line_data : lines)
 	{
-		trim(line);
-		
+		const std::string_view line = trim(line_data);
+
 		if (line.empty() || line[0] == ';' || line[0] == '/' || line[0] == '#') [[unlikely]]
 			continue;
-		const size_t assign_index = line.find('=');
-		if (assign_index != std::string::npos)
-		{
-			const std::string key(trim(line.substr(0, assign_index)));
-			const std::string value(trim(line.substr(assign_index + 1)));
-
-			if (value.empty())
-			{
-				data.insert({ key, {} });
-				continue;
-			}
 
+		if (const size_t assign_index = line.find('=');
+			assign_index != std::string_view::npos)
+		{
 			// Append to key if it already exists
-			ini_file::value_type &elements = data[key];
-			for (size_t offset = 0, base = 0, len = value.size(); offset <= len;)
-			{
-				// Treat ",," as an escaped comma and only split on single ","
-				const size_t found = std::min(value.find(',', offset), len);
-				if (found + 1 < len && value[found + 1] == ',')
-				{
-					offset = found + 2;
-				}
-				else
-				{
-					std::string &element = elements.emplace_back();
-					element.reserve(found - base);
-
-					while (base < found)
-					{
-						const char c = value[base++];
-						element += c;
-
-						if (c == ',' && base < found && value[base] == ',')
-							base++; // Skip second comma in a ",," escape sequence
-					}
-
-					offset = base = found + 1;
-				}
-			}
+			parse_value(trim(line.substr(assign_index + 1)), data[std::string(trim(line.substr(0, assign_index)))]);
 		}
 		else
 		{
-			data.insert({ line, {} });
+			data.insert({ std::string(line), {} });
 		}
 	}
 
@@ -145,182 +334,472 @@ bool ini_file::import_section(const std::vector<std::string> &lines, std::unorde
 
 bool ini_file::save()
 {
-	if (!_modified)
+	const std::filesystem::file_time_type modified_at = _modified_at;
+
+	std::string data;
+	if (!serialize(data))
 		return true;
 
-	// Reset state even on failure to avoid 'flush_cache' repeatedly trying and failing to save
-	_modified = false;
+	std::filesystem::file_time_type written_at;
+	if (!write_file(_path, data, modified_at, written_at))
+		return false;
 
-	std::error_code ec;
-	const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(_path, ec);
-	if (!ec && (modified_at - _modified_at) > std::chrono::seconds(2))
-		return false; // File exists and was modified on disk and therefore may have different data, so cannot save
+	_modified_at = written_at;
 
-	std::string data;
-	std::vector<std::string> section_names, key_names;
+	return true;
+}
 
-	section_names.reserve(_sections.size());
-	for (const std::pair<const std::string, section_type> &section : _sections)
-		section_names.push_back(section.first);
+bool ini_file::serialize(std::string &data)
+{
+	if (!_modified)
+		return false;
 
-	// Sort sections to generate consistent files
-	std::sort(section_names.begin(), section_names.end(),
-		[](std::string a, std::string b) {
-			std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			return a < b;
-		});
+	// Reset state even on failure to avoid 'flush_cache' repeatedly trying and failing to save
+	_modified = false;
+
+	data.clear();
+	data.reserve(_data.size() + 512);
 
-	for (const std::string &section_name : section_names)
+	// Sections and keys are already sorted, so can write them out in order to generate consistent files
+	for (section_entry &section : _sections)
 	{
-		if (const section_type &keys = _sections.at(section_name); !keys.empty())
+		if (section.keys.empty())
+			continue;
+
+		// Empty section is sorted to the top, so do not need to append it before keys
+		if (!section.name.empty())
+			data += '[' + section.name + ']' + '\n';
+
+		for (key_entry &key : section.keys)
 		{
-			// Empty section should have been sorted to the top, so do not need to append it before keys
-			if (!section_name.empty())
-				data += '[' + section_name + ']' + '\n';
+			const size_t line_offset = data.size();
+
+			// Copy lines of keys that were not modified since the file was last loaded or saved as they are, instead of formatting their value again
+			if (key.line_length != 0 && key.line_offset + key.line_length <= _data.size())
+			{
+				data.append(_data, key.line_offset, key.line_length);
+			}
+			else
+			{
+				data += key.name;
+				data += '=';
+				append_value(data, key.value);
+			}
+
+			key.line_offset = line_offset;
+			key.line_length = data.size() - line_offset;
 
-			std::string lines; lines.reserve(512);
-			export_section(keys, lines);
-			data += lines;
+			data += '\n';
 		}
+
+		data += '\n';
 	}
 
-	FILE *const file = _wfsopen(_path.c_str(), L"w", SH_DENYWR);
-	if (file == nullptr)
-		return false;
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	if (file_size_written != data.size())
-		return false;
+	// Line locations now refer to the new data
+	_data = data;
 
-	const std::string str = data.data();
+	return true;
+}
 
-	// Flush stream to disk before updating last write time
-	_modified_at = std::filesystem::last_write_time(_path, ec);
+bool ini_file::export_section(const std::unordered_map<std::string, std::vector<std::string>> &keys, std::string &lines)
+{
+	std::vector<const std::pair<const std::string, value_type> *> sorted_keys;
+	sorted_keys.reserve(keys.size());
+	for (const std::pair<const std::string, value_type> &key : keys)
+		sorted_keys.push_back(&key);
+
+	std::sort(sorted_keys.begin(), sorted_keys.end(),
+		[](const std::pair<const std::string, value_type> *a, const std::pair<const std::string, value_type> *b) { return less(a->first, b->first); });
 
-	assert(!ec && std::filesystem::file_size(_path, ec) > 0);
+	lines.clear();
+	for (const std::pair<const std::string, value_type> *key : sorted_keys)
+	{
+		lines += key->first;
+		lines += '=';
+		append_value(lines, key->second);
+		lines += '\n';
+	}
+
+	lines += '\n';
 
 	return true;
 }
 
-bool ini_file::export_section(const std::unordered_map<std::string, std::vector<std::string>> &keys, std::string &lines)
+void ini_file::set(const std::string &section, std::unordered_map<std::string, std::vector<std::string>> &data)
 {
-	std::string data;
+	section_entry &it = find_or_insert_section(section);
 
-	std::vector<std::string> key_names;
-	key_names.clear();
-	key_names.reserve(keys.size());
-	for (const std::pair<const std::string, value_type> &key : keys)
-		key_names.push_back(key.first);
+	it.keys.clear();
+	it.keys.reserve(data.size());
+	for (const std::pair<const std::string, value_type> &key : data)
+	{
+		key_entry &new_key = it.keys.emplace_back();
+		new_key.name = key.first;
+		new_key.value = key.second;
+	}
+
+	std::sort(it.keys.begin(), it.keys.end(),
+		[](const key_entry &a, const key_entry &b) { return less(a.name, b.name); });
 
-	std::sort(key_names.begin(), key_names.end(),
-		[](std::string a, std::string b) {
-			std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
+	_modified = true;
+	_modified_at = std::filesystem::file_time_type::clock::now();
+}
+void ini_file::set(const std::string &section, const std::string &key, std::vector<std::string> &&values)
+{
+	std::vector<key_entry> &keys = find_or_insert_section(section).keys;
+
+	auto it = std::lower_bound(keys.begin(), keys.end(), key,
+		[](const key_entry &a, const std::string &b) { return less(a.name, b); });
+	if (it != keys.end() && it->name == key)
+	{
+		// Avoid writing the file again if nothing actually changed
+		if (it->value == values)
+			return;
+	}
+	else
+	{
+		it = keys.emplace(it);
+		it->name = key;
+	}
+
+	it->value = std::move(values);
+	it->numbers.reset();
+	it->line_length = 0;
+
+	_modified = true;
+	_modified_at = std::filesystem::file_time_type::clock::now();
+}
+
+void ini_file::remove_key(const std::string &section, const std::string &key)
+{
+	const auto it1 = std::lower_bound(_sections.begin(), _sections.end(), section,
+		[](const section_entry &a, const std::string &b) { return less(a.name, b); });
+	if (it1 == _sections.end() || it1->name != section)
+		return;
+	const auto it2 = std::lower_bound(it1->keys.begin(), it1->keys.end(), key,
+		[](const key_entry &a, const std::string &b) { return less(a.name, b); });
+	if (it2 == it1->keys.end() || it2->name != key)
+		return;
+	it1->keys.erase(it2);
+	_modified = true;
+	_modified_at = std::filesystem::file_time_type::clock::now();
+}
+void ini_file::remove_section(const std::string &section)
+{
+	const auto it = std::lower_bound(_sections.begin(), _sections.end(), section,
+		[](const section_entry &a, const std::string &b) { return less(a.name, b); });
+	if (it == _sections.end() || it->name != section)
+		return;
+	_sections.erase(it);
+	_modified = true;
+	_modified_at = std::filesystem::file_time_type::clock::now();
+}
+
+bool ini_file::less(std::string_view lhs, std::string_view rhs)
+{
+	// Compare upper case characters in place, rather than creating upper case copies of both strings for every comparison
+	const size_t len = std::min(lhs.size(), rhs.size());
+	for (size_t i = 0; i < len; ++i)
+	{
+		const unsigned char a = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(lhs[i])));
+		const unsigned char b = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(rhs[i])));
+		if (a != b)
 			return a < b;
-		});
+	}
 
-	for (const std::string &key_name : key_names)
+	if (lhs.size() != rhs.size())
+		return lhs.size() < rhs.size();
+
+	// Names that only differ in case are different keys, so need a strict order between them too
+	return lhs < rhs;
+}
+
+const ini_file::section_entry *ini_file::find_section(const std::string &section) const
+{
+	const auto it = std::lower_bound(_sections.begin(), _sections.end(), section,
+		[](const section_entry &a, const std::string &b) { return less(a.name, b); });
+	return it != _sections.end() && it->name == section ? &*it : nullptr;
+}
+ini_file::section_entry &ini_file::find_or_insert_section(const std::string &section)
+{
+	auto it = std::lower_bound(_sections.begin(), _sections.end(), section,
+		[](const section_entry &a, const std::string &b) { return less(a.name, b); });
+	if (it == _sections.end() || it->name != section)
 	{
-		data += key_name + '=';
+		it = _sections.emplace(it);
+		it->name = section;
+	}
+	return *it;
+}
+const ini_file::key_entry *ini_file::find(const std::string &section, const std::string &key) const
+{
+	const section_entry *const it1 = find_section(section);
+	if (it1 == nullptr)
+		return nullptr;
+	const auto it2 = std::lower_bound(it1->keys.begin(), it1->keys.end(), key,
+		[](const key_entry &a, const std::string &b) { return less(a.name, b); });
+	return it2 != it1->keys.end() && it2->name == key ? &*it2 : nullptr;
+}
 
-		if (const ini_file::value_type &elements = keys.at(key_name); !elements.empty())
+std::shared_ptr<const std::vector<ini_file::number_type>> ini_file::parse_numbers(const key_entry &key)
+{
+	// Keys may be read from multiple threads at once (e.g. the effect loading threads all reading the same preset), so publish the parsed numbers atomically
+	std::shared_ptr<const std::vector<number_type>> numbers = std::atomic_load(&key.numbers);
+	if (numbers != nullptr)
+		return numbers;
+
+	const std::shared_ptr<std::vector<number_type>> new_numbers = std::make_shared<std::vector<number_type>>(key.value.size());
+	for (size_t i = 0; i < key.value.size(); ++i)
+	{
+		(*new_numbers)[i].as_int = std::strtoll(key.value[i].c_str(), nullptr, 10);
+		(*new_numbers)[i].as_float = std::strtod(key.value[i].c_str(), nullptr);
+	}
+
+	numbers = new_numbers;
+	std::atomic_store(&key.numbers, numbers);
+	return numbers;
+}
+
+void ini_file::parse_value(std::string_view value, value_type &elements)
+{
+	if (value.empty())
+		return;
+
+	for (size_t offset = 0, base = 0, len = value.size(); offset <= len;)
+	{
+		// Treat ",," as an escaped comma and only split on single ","
+		const size_t found = std::min(value.find(',', offset), len);
+		if (found + 1 < len && value[found + 1] == ',')
 		{
-			std::string value;
-			for (const std::string &element : elements)
-			{
-				// Empty elements mess with escaped commas, so simply skip them
-				if (element.empty())
-					continue;
-
-				value.reserve(value.size() + element.size() + 1);
-				for (const char c : element)
-					value.append(c == ',' ? 2 : 1, c);
-				value += ','; // Separate multiple values with a comma
-			}
+			offset = found + 2;
+		}
+		else
+		{
+			std::string &element = elements.emplace_back();
+			element.reserve(found - base);
 
-			// Remove the last comma
-			if (!value.empty())
+			while (base < found)
 			{
-				assert(value.back() == ',');
-				value.pop_back();
+				const char c = value[base++];
+				element += c;
+
+				if (c == ',' && base < found && value[base] == ',')
+					base++; // Skip second comma in a ",," escape sequence
 			}
 
-			data += value;
+			offset = base = found + 1;
 		}
-
-		data += '\n';
 	}
+}
+void ini_file::append_value(std::string &data, const value_type &elements)
+{
+	const size_t value_offset = data.size();
 
-	data += '\n';
-	lines = data.data();
+	for (const std::string &element : elements)
+	{
+		// Empty elements mess with escaped commas, so simply skip them
+		if (element.empty())
+			continue;
 
-	return true;
+		data.reserve(data.size() + element.size() + 1);
+		for (const char c : element)
+			data.append(c == ',' ? 2 : 1, c);
+		data += ','; // Separate multiple values with a comma
+	}
+
+	// Remove the last comma
+	if (data.size() != value_offset)
+	{
+		assert(data.back() == ',');
+		data.pop_back();
+	}
 }
 
 bool ini_file::flush_cache()
 {
 	bool success = true;
 
-	const std::shared_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	// Collect results of background writes that finished since the last call (without removing them, since 'wait_for_flush' may still ask for them)
+	std::unordered_map<std::wstring, finished_write> results;
+	{	const std::unique_lock<std::mutex> flush_lock(s_flush_mutex);
+
+		for (std::pair<const std::wstring, finished_write> &result : s_flush_results)
+		{
+			if (result.second.collected)
+				continue;
+
+			result.second.collected = true;
+			results.insert(result);
+		}
+	}
 
-	// Save all files that were modified in one second intervals
-	for (auto &file : s_ini_cache)
-		// Check modified status before requesting file time, since the latter is costly and therefore should be avoided when not necessary
-		if (file.second->_modified && (std::filesystem::file_time_type::clock::now() - file.second->_modified_at) > std::chrono::seconds(1))
-			success &= file.second->save();
+	for (const std::pair<const std::wstring, finished_write> &result : results)
+		success &= result.second.success;
+
+	for (ini_cache_shard &shard : s_ini_cache)
+	{
+		// Updating the modification state and serializing changes it, which 'load_cache' reads under a shared lock, so need exclusive access here
+		const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+		for (auto &file : shard.files)
+		{
+			// Update modification time to that of the written file, so that it is not loaded again needlessly, unless there were more changes in the meantime
+			if (const auto it = results.find(file.first);
+				it != results.end() && it->second.success && !file.second->_modified)
+				file.second->_modified_at = it->second.written_at;
+
+			// Save all files that were not modified for a while
+			// Check modified status before requesting current time, so that the latter can be skipped for the common case of no modifications
+			if (!file.second->_modified || (std::filesystem::file_time_type::clock::now() - file.second->_modified_at) <= s_flush_delay)
+				continue;
+
+			pending_write write;
+			write.path = file.second->_path;
+			write.modified_at = file.second->_modified_at;
+			if (file.second->serialize(write.data))
+				queue_write(std::move(write));
+		}
+	}
 
 	return success;
 }
-bool ini_file::flush_cache(const std::filesystem::path &path)
+bool ini_file::flush_cache(const std::filesystem::path &path, bool wait)
 {
 	assert(!path.empty() && path.is_absolute());
 
-	const std::shared_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	{	ini_cache_shard &shard = get_cache_shard(path);
+		const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+		const auto it = shard.files.find(path.native());
+		if (it == shard.files.end())
+			return false;
+
+		pending_write write;
+		write.path = path;
+		write.modified_at = it->second->_modified_at;
+		if (it->second->serialize(write.data))
+			queue_write(std::move(write));
+	}
+
+	return !wait || wait_for_flush(path);
+}
+
+bool ini_file::wait_for_flush()
+{
+	std::unique_lock<std::mutex> lock(s_flush_mutex);
+
+	s_flush_condition.wait(lock, []() { return !s_flush_thread_running; });
 
-	const auto it = s_ini_cache.find(path);
-	return it != s_ini_cache.end() && it->second->save();
+	return std::all_of(s_flush_results.begin(), s_flush_results.end(),
+		[](const std::pair<const std::wstring, finished_write> &result) { return result.second.success; });
+}
+bool ini_file::wait_for_flush(const std::filesystem::path &path)
+{
+	std::unique_lock<std::mutex> lock(s_flush_mutex);
+
+	s_flush_condition.wait(lock, [&path]() { return !is_write_pending(path.native()); });
+
+	const auto it = s_flush_results.find(path.native());
+	return it == s_flush_results.end() || it->second.success;
+}
+
+std::chrono::microseconds ini_file::last_flush_latency()
+{
+	return std::chrono::microseconds(s_flush_latency.load());
 }
 
 void ini_file::clear_cache()
 {
-	const std::unique_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	for (ini_cache_shard &shard : s_ini_cache)
+	{
+		const std::unique_lock<std::shared_mutex> lock(shard.mutex);
 
-	s_ini_cache.clear();
+		shard.files.clear();
+	}
+
+	// Files may be accessed directly after removing them from cache, so make sure they are no longer being written to
+	wait_for_flush();
 }
 void ini_file::clear_cache(const std::filesystem::path &path)
 {
 	assert(!path.empty() && path.is_absolute());
 
-	const std::unique_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	ini_cache_shard &shard = get_cache_shard(path);
+	const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+	shard.files.erase(path.native());
+
+	wait_for_flush(path);
+}
 
-	s_ini_cache.erase(path);
+ini_file::cache_statistics ini_file::get_cache_statistics()
+{
+	cache_statistics stats;
+	stats.hits = s_ini_cache_hits.load();
+	stats.misses = s_ini_cache_misses.load();
+	stats.reloads = s_ini_cache_reloads.load();
+	return stats;
 }
 
 ini_file *ini_file::find_cache(const std::filesystem::path &path)
 {
 	assert(!path.empty() && path.is_absolute());
 
-	const std::shared_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	ini_cache_shard &shard = get_cache_shard(path);
+	const std::shared_lock<std::shared_mutex> lock(shard.mutex);
 
-	const auto it = s_ini_cache.find(path);
-	return it != s_ini_cache.end() ? it->second.get() : nullptr;
+	const auto it = shard.files.find(path.native());
+	return it != shard.files.end() ? it->second.get() : nullptr;
 }
 ini_file &ini_file::load_cache(const std::filesystem::path &path)
 {
 	assert(!path.empty() && path.is_absolute());
 
-	const std::unique_lock<std::shared_mutex> lock(s_ini_cache_mutex);
+	ini_cache_shard &shard = get_cache_shard(path);
+
+	// Most lookups are for files that are already cached and did not change on disk, which only requires shared access, so that multiple threads looking up the same file (e.g. the effect loading threads all resolving the current preset) do not wait on each other
+	{	const std::shared_lock<std::shared_mutex> lock(shard.mutex);
 
-	const auto insert = s_ini_cache.try_emplace(path);
+		if (const auto it = shard.files.find(path.native());
+			it != shard.files.end() && it->second->is_up_to_date())
+		{
+			s_ini_cache_hits++;
+			return *it->second;
+		}
+	}
+
+	const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+	const auto insert = shard.files.try_emplace(path.native());
 	const auto it = insert.first;
 
 	// Only construct when actually adding a new entry to the cache, since the 'ini_file' constructor performs a costly load of the file
 	if (insert.second)
+	{
+		s_ini_cache_misses++;
 		it->second = std::make_unique<ini_file>(path);
+	}
 	// Don't reload file when it was just loaded or there are still modifications pending
 	else if (!it->second->_modified)
+	{
+		s_ini_cache_reloads++;
 		it->second->load();
+	}
 
 	return *it->second;
 }
+
+bool ini_file::is_up_to_date() const
+{
+	// Modifications that were not saved yet take precedence over any changes on disk
+	if (_modified)
+		return true;
+
+	std::error_code ec;
+	const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(_path, ec);
+	if (ec)
+		return false;
+
+	// A background write of this file may have finished without 'flush_cache' having collected its result and updated the modification time yet
+	return _modified_at >= modified_at || is_written_by_flush(_path.native(), _modified_at, modified_at);
+}
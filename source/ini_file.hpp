@@ -5,8 +5,13 @@
 
 #pragma once
 
+#include <limits>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <filesystem>
 #include <unordered_map>
 
@@ -49,46 +54,42 @@ public:
 	/// </summary>
 	bool has(const std::string &section, const std::string &key) const
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
-			return false;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
-			return false;
-		return true;
+		return find(section, key) != nullptr;
 	}
 
 	bool has(const std::string &section) const
 	{
-		const auto it1 = _sections.find(section);
-		return it1 != _sections.end();
+		return find_section(section) != nullptr;
 	}
 	bool get_section_names(std::vector<std::string> &data)
 	{
 		data.clear();
-		for (auto &sect : _sections)
-			data.push_back(sect.first);
+		data.reserve(_sections.size());
+		for (const section_entry &section : _sections)
+			data.push_back(section.name);
 		return true;
 	}
 	bool get_section_keynames(const std::string &section, std::vector<std::string> &data)
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
+		const section_entry *const it = find_section(section);
+		if (it == nullptr)
 			return false;
 		data.clear();
-		data.resize(it1->second.size());
-		for (auto &kv : it1->second)
-			data.push_back(kv.first);
+		data.reserve(it->keys.size());
+		for (const key_entry &key : it->keys)
+			data.push_back(key.name);
 		return true;
 	}
 
 	bool get(const std::string &section, std::unordered_map<std::string, std::vector<std::string>> &data)
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
+		const section_entry *const it = find_section(section);
+		if (it == nullptr)
 			return false;
 		data.clear();
-		data = it1->second;
+		data.reserve(it->keys.size());
+		for (const key_entry &key : it->keys)
+			data.emplace(key.name, key.value);
 		return true;
 	}
 	/// <summary>
@@ -99,55 +100,68 @@ public:
 	template <typename T>
 	bool get(const std::string &section, const std::string &key, T &value) const
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
-			return false;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
-			return false;
-		value = convert<T>(it2->second, 0);
-		return true;
+		return get(section, key, &value, 1);
 	}
 	template <typename T, size_t SIZE>
 	bool get(const std::string &section, const std::string &key, T(&values)[SIZE]) const
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
-			return false;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
-			return false;
-		for (size_t i = 0; i < SIZE; ++i)
-			values[i] = convert<T>(it2->second, i);
-		return true;
+		return get(section, key, values, SIZE);
 	}
 	template <typename T>
 	bool get(const std::string &section, const std::string &key, std::vector<T> &values) const
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
+		const key_entry *const it = find(section, key);
+		if (it == nullptr)
 			return false;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
+		values.resize(it->value.size());
+		if constexpr (std::is_arithmetic_v<T>)
+		{
+			const std::shared_ptr<const std::vector<number_type>> numbers = parse_numbers(*it);
+			for (size_t i = 0; i < it->value.size(); ++i)
+				values[i] = convert<T>(*numbers, it->value, i);
+		}
+		else
+		{
+			for (size_t i = 0; i < it->value.size(); ++i)
+				values[i] = convert<T>(it->value, i);
+		}
+		return true;
+	}
+	/// <summary>
+	/// Gets the first <paramref name="count"/> elements of the value of the specified <paramref name="section"/> and <paramref name="key"/> from the INI.
+	/// Numbers are only parsed from the value strings once and then reused, until the value is changed again.
+	/// </summary>
+	/// <param name="values">Pointer to an array of at least <paramref name="count"/> elements that is filled with the data of this INI entry.</param>
+	/// <returns><see langword="true"/> if the key exists, <see langword="false"/> otherwise.</returns>
+	template <typename T>
+	bool get(const std::string &section, const std::string &key, T *values, size_t count) const
+	{
+		const key_entry *const it = find(section, key);
+		if (it == nullptr)
 			return false;
-		values.resize(it2->second.size());
-		for (size_t i = 0; i < it2->second.size(); ++i)
-			values[i] = convert<T>(it2->second, i);
+		if constexpr (std::is_arithmetic_v<T>)
+		{
+			const std::shared_ptr<const std::vector<number_type>> numbers = parse_numbers(*it);
+			for (size_t i = 0; i < count; ++i)
+				values[i] = convert<T>(*numbers, it->value, i);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+				values[i] = convert<T>(it->value, i);
+		}
 		return true;
 	}
 	template <>
 	bool get(const std::string &section, const std::string &key, std::vector<std::pair<std::string, std::string>> &values) const
 	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
-			return false;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
+		const key_entry *const it = find(section, key);
+		if (it == nullptr)
 			return false;
-		values.resize(it2->second.size());
-		for (size_t i = 0; i < it2->second.size(); ++i)
+		values.resize(it->value.size());
+		for (size_t i = 0; i < it->value.size(); ++i)
 		{
-			std::string value = convert<std::string>(it2->second, i);
+			std::string value = convert<std::string>(it->value, i);
 			if (const size_t equals_sign = value.find('=');
 				equals_sign != std::string::npos)
 				values[i] = { value.substr(0, equals_sign), value.substr(equals_sign + 1) };
@@ -167,14 +181,7 @@ public:
 		return get<bool>(section, key, value) && value;
 	}
 
-	void set(const std::string &section, std::unordered_map<std::string, std::vector<std::string>> &data)
-	{
-		const auto it = _sections.find(section);
-		if (it == _sections.end())
-			_sections.insert(std::pair(section, data));
-		else
-			it->second = data;
-	}
+	void set(const std::string &section, std::unordered_map<std::string, std::vector<std::string>> &data);
 	/// <summary>
 	/// Sets the value of the specified <paramref name="section"/> and <paramref name="key"/> to a new <paramref name="value"/>.
 	/// </summary>
@@ -192,18 +199,13 @@ public:
 	template <>
 	void set(const std::string &section, const std::string &key, const std::string &value)
 	{
-		auto &v = _sections[section][key];
-		v.assign(1, value);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, value_type(1, value));
 	}
 	void set(const std::string &section, const std::string &key, std::string &&value)
 	{
-		auto &v = _sections[section][key];
-		v.resize(1);
-		v[0] = std::forward<std::string>(value);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		value_type v;
+		v.push_back(std::forward<std::string>(value));
+		set(section, key, std::move(v));
 	}
 	template <>
 	void set(const std::string &section, const std::string &key, const std::filesystem::path &value)
@@ -213,43 +215,29 @@ public:
 	template <typename T, size_t SIZE>
 	void set(const std::string &section, const std::string &key, const T(&values)[SIZE], const size_t size = SIZE)
 	{
-		auto &v = _sections[section][key];
-		v.resize(size);
+		value_type v(size);
 		for (size_t i = 0; i < size; ++i)
 			v[i] = std::to_string(values[i]);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, std::move(v));
 	}
 	template <typename T>
 	void set(const std::string &section, const std::string &key, const std::vector<T> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type v(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
 			v[i] = std::to_string(values[i]);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, std::move(v));
 	}
 	template <>
 	void set(const std::string &section, const std::string &key, const std::vector<std::string> &values)
 	{
-		auto &v = _sections[section][key];
-		v = values;
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
-	}
-	void set(const std::string &section, const std::string &key, std::vector<std::string> &&values)
-	{
-		auto &v = _sections[section][key];
-		v = std::forward<std::vector<std::string>>(values);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, value_type(values));
 	}
+	void set(const std::string &section, const std::string &key, std::vector<std::string> &&values);
 	template <>
 	void set(const std::string &section, const std::string &key, const std::vector<std::pair<std::string, std::string>> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type v(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
 		{
 			const std::pair<std::string, std::string> &value = values[i];
@@ -257,18 +245,15 @@ public:
 			if (!value.second.empty())
 				v[i] += '=' + value.second;
 		}
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, std::move(v));
 	}
 	template <>
 	void set(const std::string &section, const std::string &key, const std::vector<std::filesystem::path> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type v(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
 			v[i] = values[i].u8string();
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, std::move(v));
 	}
 
 	/// <summary>
@@ -284,30 +269,11 @@ public:
 	/// <summary>
 	/// Removes the specified <paramref name="key"/> from the <paramref name="section"/>.
 	/// </summary>
-	void remove_key(const std::string &section, const std::string &key)
-	{
-		const auto it1 = _sections.find(section);
-		if (it1 == _sections.end())
-			return;
-		const auto it2 = it1->second.find(key);
-		if (it2 == it1->second.end())
-			return;
-		it1->second.erase(it2);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
-	}
+	void remove_key(const std::string &section, const std::string &key);
 	/// <summary>
 	/// Removes a whole <paramref name="section"/>.
 	/// </summary>
-	void remove_section(const std::string &section)
-	{
-		const auto it = _sections.find(section);
-		if (it == _sections.end())
-			return;
-		_sections.erase(it);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
-	}
+	void remove_section(const std::string &section);
 
 	/// <summary>
 	/// Loads all values from disk.
@@ -320,9 +286,31 @@ public:
 
 	/// <summary>
 	/// Saves all changes to INI files that were loaded through <see cref="load_cache"/> to disk.
+	/// Files are only saved after they were not modified for a while, so that changes made in quick succession are written together, and are written on a background thread.
 	/// </summary>
+	/// <returns><see langword="false"/> if writing any of the files that finished saving since the last call failed, <see langword="true"/> otherwise.</returns>
 	static bool flush_cache();
-	static bool flush_cache(const std::filesystem::path &path);
+	/// <summary>
+	/// Saves all changes to the INI file at the specified <paramref name="path"/> that was loaded through <see cref="load_cache"/> to disk right away.
+	/// </summary>
+	/// <param name="path">Absolute path to the INI file to save.</param>
+	/// <param name="wait">Set to <see langword="true"/> to wait for the file to be written, or <see langword="false"/> to only queue it for writing on the background thread (see <see cref="wait_for_flush"/>).</param>
+	static bool flush_cache(const std::filesystem::path &path, bool wait = true);
+
+	/// <summary>
+	/// Waits for all pending background writes of INI files to finish.
+	/// </summary>
+	static bool wait_for_flush();
+	/// <summary>
+	/// Waits for a pending background write of the INI file at the specified <paramref name="path"/> to finish.
+	/// </summary>
+	/// <returns><see langword="true"/> if the last background write of the file succeeded or it was never written in the background, <see langword="false"/> otherwise.</returns>
+	static bool wait_for_flush(const std::filesystem::path &path);
+
+	/// <summary>
+	/// Gets the time the last background write of an INI file took.
+	/// </summary>
+	static std::chrono::microseconds last_flush_latency();
 
 	/// <summary>
 	/// Removes all INI files from cache, without saving changes.
@@ -344,55 +332,31 @@ public:
 	/// <returns>Reference to the cached data.</returns>
 	static ini_file &load_cache(const std::filesystem::path &path);
 
+	struct cache_statistics
+	{
+		/// <summary>
+		/// Number of <see cref="load_cache"/> calls that returned a cached file without having to load it.
+		/// </summary>
+		uint64_t hits;
+		/// <summary>
+		/// Number of <see cref="load_cache"/> calls for files that were not cached yet.
+		/// </summary>
+		uint64_t misses;
+		/// <summary>
+		/// Number of <see cref="load_cache"/> calls that had to load a cached file again because it changed on disk.
+		/// </summary>
+		uint64_t reloads;
+	};
+
+	/// <summary>
+	/// Gets the number of hits, misses and reloads of <see cref="load_cache"/> since startup.
+	/// </summary>
+	static cache_statistics get_cache_statistics();
+
 private:
 	template <typename T>
 	static const T convert(const std::vector<std::string> &values, size_t i) = delete;
 	template <>
-	static const bool convert(const std::vector<std::string> &values, size_t i)
-	{
-		return convert<int>(values, i) != 0 || i < values.size() && (values[i] == "true" || values[i] == "True" || values[i] == "TRUE");
-	}
-	template <>
-	static const int convert(const std::vector<std::string> &values, size_t i)
-	{
-		return static_cast<int>(convert<long>(values, i));
-	}
-	template <>
-	static const unsigned int convert(const std::vector<std::string> &values, size_t i)
-	{
-		return static_cast<unsigned int>(convert<unsigned long>(values, i));
-	}
-	template <>
-	static const long convert(const std::vector<std::string> &values, size_t i)
-	{
-		return i < values.size() ? std::strtol(values[i].c_str(), nullptr, 10) : 0l;
-	}
-	template <>
-	static const unsigned long convert(const std::vector<std::string> &values, size_t i)
-	{
-		return i < values.size() ? std::strtoul(values[i].c_str(), nullptr, 10) : 0ul;
-	}
-	template <>
-	static const long long convert(const std::vector<std::string> &values, size_t i)
-	{
-		return i < values.size() ? std::strtoll(values[i].c_str(), nullptr, 10) : 0ll;
-	}
-	template <>
-	static const unsigned long long convert(const std::vector<std::string> &values, size_t i)
-	{
-		return i < values.size() ? std::strtoull(values[i].c_str(), nullptr, 10) : 0ull;
-	}
-	template <>
-	static const float convert(const std::vector<std::string> &values, size_t i)
-	{
-		return static_cast<float>(convert<double>(values, i));
-	}
-	template <>
-	static const double convert(const std::vector<std::string> &values, size_t i)
-	{
-		return i < values.size() ? std::strtod(values[i].c_str(), nullptr) : 0.0;
-	}
-	template <>
 	static const std::string convert(const std::vector<std::string> &values, size_t i)
 	{
 		return i < values.size() ? values[i] : std::string();
@@ -407,13 +371,82 @@ private:
 	/// Describes a single value in an INI file.
 	/// </summary>
 	using value_type = std::vector<std::string>;
+
+	/// <summary>
+	/// Numeric representation of an element of a value in an INI file.
+	/// </summary>
+	struct number_type
+	{
+		long long as_int;
+		double as_float;
+	};
+
+	template <typename T>
+	static const T convert(const std::vector<number_type> &numbers, const std::vector<std::string> &values, size_t i)
+	{
+		if (i >= numbers.size())
+			return T();
+
+		// Match the results of parsing the string with 'strtol', 'strtoul', 'strtod', ... of the respective type
+		const number_type &number = numbers[i];
+		if constexpr (std::is_same_v<T, bool>)
+			return number.as_int != 0 || values[i] == "true" || values[i] == "True" || values[i] == "TRUE";
+		else if constexpr (std::is_floating_point_v<T>)
+			return static_cast<T>(number.as_float);
+		else if constexpr (sizeof(T) > sizeof(long))
+			return std::is_signed_v<T> ? static_cast<T>(number.as_int) : static_cast<T>(std::strtoull(values[i].c_str(), nullptr, 10));
+		else if constexpr (std::is_signed_v<T>)
+			return static_cast<T>(std::clamp<long long>(number.as_int, std::numeric_limits<long>::min(), std::numeric_limits<long>::max()));
+		else
+			return static_cast<T>(number.as_int > std::numeric_limits<unsigned long>::max() || number.as_int < -static_cast<long long>(std::numeric_limits<unsigned long>::max()) ? std::numeric_limits<unsigned long>::max() : static_cast<unsigned long>(number.as_int));
+	}
+
+	struct key_entry
+	{
+		std::string name;
+		value_type value;
+		// Numbers parsed from the value on first access as a numeric type, so that repeated lookups do not have to parse the strings again (reset whenever the value changes)
+		mutable std::shared_ptr<const std::vector<number_type>> numbers;
+		// Location of the line in '_data' this key was last loaded from or saved to, so that it can be written again without formatting it, or zero length if it was modified since
+		size_t line_offset = 0;
+		size_t line_length = 0;
+	};
+	/// <summary>
+	/// Describes a section of multiple key/value pairs in an INI file, sorted in the order they are written to the file.
+	/// </summary>
+	struct section_entry
+	{
+		std::string name;
+		std::vector<key_entry> keys;
+	};
+
 	/// <summary>
-	/// Describes a section of multiple key/value pairs in an INI file.
+	/// Order in which sections and keys are kept and written to the file (case-insensitive, with a case-sensitive comparison to break ties).
 	/// </summary>
-	using section_type = std::unordered_map<std::string, value_type>;
+	static bool less(std::string_view lhs, std::string_view rhs);
+
+	const section_entry *find_section(const std::string &section) const;
+	section_entry &find_or_insert_section(const std::string &section);
+	const key_entry *find(const std::string &section, const std::string &key) const;
+
+	/// <summary>
+	/// Formats all keys into the data to write to disk and resets the modification state, or returns <see langword="false"/> if there are no changes to write.
+	/// </summary>
+	bool serialize(std::string &data);
+	/// <summary>
+	/// Checks whether the file on disk did not change since it was last loaded or saved, or there are modifications to it that were not saved yet.
+	/// </summary>
+	bool is_up_to_date() const;
+
+	static std::shared_ptr<const std::vector<number_type>> parse_numbers(const key_entry &key);
+
+	static void parse_value(std::string_view value, value_type &elements);
+	static void append_value(std::string &data, const value_type &elements);
 
 	const std::filesystem::path _path;
-	std::unordered_map<std::string, section_type> _sections;
+	std::vector<section_entry> _sections;
+	// Contents of the file as it was last loaded or saved
+	std::string _data;
 	bool _modified = false;
 	std::filesystem::file_time_type _modified_at;
 };
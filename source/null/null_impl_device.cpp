@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_device.hpp"
+#include <cstring> // std::memcpy, std::strncpy
+#include <algorithm> // std::min
+
+namespace
+{
+	struct pipeline_object
+	{
+		reshade::api::pipeline_layout layout;
+		uint32_t subobject_count;
+	};
+
+	struct pipeline_layout_object
+	{
+		uint32_t param_count;
+	};
+
+	struct descriptor_table_object
+	{
+		reshade::api::pipeline_layout layout;
+		uint32_t layout_param;
+	};
+
+	template <typename T>
+	inline T *from_handle(uint64_t handle) { return reinterpret_cast<T *>(static_cast<uintptr_t>(handle)); }
+	template <typename T>
+	inline uint64_t to_handle(T *object) { return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(object)); }
+
+	uint32_t calc_subresource_size(const reshade::api::resource_desc &desc, uint32_t subresource, uint32_t *out_row_pitch = nullptr, uint32_t *out_slice_pitch = nullptr)
+	{
+		const uint32_t level = subresource % std::max<uint32_t>(desc.texture.levels, 1);
+		const uint32_t width = std::max(1u, desc.texture.width >> level);
+		const uint32_t height = std::max(1u, desc.texture.height >> level);
+		const uint32_t depth = desc.type == reshade::api::resource_type::texture_3d ? std::max(1u, static_cast<uint32_t>(desc.texture.depth_or_layers) >> level) : 1u;
+
+		const uint32_t row_pitch = reshade::api::format_row_pitch(desc.texture.format, width);
+		const uint32_t slice_pitch = reshade::api::format_slice_pitch(desc.texture.format, row_pitch, height);
+
+		if (out_row_pitch != nullptr)
+			*out_row_pitch = row_pitch;
+		if (out_slice_pitch != nullptr)
+			*out_slice_pitch = slice_pitch;
+
+		return slice_pitch * depth;
+	}
+}
+
+reshade::null::device_impl::device_impl() :
+	api_object_impl(nullptr)
+{
+}
+reshade::null::device_impl::~device_impl()
+{
+	// Everything created on this device should have been destroyed by now
+	assert(_live_objects == 0);
+}
+
+bool reshade::null::device_impl::get_property(api::device_properties property, void *data) const
+{
+	switch (property)
+	{
+	case api::device_properties::api_version:
+		*static_cast<uint32_t *>(data) = 0xb000; // D3D_FEATURE_LEVEL_11_0
+		return true;
+	case api::device_properties::vendor_id:
+	case api::device_properties::device_id:
+		*static_cast<uint32_t *>(data) = 0;
+		return true;
+	case api::device_properties::description:
+		std::strncpy(static_cast<char *>(data), "ReShade Null Device", 256);
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool reshade::null::device_impl::check_capability(api::device_caps capability) const
+{
+	// Report the same capabilities a D3D11 device at feature level 11.0 would have
+	switch (capability)
+	{
+	case api::device_caps::compute_shader:
+	case api::device_caps::geometry_shader:
+	case api::device_caps::hull_and_domain_shader:
+	case api::device_caps::dual_source_blend:
+	case api::device_caps::independent_blend:
+	case api::device_caps::fill_mode_non_solid:
+	case api::device_caps::bind_render_targets_and_depth_stencil:
+	case api::device_caps::multi_viewport:
+	case api::device_caps::partial_push_descriptor_updates:
+	case api::device_caps::draw_instanced:
+	case api::device_caps::draw_or_dispatch_indirect:
+	case api::device_caps::copy_buffer_region:
+	case api::device_caps::sampler_compare:
+	case api::device_caps::sampler_anisotropic:
+		return true;
+	default:
+		return false;
+	}
+}
+bool reshade::null::device_impl::check_format_support(api::format format, api::resource_usage) const
+{
+	return format != api::format::unknown;
+}
+
+bool reshade::null::device_impl::create_sampler(const api::sampler_desc &desc, api::sampler *out_sampler)
+{
+	*out_sampler = { to_handle(new api::sampler_desc(desc)) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_sampler(api::sampler sampler)
+{
+	if (sampler == 0)
+		return;
+
+	delete from_handle<api::sampler_desc>(sampler.handle);
+	_live_objects--;
+}
+
+bool reshade::null::device_impl::create_resource(const api::resource_desc &desc, const api::subresource_data *initial_data, api::resource_usage, api::resource *out_resource, void **shared_handle)
+{
+	if (shared_handle != nullptr)
+	{
+		*out_resource = { 0 };
+		return false;
+	}
+
+	const auto object = new resource_object();
+	object->desc = desc;
+
+	// Only buffers are backed by memory right away, since their contents are commonly written through mapping (e.g. constant buffers)
+	if (desc.type == api::resource_type::buffer)
+	{
+		object->data.resize(static_cast<size_t>(desc.buffer.size));
+
+		if (initial_data != nullptr)
+			std::memcpy(object->data.data(), initial_data->data, object->data.size());
+	}
+
+	*out_resource = { to_handle(object) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_resource(api::resource resource)
+{
+	if (resource == 0)
+		return;
+
+	delete from_handle<resource_object>(resource.handle);
+	_live_objects--;
+}
+
+reshade::api::resource_desc reshade::null::device_impl::get_resource_desc(api::resource resource) const
+{
+	assert(resource != 0);
+
+	return from_handle<resource_object>(resource.handle)->desc;
+}
+
+bool reshade::null::device_impl::create_resource_view(api::resource resource, api::resource_usage, const api::resource_view_desc &desc, api::resource_view *out_view)
+{
+	if (resource == 0)
+	{
+		*out_view = { 0 };
+		return false;
+	}
+
+	*out_view = { to_handle(new resource_view_object { resource, desc }) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_resource_view(api::resource_view view)
+{
+	if (view == 0)
+		return;
+
+	delete from_handle<resource_view_object>(view.handle);
+	_live_objects--;
+}
+
+reshade::api::resource reshade::null::device_impl::get_resource_from_view(api::resource_view view) const
+{
+	assert(view != 0);
+
+	return from_handle<resource_view_object>(view.handle)->resource;
+}
+reshade::api::resource_view_desc reshade::null::device_impl::get_resource_view_desc(api::resource_view view) const
+{
+	assert(view != 0);
+
+	return from_handle<resource_view_object>(view.handle)->desc;
+}
+
+bool reshade::null::device_impl::map_buffer_region(api::resource resource, uint64_t offset, uint64_t size, api::map_access, void **out_data)
+{
+	assert(resource != 0);
+
+	resource_object *const object = from_handle<resource_object>(resource.handle);
+	assert(object->desc.type == api::resource_type::buffer);
+
+	if (offset > object->data.size() || (size != UINT64_MAX && offset + size > object->data.size()))
+	{
+		*out_data = nullptr;
+		return false;
+	}
+
+	*out_data = object->data.data() + offset;
+	return true;
+}
+void reshade::null::device_impl::unmap_buffer_region(api::resource)
+{
+}
+bool reshade::null::device_impl::map_texture_region(api::resource resource, uint32_t subresource, const api::subresource_box *box, api::map_access, api::subresource_data *out_data)
+{
+	assert(resource != 0);
+
+	resource_object *const object = from_handle<resource_object>(resource.handle);
+	assert(object->desc.type != api::resource_type::buffer);
+
+	if (box != nullptr)
+	{
+		*out_data = {};
+		return false;
+	}
+
+	// Textures only get memory once they are mapped the first time
+	std::vector<uint8_t> &data = object->mapped_subresources[subresource];
+	data.resize(calc_subresource_size(object->desc, subresource, &out_data->row_pitch, &out_data->slice_pitch));
+
+	out_data->data = data.data();
+	return true;
+}
+void reshade::null::device_impl::unmap_texture_region(api::resource, uint32_t)
+{
+}
+
+void reshade::null::device_impl::update_buffer_region(const void *data, api::resource resource, uint64_t offset, uint64_t size)
+{
+	assert(resource != 0);
+
+	resource_object *const object = from_handle<resource_object>(resource.handle);
+	assert(object->desc.type == api::resource_type::buffer && offset + size <= object->data.size());
+
+	std::memcpy(object->data.data() + offset, data, static_cast<size_t>(size));
+}
+void reshade::null::device_impl::update_texture_region(const api::subresource_data &, api::resource resource, uint32_t, const api::subresource_box *)
+{
+	assert(resource != 0);
+}
+
+bool reshade::null::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *, api::pipeline *out_pipeline)
+{
+	*out_pipeline = { to_handle(new pipeline_object { layout, subobject_count }) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_pipeline(api::pipeline pipeline)
+{
+	if (pipeline == 0)
+		return;
+
+	delete from_handle<pipeline_object>(pipeline.handle);
+	_live_objects--;
+}
+
+bool reshade::null::device_impl::create_pipeline_layout(uint32_t param_count, const api::pipeline_layout_param *, api::pipeline_layout *out_layout)
+{
+	*out_layout = { to_handle(new pipeline_layout_object { param_count }) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_pipeline_layout(api::pipeline_layout layout)
+{
+	if (layout == 0)
+		return;
+
+	delete from_handle<pipeline_layout_object>(layout.handle);
+	_live_objects--;
+}
+
+bool reshade::null::device_impl::allocate_descriptor_tables(uint32_t count, api::pipeline_layout layout, uint32_t layout_param, api::descriptor_table *out_tables)
+{
+	for (uint32_t i = 0; i < count; ++i)
+		out_tables[i] = { to_handle(new descriptor_table_object { layout, layout_param }) };
+	_live_objects += count;
+	return true;
+}
+void reshade::null::device_impl::free_descriptor_tables(uint32_t count, const api::descriptor_table *tables)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (tables[i] == 0)
+			continue;
+
+		delete from_handle<descriptor_table_object>(tables[i].handle);
+		_live_objects--;
+	}
+}
+
+void reshade::null::device_impl::get_descriptor_heap_offset(api::descriptor_table, uint32_t binding, uint32_t array_offset, api::descriptor_heap *out_heap, uint32_t *out_offset) const
+{
+	*out_heap = { 0 };
+	*out_offset = binding + array_offset;
+}
+
+void reshade::null::device_impl::copy_descriptor_tables(uint32_t, const api::descriptor_table_copy *)
+{
+}
+void reshade::null::device_impl::update_descriptor_tables(uint32_t, const api::descriptor_table_update *)
+{
+}
+
+bool reshade::null::device_impl::create_query_heap(api::query_type type, uint32_t count, api::query_heap *out_heap)
+{
+	const auto object = new query_heap_object();
+	object->type = type;
+	object->results.resize(count);
+
+	*out_heap = { to_handle(object) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_query_heap(api::query_heap heap)
+{
+	if (heap == 0)
+		return;
+
+	delete from_handle<query_heap_object>(heap.handle);
+	_live_objects--;
+}
+
+bool reshade::null::device_impl::get_query_heap_results(api::query_heap heap, uint32_t first, uint32_t count, void *results, uint32_t stride)
+{
+	assert(heap != 0);
+
+	const query_heap_object *const object = from_handle<query_heap_object>(heap.handle);
+	if (first + count > object->results.size())
+		return false;
+
+	for (uint32_t i = 0; i < count; ++i)
+		std::memcpy(static_cast<uint8_t *>(results) + i * stride, &object->results[first + i], std::min<size_t>(stride, sizeof(uint64_t)));
+	return true;
+}
+
+void reshade::null::device_impl::set_resource_name(api::resource resource, const char *name)
+{
+	assert(resource != 0);
+
+	from_handle<resource_object>(resource.handle)->name = name;
+}
+void reshade::null::device_impl::set_resource_view_name(api::resource_view, const char *)
+{
+}
+
+bool reshade::null::device_impl::create_fence(uint64_t initial_value, api::fence_flags, api::fence *out_fence, void **shared_handle)
+{
+	if (shared_handle != nullptr)
+	{
+		*out_fence = { 0 };
+		return false;
+	}
+
+	const auto object = new fence_object();
+	object->value = initial_value;
+
+	*out_fence = { to_handle(object) };
+	_live_objects++;
+	return true;
+}
+void reshade::null::device_impl::destroy_fence(api::fence fence)
+{
+	if (fence == 0)
+		return;
+
+	delete from_handle<fence_object>(fence.handle);
+	_live_objects--;
+}
+
+uint64_t reshade::null::device_impl::get_completed_fence_value(api::fence fence) const
+{
+	assert(fence != 0);
+
+	return from_handle<fence_object>(fence.handle)->value;
+}
+
+bool reshade::null::device_impl::wait(api::fence fence, uint64_t value, uint64_t)
+{
+	// There is no GPU work that could signal the fence asynchronously, so either the value was already reached or it never will be
+	return get_completed_fence_value(fence) >= value;
+}
+bool reshade::null::device_impl::signal(api::fence fence, uint64_t value)
+{
+	assert(fence != 0);
+
+	from_handle<fence_object>(fence.handle)->value = value;
+	return true;
+}
+
+void reshade::null::device_impl::get_acceleration_structure_size(api::acceleration_structure_type, api::acceleration_structure_build_flags, uint32_t, const api::acceleration_structure_build_input *, uint64_t *out_size, uint64_t *out_build_scratch_size, uint64_t *out_update_scratch_size) const
+{
+	if (out_size != nullptr)
+		*out_size = 0;
+	if (out_build_scratch_size != nullptr)
+		*out_build_scratch_size = 0;
+	if (out_update_scratch_size != nullptr)
+		*out_update_scratch_size = 0;
+}
+
+bool reshade::null::device_impl::get_pipeline_shader_group_handles(api::pipeline, uint32_t, uint32_t, void *)
+{
+	return false;
+}
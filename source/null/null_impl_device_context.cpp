@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_device_context.hpp"
+#include <chrono>
+#include <algorithm> // std::fill_n
+
+reshade::null::device_context_impl::device_context_impl(device_impl *device) :
+	api_object_impl(nullptr),
+	_device_impl(device)
+{
+	_recorded_commands.reserve(4096);
+}
+
+reshade::api::device *reshade::null::device_context_impl::get_device()
+{
+	return _device_impl;
+}
+
+void reshade::null::device_context_impl::record(command_type type)
+{
+	_recorded_commands.push_back(type);
+	_command_counts[static_cast<size_t>(type)]++;
+}
+void reshade::null::device_context_impl::clear_recorded_commands()
+{
+	_recorded_commands.clear();
+	std::fill_n(_command_counts, static_cast<size_t>(command_type::count), size_t(0));
+}
+
+void reshade::null::device_context_impl::barrier(uint32_t, const api::resource *, const api::resource_usage *, const api::resource_usage *)
+{
+	record(command_type::barrier);
+}
+
+void reshade::null::device_context_impl::begin_render_pass(uint32_t, const api::render_pass_render_target_desc *, const api::render_pass_depth_stencil_desc *)
+{
+	record(command_type::begin_render_pass);
+}
+void reshade::null::device_context_impl::end_render_pass()
+{
+	record(command_type::end_render_pass);
+}
+void reshade::null::device_context_impl::bind_render_targets_and_depth_stencil(uint32_t, const api::resource_view *, api::resource_view)
+{
+	record(command_type::bind_render_targets_and_depth_stencil);
+}
+
+void reshade::null::device_context_impl::bind_pipeline(api::pipeline_stage, api::pipeline)
+{
+	record(command_type::bind_pipeline);
+}
+void reshade::null::device_context_impl::bind_pipeline_states(uint32_t, const api::dynamic_state *, const uint32_t *)
+{
+	record(command_type::bind_pipeline_states);
+}
+void reshade::null::device_context_impl::bind_viewports(uint32_t, uint32_t, const api::viewport *)
+{
+	record(command_type::bind_viewports);
+}
+void reshade::null::device_context_impl::bind_scissor_rects(uint32_t, uint32_t, const api::rect *)
+{
+	record(command_type::bind_scissor_rects);
+}
+
+void reshade::null::device_context_impl::push_constants(api::shader_stage, api::pipeline_layout, uint32_t, uint32_t, uint32_t, const void *)
+{
+	record(command_type::push_constants);
+}
+void reshade::null::device_context_impl::push_descriptors(api::shader_stage, api::pipeline_layout, uint32_t, const api::descriptor_table_update &)
+{
+	record(command_type::push_descriptors);
+}
+void reshade::null::device_context_impl::bind_descriptor_tables(api::shader_stage, api::pipeline_layout, uint32_t, uint32_t, const api::descriptor_table *)
+{
+	record(command_type::bind_descriptor_tables);
+}
+
+void reshade::null::device_context_impl::bind_index_buffer(api::resource, uint64_t, uint32_t)
+{
+	record(command_type::bind_index_buffer);
+}
+void reshade::null::device_context_impl::bind_vertex_buffers(uint32_t, uint32_t, const api::resource *, const uint64_t *, const uint32_t *)
+{
+	record(command_type::bind_vertex_buffers);
+}
+void reshade::null::device_context_impl::bind_stream_output_buffers(uint32_t, uint32_t, const api::resource *, const uint64_t *, const uint64_t *, const api::resource *, const uint64_t *)
+{
+	record(command_type::bind_stream_output_buffers);
+}
+
+void reshade::null::device_context_impl::draw(uint32_t, uint32_t, uint32_t, uint32_t)
+{
+	record(command_type::draw);
+}
+void reshade::null::device_context_impl::draw_indexed(uint32_t, uint32_t, uint32_t, int32_t, uint32_t)
+{
+	record(command_type::draw_indexed);
+}
+void reshade::null::device_context_impl::dispatch(uint32_t, uint32_t, uint32_t)
+{
+	record(command_type::dispatch);
+}
+void reshade::null::device_context_impl::dispatch_mesh(uint32_t, uint32_t, uint32_t)
+{
+	record(command_type::dispatch_mesh);
+}
+void reshade::null::device_context_impl::dispatch_rays(api::resource, uint64_t, uint64_t, api::resource, uint64_t, uint64_t, uint64_t, api::resource, uint64_t, uint64_t, uint64_t, api::resource, uint64_t, uint64_t, uint64_t, uint32_t, uint32_t, uint32_t)
+{
+	record(command_type::dispatch_rays);
+}
+void reshade::null::device_context_impl::draw_or_dispatch_indirect(api::indirect_command, api::resource, uint64_t, uint32_t, uint32_t)
+{
+	record(command_type::draw_or_dispatch_indirect);
+}
+
+void reshade::null::device_context_impl::copy_resource(api::resource, api::resource)
+{
+	record(command_type::copy_resource);
+}
+void reshade::null::device_context_impl::copy_buffer_region(api::resource, uint64_t, api::resource, uint64_t, uint64_t)
+{
+	record(command_type::copy_buffer_region);
+}
+void reshade::null::device_context_impl::copy_buffer_to_texture(api::resource, uint64_t, uint32_t, uint32_t, api::resource, uint32_t, const api::subresource_box *)
+{
+	record(command_type::copy_buffer_to_texture);
+}
+void reshade::null::device_context_impl::copy_texture_region(api::resource, uint32_t, const api::subresource_box *, api::resource, uint32_t, const api::subresource_box *, api::filter_mode)
+{
+	record(command_type::copy_texture_region);
+}
+void reshade::null::device_context_impl::copy_texture_to_buffer(api::resource, uint32_t, const api::subresource_box *, api::resource, uint64_t, uint32_t, uint32_t)
+{
+	record(command_type::copy_texture_to_buffer);
+}
+void reshade::null::device_context_impl::resolve_texture_region(api::resource, uint32_t, const api::subresource_box *, api::resource, uint32_t, uint32_t, uint32_t, uint32_t, api::format)
+{
+	record(command_type::resolve_texture_region);
+}
+
+void reshade::null::device_context_impl::clear_depth_stencil_view(api::resource_view, const float *, const uint8_t *, uint32_t, const api::rect *)
+{
+	record(command_type::clear_depth_stencil_view);
+}
+void reshade::null::device_context_impl::clear_render_target_view(api::resource_view, const float[4], uint32_t, const api::rect *)
+{
+	record(command_type::clear_render_target_view);
+}
+void reshade::null::device_context_impl::clear_unordered_access_view_uint(api::resource_view, const uint32_t[4], uint32_t, const api::rect *)
+{
+	record(command_type::clear_unordered_access_view_uint);
+}
+void reshade::null::device_context_impl::clear_unordered_access_view_float(api::resource_view, const float[4], uint32_t, const api::rect *)
+{
+	record(command_type::clear_unordered_access_view_float);
+}
+
+void reshade::null::device_context_impl::generate_mipmaps(api::resource_view)
+{
+	record(command_type::generate_mipmaps);
+}
+
+void reshade::null::device_context_impl::begin_query(api::query_heap, api::query_type, uint32_t)
+{
+	record(command_type::begin_query);
+}
+void reshade::null::device_context_impl::end_query(api::query_heap heap, api::query_type type, uint32_t index)
+{
+	record(command_type::end_query);
+
+	// Timestamps are taken on the CPU, since that is where all the work of this device happens
+	if (type == api::query_type::timestamp)
+	{
+		query_heap_object *const object = reinterpret_cast<query_heap_object *>(static_cast<uintptr_t>(heap.handle));
+		if (index < object->results.size())
+			object->results[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	}
+}
+void reshade::null::device_context_impl::copy_query_heap_results(api::query_heap, api::query_type, uint32_t, uint32_t, api::resource, uint64_t, uint32_t)
+{
+	record(command_type::copy_query_heap_results);
+}
+
+void reshade::null::device_context_impl::copy_acceleration_structure(api::resource_view, api::resource_view, api::acceleration_structure_copy_mode)
+{
+	record(command_type::copy_acceleration_structure);
+}
+void reshade::null::device_context_impl::build_acceleration_structure(api::acceleration_structure_type, api::acceleration_structure_build_flags, uint32_t, const api::acceleration_structure_build_input *, api::resource, uint64_t, api::resource_view, api::resource_view, api::acceleration_structure_build_mode)
+{
+	record(command_type::build_acceleration_structure);
+}
+void reshade::null::device_context_impl::query_acceleration_structures(uint32_t, const api::resource_view *, api::query_heap, api::query_type, uint32_t)
+{
+	record(command_type::query_acceleration_structures);
+}
+
+void reshade::null::device_context_impl::begin_debug_event(const char *, const float[4])
+{
+	record(command_type::begin_debug_event);
+}
+void reshade::null::device_context_impl::end_debug_event()
+{
+	record(command_type::end_debug_event);
+}
+void reshade::null::device_context_impl::insert_debug_marker(const char *, const float[4])
+{
+	record(command_type::insert_debug_marker);
+}
+
+bool reshade::null::device_context_impl::wait(api::fence fence, uint64_t value)
+{
+	return _device_impl->wait(fence, value, UINT64_MAX);
+}
+bool reshade::null::device_context_impl::signal(api::fence fence, uint64_t value)
+{
+	return _device_impl->signal(fence, value);
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "null_impl_device.hpp"
+
+namespace reshade::null
+{
+	enum class command_type : uint8_t
+	{
+		barrier,
+		begin_render_pass,
+		end_render_pass,
+		bind_render_targets_and_depth_stencil,
+		bind_pipeline,
+		bind_pipeline_states,
+		bind_viewports,
+		bind_scissor_rects,
+		push_constants,
+		push_descriptors,
+		bind_descriptor_tables,
+		bind_index_buffer,
+		bind_vertex_buffers,
+		bind_stream_output_buffers,
+		draw,
+		draw_indexed,
+		dispatch,
+		dispatch_mesh,
+		dispatch_rays,
+		draw_or_dispatch_indirect,
+		copy_resource,
+		copy_buffer_region,
+		copy_buffer_to_texture,
+		copy_texture_region,
+		copy_texture_to_buffer,
+		resolve_texture_region,
+		clear_depth_stencil_view,
+		clear_render_target_view,
+		clear_unordered_access_view_uint,
+		clear_unordered_access_view_float,
+		generate_mipmaps,
+		begin_query,
+		end_query,
+		copy_query_heap_results,
+		copy_acceleration_structure,
+		build_acceleration_structure,
+		query_acceleration_structures,
+		begin_debug_event,
+		end_debug_event,
+		insert_debug_marker,
+		count
+	};
+
+	/// <summary>
+	/// Combined command queue and immediate command list implementation for the null device, which executes nothing and instead records the type of every command that was issued.
+	/// </summary>
+	class device_context_impl : public api::api_object_impl<void *, api::command_queue, api::command_list>
+	{
+	public:
+		explicit device_context_impl(device_impl *device);
+
+		api::device *get_device() final;
+
+		api::command_queue_type get_type() const final { return api::command_queue_type::graphics | api::command_queue_type::compute | api::command_queue_type::copy; }
+
+		void wait_idle() const final {}
+
+		void flush_immediate_command_list() const final {}
+
+		api::command_list *get_immediate_command_list() final { return this; }
+
+		void barrier(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states) final;
+
+		void begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds) final;
+		void end_render_pass() final;
+		void bind_render_targets_and_depth_stencil(uint32_t count, const api::resource_view *rtvs, api::resource_view dsv) final;
+
+		void bind_pipeline(api::pipeline_stage stages, api::pipeline pipeline) final;
+		void bind_pipeline_states(uint32_t count, const api::dynamic_state *states, const uint32_t *values) final;
+		void bind_viewports(uint32_t first, uint32_t count, const api::viewport *viewports) final;
+		void bind_scissor_rects(uint32_t first, uint32_t count, const api::rect *rects) final;
+
+		void push_constants(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, uint32_t first, uint32_t count, const void *values) final;
+		void push_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update) final;
+		void bind_descriptor_tables(api::shader_stage stages, api::pipeline_layout layout, uint32_t first, uint32_t count, const api::descriptor_table *tables) final;
+
+		void bind_index_buffer(api::resource buffer, uint64_t offset, uint32_t index_size) final;
+		void bind_vertex_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint32_t *strides) final;
+		void bind_stream_output_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint64_t *max_sizes, const api::resource *counter_buffers, const uint64_t *counter_offsets) final;
+
+		void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) final;
+		void draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) final;
+		void dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) final;
+		void dispatch_mesh(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) final;
+		void dispatch_rays(api::resource raygen, uint64_t raygen_offset, uint64_t raygen_size, api::resource miss, uint64_t miss_offset, uint64_t miss_size, uint64_t miss_stride, api::resource hit_group, uint64_t hit_group_offset, uint64_t hit_group_size, uint64_t hit_group_stride, api::resource callable, uint64_t callable_offset, uint64_t callable_size, uint64_t callable_stride, uint32_t width, uint32_t height, uint32_t depth) final;
+		void draw_or_dispatch_indirect(api::indirect_command type, api::resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) final;
+
+		void copy_resource(api::resource source, api::resource dest) final;
+		void copy_buffer_region(api::resource source, uint64_t source_offset, api::resource dest, uint64_t dest_offset, uint64_t size) final;
+		void copy_buffer_to_texture(api::resource source, uint64_t source_offset, uint32_t row_length, uint32_t slice_height, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box) final;
+		void copy_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, const api::subresource_box *dest_box, api::filter_mode filter) final;
+		void copy_texture_to_buffer(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint64_t dest_offset, uint32_t row_length, uint32_t slice_height) final;
+		void resolve_texture_region(api::resource source, uint32_t source_subresource, const api::subresource_box *source_box, api::resource dest, uint32_t dest_subresource, uint32_t dest_x, uint32_t dest_y, uint32_t dest_z, api::format format) final;
+
+		void clear_depth_stencil_view(api::resource_view dsv, const float *depth, const uint8_t *stencil, uint32_t rect_count, const api::rect *rects) final;
+		void clear_render_target_view(api::resource_view rtv, const float color[4], uint32_t rect_count, const api::rect *rects) final;
+		void clear_unordered_access_view_uint(api::resource_view uav, const uint32_t values[4], uint32_t rect_count, const api::rect *rects) final;
+		void clear_unordered_access_view_float(api::resource_view uav, const float values[4], uint32_t rect_count, const api::rect *rects) final;
+
+		void generate_mipmaps(api::resource_view srv) final;
+
+		void begin_query(api::query_heap heap, api::query_type type, uint32_t index) final;
+		void end_query(api::query_heap heap, api::query_type type, uint32_t index) final;
+		void copy_query_heap_results(api::query_heap heap, api::query_type type, uint32_t first, uint32_t count, api::resource dest, uint64_t dest_offset, uint32_t stride) final;
+
+		void copy_acceleration_structure(api::resource_view source, api::resource_view dest, api::acceleration_structure_copy_mode mode) final;
+		void build_acceleration_structure(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, api::resource scratch, uint64_t scratch_offset, api::resource_view source, api::resource_view dest, api::acceleration_structure_build_mode mode) final;
+		void query_acceleration_structures(uint32_t count, const api::resource_view *acceleration_structures, api::query_heap heap, api::query_type type, uint32_t first) final;
+
+		void begin_debug_event(const char *label, const float color[4]) final;
+		void end_debug_event() final;
+		void insert_debug_marker(const char *label, const float color[4]) final;
+
+		bool wait(api::fence fence, uint64_t value) final;
+		bool signal(api::fence fence, uint64_t value) final;
+
+		uint64_t get_timestamp_frequency() const final { return 1000000000; }
+
+		/// <summary>
+		/// Gets the list of commands recorded since the last call to <see cref="clear_recorded_commands"/>.
+		/// </summary>
+		const std::vector<command_type> &get_recorded_commands() const { return _recorded_commands; }
+		/// <summary>
+		/// Gets the number of commands of the specified <paramref name="type"/> recorded since the last call to <see cref="clear_recorded_commands"/>.
+		/// </summary>
+		size_t get_recorded_command_count(command_type type) const { return _command_counts[static_cast<size_t>(type)]; }
+		void clear_recorded_commands();
+
+	private:
+		void record(command_type type);
+
+		device_impl *const _device_impl;
+		std::vector<command_type> _recorded_commands;
+		size_t _command_counts[static_cast<size_t>(command_type::count)] = {};
+	};
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "null_impl_swapchain.hpp"
+
+reshade::null::swapchain_impl::swapchain_impl(device_impl *device, uint32_t width, uint32_t height, api::format format, uint32_t back_buffer_count) :
+	api_object_impl(nullptr),
+	_device_impl(device)
+{
+	assert(back_buffer_count != 0);
+
+	_back_buffers.resize(back_buffer_count);
+
+	for (api::resource &back_buffer : _back_buffers)
+	{
+		if (!_device_impl->create_resource(
+				api::resource_desc(width, height, 1, 1, format, 1, api::memory_heap::gpu_only, api::resource_usage::render_target | api::resource_usage::copy_source | api::resource_usage::copy_dest),
+				nullptr, api::resource_usage::present, &back_buffer))
+			back_buffer = { 0 };
+	}
+}
+reshade::null::swapchain_impl::~swapchain_impl()
+{
+	for (const api::resource back_buffer : _back_buffers)
+		_device_impl->destroy_resource(back_buffer);
+}
+
+reshade::api::device *reshade::null::swapchain_impl::get_device()
+{
+	return _device_impl;
+}
+
+reshade::api::resource reshade::null::swapchain_impl::get_back_buffer(uint32_t index)
+{
+	assert(index < _back_buffers.size());
+
+	return _back_buffers[index];
+}
+
+void reshade::null::swapchain_impl::present()
+{
+	_current_index = (_current_index + 1) % static_cast<uint32_t>(_back_buffers.size());
+}
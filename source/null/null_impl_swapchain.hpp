@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "null_impl_device.hpp"
+
+namespace reshade::null
+{
+	/// <summary>
+	/// Swap chain implementation for the null device, which owns a set of back buffers that are never shown anywhere.
+	/// </summary>
+	class swapchain_impl : public api::api_object_impl<void *, api::swapchain>
+	{
+	public:
+		swapchain_impl(device_impl *device, uint32_t width, uint32_t height, api::format format = api::format::r8g8b8a8_unorm, uint32_t back_buffer_count = 2);
+		~swapchain_impl();
+
+		api::device *get_device() final;
+
+		void *get_hwnd() const final { return nullptr; }
+
+		api::resource get_back_buffer(uint32_t index) final;
+
+		uint32_t get_back_buffer_count() const final { return static_cast<uint32_t>(_back_buffers.size()); }
+		uint32_t get_current_back_buffer_index() const final { return _current_index; }
+
+		bool check_color_space_support(api::color_space color_space) const final { return color_space == api::color_space::srgb_nonlinear; }
+
+		api::color_space get_color_space() const final { return api::color_space::srgb_nonlinear; }
+
+		/// <summary>
+		/// Advances to the next back buffer.
+		/// </summary>
+		void present();
+
+	private:
+		device_impl *const _device_impl;
+		std::vector<api::resource> _back_buffers;
+		uint32_t _current_index = 0;
+	};
+}
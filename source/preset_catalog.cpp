@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "preset_catalog.hpp"
+#include "ini_file.hpp"
+#include <cstdio> // std::fgets, std::fgetc, std::fseek
+#include <cstring> // std::strlen
+#include <algorithm> // std::min
+#include <utf8/core.h>
+
+reshade::preset_catalog::~preset_catalog()
+{
+	if (_scan_thread.joinable())
+		_scan_thread.join();
+}
+
+std::vector<reshade::preset_catalog::entry> reshade::preset_catalog::scan(const std::filesystem::path &directory)
+{
+	std::vector<entry> entries;
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry &dir_entry : std::filesystem::directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, ec))
+	{
+		if (const std::filesystem::path ext = dir_entry.path().extension();
+			ext != L".ini" && ext != L".txt")
+			continue;
+
+		// The directory entry already carries the modification time, so validating an entry does not need to touch the file itself
+		const std::filesystem::file_time_type modified_at = dir_entry.last_write_time(ec);
+		if (ec || dir_entry.is_directory(ec))
+			continue;
+
+		entries.push_back(find_or_read(dir_entry.path(), modified_at));
+	}
+
+	return entries;
+}
+void reshade::preset_catalog::scan_async(const std::filesystem::path &directory)
+{
+	if (_scan_in_progress)
+		return;
+	if (_scan_thread.joinable())
+		_scan_thread.join();
+
+	_scan_in_progress = true;
+	_scan_thread = std::thread([this, directory]() {
+		scan(directory);
+		_scan_in_progress = false;
+	});
+}
+
+bool reshade::preset_catalog::is_valid_preset(const std::filesystem::path &path)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+
+	return find_or_read(path, modified_at).valid;
+}
+
+reshade::preset_catalog::entry reshade::preset_catalog::find_or_read(const std::filesystem::path &path, std::filesystem::file_time_type modified_at)
+{
+	{	const std::unique_lock<std::mutex> lock(_mutex);
+
+		if (const auto it = _entries.find(path.native());
+			it != _entries.end() && it->second.modified_at == modified_at)
+			return it->second;
+	}
+
+	// Read the file without holding the lock, so that a background scan does not block lookups of files that are already known
+	entry new_entry;
+	new_entry.path = path;
+	new_entry.modified_at = modified_at;
+	read(new_entry);
+
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	_entries[path.native()] = new_entry;
+	return new_entry;
+}
+
+void reshade::preset_catalog::read(entry &entry)
+{
+	FILE *const file = _wfsopen(entry.path.c_str(), L"r", SH_DENYWR);
+	if (file == nullptr)
+		return;
+
+	// Remove BOM (0xefbbbf means 0xfeff)
+	if (fgetc(file) != utf8::bom[0] || fgetc(file) != utf8::bom[1] || fgetc(file) != utf8::bom[2])
+		fseek(file, 0, SEEK_SET);
+
+	// The technique list is in the global section at the top of the file, so there is no need to look past the first section header
+	std::string line_data;
+	line_data.resize(BUFSIZ);
+	while (fgets(line_data.data(), static_cast<int>(line_data.size() + 1), file))
+	{
+		size_t line_length;
+		while ((line_length = std::strlen(line_data.data())) == line_data.size() && line_data.back() != '\n')
+		{
+			line_data.resize(line_data.size() + BUFSIZ);
+			if (!fgets(line_data.data() + line_length, static_cast<int>(line_data.size() - line_length + 1), file))
+				break;
+		}
+
+		const std::string_view line = trim(std::string_view(line_data.data(), line_length), " \t\r\n");
+
+		if (line.empty() || line[0] == ';' || line[0] == '/' || line[0] == '#')
+			continue;
+		if (line[0] == '[')
+			break;
+
+		const size_t assign_index = line.find('=');
+		if (assign_index == std::string_view::npos || trim(line.substr(0, assign_index)) != "Techniques")
+			continue;
+
+		entry.valid = true;
+		entry.technique_count = 0;
+
+		// Count list elements the same way 'ini_file' splits them, where ",," is an escaped comma
+		const std::string_view value = trim(line.substr(assign_index + 1));
+		for (size_t offset = 0, len = value.size(); offset < len;)
+		{
+			const size_t found = std::min(value.find(',', offset), len);
+			if (found + 1 < len && value[found + 1] == ',')
+			{
+				offset = found + 2;
+				continue;
+			}
+
+			entry.technique_count++;
+			offset = found + 1;
+		}
+	}
+
+	fclose(file);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+
+namespace reshade
+{
+	/// <summary>
+	/// Index of preset files, so that finding the valid presets in a directory (e.g. when switching to the next preset) does not require loading every INI file in full.
+	/// Entries are validated against the file modification time, so only files that changed since they were last looked at are read again, and then only up to their first section.
+	/// </summary>
+	class preset_catalog
+	{
+	public:
+		struct entry
+		{
+			std::filesystem::path path;
+			std::filesystem::file_time_type modified_at;
+			// File has a technique list, which is what makes it a preset
+			bool valid = false;
+			size_t technique_count = 0;
+		};
+
+		~preset_catalog();
+
+		/// <summary>
+		/// Gets the entries of all preset file candidates (".ini" and ".txt" files) in the specified <paramref name="directory"/>, in directory order.
+		/// </summary>
+		std::vector<entry> scan(const std::filesystem::path &directory);
+		/// <summary>
+		/// Starts scanning the specified <paramref name="directory"/> on a background thread, so that a later call to <see cref="scan"/> only has to validate modification times.
+		/// Does nothing if a scan is already in progress. Must not be called from multiple threads at once.
+		/// </summary>
+		void scan_async(const std::filesystem::path &directory);
+
+		/// <summary>
+		/// Checks whether the file at the specified <paramref name="path"/> exists and is a preset.
+		/// </summary>
+		bool is_valid_preset(const std::filesystem::path &path);
+
+	private:
+		entry find_or_read(const std::filesystem::path &path, std::filesystem::file_time_type modified_at);
+		static void read(entry &entry);
+
+		std::mutex _mutex;
+		std::unordered_map<std::wstring, entry> _entries;
+		std::thread _scan_thread;
+		std::atomic<bool> _scan_in_progress = false;
+	};
+}
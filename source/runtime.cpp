@@ -18,6 +18,8 @@
 #include "com_ptr.hpp"
 #include "platform_utils.hpp"
 #include "reshade_api_object_impl.hpp"
+#include "d3d12/d3d12_impl_device.hpp"
+#include "vulkan/vulkan_impl_device.hpp"
 #include <set>
 #include <thread>
 #include <cmath> // std::abs, std::fmod
@@ -27,7 +29,7 @@
 #include <cstdlib> // std::malloc, std::rand, std::strtod, std::strtol
 #include <cstring> // std::memcpy, std::memset, std::strlen
 #include <charconv> // std::to_chars
-#include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::set_symmetric_difference, std::sort, std::stable_sort, std::swap, std::transform
+#include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::rotate, std::search, std::set_symmetric_difference, std::sort, std::stable_sort, std::swap, std::transform
 #include <fpng.h>
 #include <stb_image.h>
 #include <stb_image_dds.h>
@@ -173,6 +175,138 @@ static std::vector<std::filesystem::path> find_files(const std::vector<std::file
 	return files;
 }
 
+static bool is_transient_texture(const reshadefx::effect_module &module, const std::string &texture_name)
+{
+	// A texture is transient if it is only ever used within a single technique and is cleared by the first pass that touches it, so its contents never have to survive past that technique
+	const reshadefx::technique *referencing_technique = nullptr;
+	bool initialized = false;
+
+	for (const reshadefx::technique &tech : module.techniques)
+	{
+		for (const reshadefx::pass &pass : tech.passes)
+		{
+			const bool sampled = std::any_of(pass.texture_bindings.cbegin(), pass.texture_bindings.cend(),
+				[&module, &texture_name](const reshadefx::texture_binding &binding) { return module.samplers[binding.index].texture_name == texture_name; });
+			const bool stored = std::any_of(pass.storage_bindings.cbegin(), pass.storage_bindings.cend(),
+				[&module, &texture_name](const reshadefx::storage_binding &binding) { return module.storages[binding.index].texture_name == texture_name; });
+			const bool rendered = std::find(std::begin(pass.render_target_names), std::end(pass.render_target_names), texture_name) != std::end(pass.render_target_names);
+
+			if (!sampled && !stored && !rendered)
+				continue;
+
+			// Compute shaders may only write parts of the texture, so cannot tell whether previous contents are needed
+			if (stored || (referencing_technique != nullptr && referencing_technique != &tech))
+				return false;
+			referencing_technique = &tech;
+
+			if (!initialized)
+			{
+				// Clearing only affects the first mipmap level, so the others have to be regenerated from it
+				if (!rendered || !pass.clear_render_targets || !pass.generate_mipmaps)
+					return false;
+				initialized = true;
+			}
+		}
+	}
+
+	return initialized;
+}
+
+static reshade::api::format convert_texture_format(reshadefx::texture_format format)
+{
+	switch (format)
+	{
+	case reshadefx::texture_format::r8:
+		return reshade::api::format::r8_unorm;
+	case reshadefx::texture_format::r16:
+		return reshade::api::format::r16_unorm;
+	case reshadefx::texture_format::r16f:
+		return reshade::api::format::r16_float;
+	case reshadefx::texture_format::r32i:
+		return reshade::api::format::r32_sint;
+	case reshadefx::texture_format::r32u:
+		return reshade::api::format::r32_uint;
+	case reshadefx::texture_format::r32f:
+		return reshade::api::format::r32_float;
+	case reshadefx::texture_format::rg8:
+		return reshade::api::format::r8g8_unorm;
+	case reshadefx::texture_format::rg16:
+		return reshade::api::format::r16g16_unorm;
+	case reshadefx::texture_format::rg16f:
+		return reshade::api::format::r16g16_float;
+	case reshadefx::texture_format::rg32f:
+		return reshade::api::format::r32g32_float;
+	case reshadefx::texture_format::rgba8:
+		return reshade::api::format::r8g8b8a8_typeless;
+	case reshadefx::texture_format::rgba16:
+		return reshade::api::format::r16g16b16a16_unorm;
+	case reshadefx::texture_format::rgba16f:
+		return reshade::api::format::r16g16b16a16_float;
+	case reshadefx::texture_format::rgba32i:
+		return reshade::api::format::r32g32b32a32_sint;
+	case reshadefx::texture_format::rgba32u:
+		return reshade::api::format::r32g32b32a32_uint;
+	case reshadefx::texture_format::rgba32f:
+		return reshade::api::format::r32g32b32a32_float;
+	case reshadefx::texture_format::rgb10a2:
+		return reshade::api::format::r10g10b10a2_unorm;
+	default:
+		return reshade::api::format::unknown;
+	}
+}
+
+static void get_effect_descriptor_ranges(const reshadefx::effect_module &module, bool sampler_with_resource_view, reshade::api::descriptor_range (&ranges)[4])
+{
+	reshade::api::descriptor_range &cb_range = ranges[0];
+	cb_range.binding = 0;
+	cb_range.dx_register_index = 0; // b0 (global constant buffer)
+	cb_range.dx_register_space = 0;
+	cb_range.count = 1;
+	cb_range.array_size = 1;
+	cb_range.type = reshade::api::descriptor_type::constant_buffer;
+	cb_range.visibility = reshade::api::shader_stage::vertex | reshade::api::shader_stage::pixel | reshade::api::shader_stage::compute;
+
+	reshade::api::descriptor_range &sampler_range = ranges[1];
+	sampler_range.binding = 0;
+	sampler_range.dx_register_index = 0; // s#
+	sampler_range.dx_register_space = 0;
+	sampler_range.count = 0;
+	sampler_range.array_size = 1;
+	sampler_range.type = sampler_with_resource_view ? reshade::api::descriptor_type::sampler_with_resource_view : reshade::api::descriptor_type::sampler;
+	sampler_range.visibility = reshade::api::shader_stage::vertex | reshade::api::shader_stage::pixel | reshade::api::shader_stage::compute;
+
+	reshade::api::descriptor_range &srv_range = ranges[2];
+	srv_range.binding = 0;
+	srv_range.dx_register_index = 0; // t#
+	srv_range.dx_register_space = 0;
+	srv_range.count = 0;
+	srv_range.array_size = 1;
+	srv_range.type = reshade::api::descriptor_type::shader_resource_view;
+	srv_range.visibility = reshade::api::shader_stage::vertex | reshade::api::shader_stage::pixel | reshade::api::shader_stage::compute;
+
+	reshade::api::descriptor_range &uav_range = ranges[3];
+	uav_range.binding = 0;
+	uav_range.dx_register_index = 0; // u#
+	uav_range.dx_register_space = 0;
+	uav_range.count = 0;
+	uav_range.array_size = 1;
+	uav_range.type = reshade::api::descriptor_type::unordered_access_view;
+	uav_range.visibility = reshade::api::shader_stage::vertex | reshade::api::shader_stage::pixel | reshade::api::shader_stage::compute;
+
+	for (const reshadefx::technique &tech : module.techniques)
+	{
+		for (const reshadefx::pass &pass : tech.passes)
+		{
+			for (const reshadefx::sampler_binding &binding : pass.sampler_bindings)
+				sampler_range.count = std::max(sampler_range.count, binding.entry_point_binding + 1);
+			for (const reshadefx::texture_binding &binding : pass.texture_bindings)
+				srv_range.count = std::max(srv_range.count, binding.entry_point_binding + 1);
+			for (const reshadefx::storage_binding &binding : pass.storage_bindings)
+				uav_range.count = std::max(uav_range.count, binding.entry_point_binding + 1);
+		}
+	}
+}
+
 reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphics_queue, const std::filesystem::path &config_path, bool is_vr) :
 	_swapchain(swapchain),
 	_device(swapchain->get_device()),
@@ -224,9 +358,9 @@ reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphic
 	// Default shortcut PrtScrn
 	_screenshot_key_data[0] = 0x2C;
 
-#if RESHADE_GUI
 	_timestamp_frequency = graphics_queue->get_timestamp_frequency();
 
+#if RESHADE_GUI
 	init_gui();
 #endif
 
@@ -250,6 +384,9 @@ reshade::runtime::~runtime()
 
 	deinit_gui();
 #endif
+
+	// Finish writing files that were queued by 'flush_cache' before the runtime goes away
+	ini_file::wait_for_flush();
 }
 
 bool reshade::runtime::on_init()
@@ -447,6 +584,8 @@ bool reshade::runtime::on_init()
 	if (window != nullptr)
 		utils::set_window_transparency(window, false);
 
+	load_pipeline_cache();
+
 	// Reset frame count to zero so effects are loaded in 'update_effects'
 	_frame_count = 0;
 	_has_reloaded_after_init = false;
@@ -559,6 +698,18 @@ void reshade::runtime::on_reset()
 	_device->destroy_fence(_queue_sync_fence);
 	_queue_sync_fence = {};
 
+	assert(_async_compute_resources.empty());
+	_device->destroy_fence(_async_compute_begin_fence);
+	_async_compute_begin_fence = {};
+	_device->destroy_fence(_async_compute_end_fence);
+	_async_compute_end_fence = {};
+
+	if (_compute_queue != nullptr)
+	{
+		static_cast<d3d12::device_impl *>(_device)->destroy_async_compute_queue(_compute_queue);
+		_compute_queue = nullptr;
+	}
+
 	_width = _height = 0;
 	_back_buffer_format = api::format::unknown;
 	_back_buffer_samples = 1;
@@ -655,7 +806,12 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	if (_should_save_screenshot)
 		save_screenshot(_screenshot_save_before ? "After" : std::string_view());
 
+	// Adjust update rates only once per frame, independent of how often effects were rendered during it
+	update_technique_governor();
+
 	_frame_count++;
+	_last_frame_binds_issued = _binds_issued; _binds_issued = 0;
+	_last_frame_binds_skipped = _binds_skipped; _binds_skipped = 0;
 	const auto current_time = std::chrono::high_resolution_clock::now();
 	_last_frame_duration = current_time - _last_present_time; _last_present_time = current_time;
 
@@ -818,7 +974,7 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 
 			// Continuously update preset values while a transition is in progress
 			if (_is_in_preset_transition)
-				load_current_preset();
+				update_preset_transition();
 		}
 	}
 
@@ -964,16 +1120,22 @@ void reshade::runtime::load_config()
 	config_get("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
 	config_get("GENERAL", "EffectTimeDelay", _effect_load_delay);
+	config_get("GENERAL", "EffectCreationBudget", _effect_create_budget);
+	config_get("GENERAL", "EffectGPUTimeBudget", _gpu_time_budget);
+	config_get("GENERAL", "EffectAsyncCompute", _async_compute);
+	config_get("GENERAL", "EffectVariantCacheSize", _effect_variant_cache_size);
 	config_get("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config_get("GENERAL", "PerformanceMode", _performance_mode);
 	config_get("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
 	config_get("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config_get("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config_get("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config_get("GENERAL", "EffectLoadTracePath", _effect_load_trace_path);
 
 	config_get("GENERAL", "StartupPresetPath", _startup_preset_path);
 	config_get("GENERAL", "PresetPath", _current_preset_path);
 	config_get("GENERAL", "PresetTransitionDuration", _preset_transition_duration);
+	config_get("GENERAL", "PresetTransitionCurve", _preset_transition_curve);
 
 	config_get("GENERAL", "UIBindSupport", _ui_bind_support);
 	config_get("GENERAL", "AuroraFeature", _aurora_feature);
@@ -1010,6 +1172,9 @@ void reshade::runtime::load_config()
 		_preset_shortcuts.push_back(std::move(shortcut));
 	}
 
+	// Index the presets next to the current one in the background, so that switching between them later is quick
+	_preset_catalog.scan_async(_current_preset_path.parent_path());
+
 	config_get("SCREENSHOT", "SavePath", _screenshot_path);
 	config_get("SCREENSHOT", "SoundPath", _screenshot_sound_path);
 	config_get("SCREENSHOT", "ClearAlpha", _screenshot_clear_alpha);
@@ -1050,17 +1215,23 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
 	config.set("GENERAL", "EffectTimeDelay", _effect_load_delay);
+	config.set("GENERAL", "EffectCreationBudget", _effect_create_budget);
+	config.set("GENERAL", "EffectGPUTimeBudget", _gpu_time_budget);
+	config.set("GENERAL", "EffectAsyncCompute", _async_compute);
+	config.set("GENERAL", "EffectVariantCacheSize", _effect_variant_cache_size);
 	config.set("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config.set("GENERAL", "PerformanceMode", _performance_mode);
 	config.set("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
 	config.set("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config.set("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config.set("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config.set("GENERAL", "EffectLoadTracePath", _effect_load_trace_path);
 
 	config.set("GENERAL", "StartupPresetPath", make_relative_path(_startup_preset_path));
 	config.set("GENERAL", "PresetPath", make_relative_path(_current_preset_path));
 
 	config.set("GENERAL", "PresetTransitionDuration", _preset_transition_duration);
+	config.set("GENERAL", "PresetTransitionCurve", _preset_transition_curve);
 
 	config.set("GENERAL", "UIBindSupport", _ui_bind_support);
 	config.set("GENERAL", "AuroraFeature", _aurora_feature);
@@ -1228,7 +1399,7 @@ void reshade::runtime::load_current_preset()
 			dup_effect.included_files = base_effect_it->included_files;
 			_effects.emplace_back(dup_effect);
 			aurora3_reload = true;
-			load_effect(dup_effect.source_file, ini_file::load_cache(_current_preset_path), _effects.size() - 1, 0, true, true);
+			load_effect(dup_effect.source_file, ini_file::load_cache(_current_preset_path), _effects.size() - 1, 0, true);
 		}
 
 	}
@@ -1362,13 +1533,9 @@ void reshade::runtime::load_current_preset()
 			return lhs_label < rhs_label;
 		});
 
-	// Compute times since the transition has started and how much is left till it should end
-	auto transition_time = std::chrono::duration_cast<std::chrono::microseconds>(_last_present_time - _last_preset_switching_time).count();
-	auto transition_ms_left = _preset_transition_duration - transition_time / 1000;
-	auto transition_ms_left_from_last_frame = transition_ms_left + std::chrono::duration_cast<std::chrono::microseconds>(_last_frame_duration).count() / 1000;
-
-	if (_is_in_preset_transition && transition_ms_left <= 0)
-		_is_in_preset_transition = false;
+	// Start values of the transition are whatever the uniforms currently hold, so resolve them again whenever the preset is reloaded
+	_preset_transition_values.clear();
+	_preset_transition_values_time = _last_present_time;
 
 	for (effect &effect : _effects)
 	{
@@ -1388,7 +1555,7 @@ void reshade::runtime::load_current_preset()
 		for (uniform &variable : effect.uniforms)
 		{
 			if (variable.special != special_uniform::none ||
-				variable.annotation_as_uint("nosave"))
+				variable.nosave)
 				continue;
 
 			if (variable.supports_toggle_key())
@@ -1422,18 +1589,27 @@ void reshade::runtime::load_current_preset()
 				set_uniform_value(variable, values.as_uint, variable.type.components());
 				break;
 			case reshadefx::type::t_float:
-				get_uniform_value(variable, values.as_float, variable.type.components());
-				values_old = values;
-				preset.get(real_name, variable.name, values.as_float);
 				if (_is_in_preset_transition)
 				{
-					// Perform smooth transition on floating point values
+					// Transition from the current value to the value the preset will have once the transition has finished (which is the default value if the preset does not contain it)
+					get_uniform_value(variable, values_old.as_float, variable.type.components());
+					if (variable.has_initializer_value)
+						std::copy_n((variable.type.is_array() ? variable.initializer_value.array_data[0] : variable.initializer_value).as_float, 16, values.as_float);
+					else
+						std::fill_n(values.as_float, 16, 0.0f);
+					preset.get(real_name, variable.name, values.as_float);
+
 					for (unsigned int i = 0; i < variable.type.components(); i++)
 					{
-						const float value_left = (values.as_float[i] - values_old.as_float[i]);
-						values.as_float[i] -= (value_left / transition_ms_left_from_last_frame) * transition_ms_left;
+						// Each row of a matrix is 16-byte aligned (see 'set_uniform_value_data')
+						const uint32_t offset = variable.offset + (variable.type.is_matrix() ? (i / variable.type.cols) * 4 + (i % variable.type.cols) : i) * 4;
+						_preset_transition_values.push_back({ static_cast<size_t>(&effect - _effects.data()), offset, values_old.as_float[i], values.as_float[i] });
 					}
+					break;
 				}
+
+				get_uniform_value(variable, values.as_float, variable.type.components());
+				preset.get(real_name, variable.name, values.as_float);
 				set_uniform_value(variable, values.as_float, variable.type.components());
 				break;
 			}
@@ -1446,7 +1622,7 @@ void reshade::runtime::load_current_preset()
 			+ build_postfix(_effects[tech.effect_index], _aurora_feature == 3 ? 3 : 0);
 
 		// Ignore preset if "enabled" annotation is set
-		if (tech.annotation_as_int("enabled") ||
+		if (tech.force_enabled ||
 			std::find(technique_list.cbegin(), technique_list.cend(), unique_name) != technique_list.cend() ||
 			std::find(technique_list.cbegin(), technique_list.cend(), tech.name) != technique_list.cend())
 			enable_technique(tech);
@@ -1456,11 +1632,55 @@ void reshade::runtime::load_current_preset()
 		if (!preset.get({}, "Key" + unique_name, tech.toggle_key_data) &&
 			!preset.get({}, "Key" + tech.name + build_postfix(_effects[tech.effect_index], _aurora_feature), tech.toggle_key_data))
 			std::memset(tech.toggle_key_data, 0, sizeof(tech.toggle_key_data));
+
+		if (!preset.get({}, "UpdateRate" + unique_name, tech.update_rate))
+			tech.update_rate = tech.annotation_as_uint("update_rate", 0, 1);
+		tech.update_rate = std::max(tech.update_rate, 1u);
 	}
 
 	// Reverse queue so that effects are enabled in the order they are defined in the preset (since the queue is worked from back to front)
 	std::reverse(_reload_create_queue.begin(), _reload_create_queue.end());
 }
+void reshade::runtime::update_preset_transition()
+{
+	assert(_is_in_preset_transition);
+
+	// Resolve start and target values once at the beginning of the transition
+	if (_preset_transition_values_time < _last_preset_switching_time)
+		load_current_preset();
+
+	const std::chrono::high_resolution_clock::time_point transition_end_time = _last_preset_switching_time + std::chrono::milliseconds(_preset_transition_duration);
+	if (_last_present_time >= transition_end_time)
+	{
+		// Load the preset one final time without transition, so that all values end up exactly as if the preset was loaded directly
+		_is_in_preset_transition = false;
+		load_current_preset();
+		return;
+	}
+
+	// Values may have been resolved after the transition already started (e.g. after effects were reloaded), so interpolate over the time that was remaining at that point
+	float t = std::chrono::duration<float>(_last_present_time - _preset_transition_values_time) / std::chrono::duration<float>(transition_end_time - _preset_transition_values_time);
+	t = std::min(std::max(t, 0.0f), 1.0f);
+
+	switch (_preset_transition_curve)
+	{
+	case 1:
+		t = t * t * (3.0f - 2.0f * t);
+		break;
+	case 2:
+		t = 1.0f - (1.0f - t) * (1.0f - t);
+		break;
+	}
+
+	for (const preset_transition_value &value : _preset_transition_values)
+	{
+		if (value.effect_index >= _effects.size() || value.offset + sizeof(float) > _effects[value.effect_index].uniform_data_storage.size())
+			continue;
+
+		const float result = value.from + (value.to - value.from) * t;
+		std::memcpy(_effects[value.effect_index].uniform_data_storage.data() + value.offset, &result, sizeof(result));
+	}
+}
 void reshade::runtime::save_current_preset(ini_file &preset) const
 {
 	// Build list of active techniques and effects
@@ -1482,7 +1702,7 @@ void reshade::runtime::save_current_preset(ini_file &preset) const
 	{
 		const technique &tech = _techniques[technique_index];
 
-		if (tech.annotation_as_uint("nosave"))
+		if (tech.nosave)
 			continue;
 
 		std::string unique_name = tech.name + '@' + _effects[tech.effect_index].source_file.filename().u8string()
@@ -1500,6 +1720,11 @@ void reshade::runtime::save_current_preset(ini_file &preset) const
 			preset.set({}, "Key" + unique_name, tech.toggle_key_data);
 		else
 			preset.remove_key({}, "Key" + unique_name);
+
+		if (tech.update_rate != std::max(tech.annotation_as_uint("update_rate", 0, 1), 1u))
+			preset.set({}, "UpdateRate" + unique_name, tech.update_rate);
+		else
+			preset.remove_key({}, "UpdateRate" + unique_name);
 	}
 
 	if (preset.has({}, "TechniqueSorting") || !std::equal(technique_list.cbegin(), technique_list.cend(), sorted_technique_list.cbegin())
@@ -1576,7 +1801,7 @@ void reshade::runtime::save_current_preset(ini_file &preset) const
 		for (const uniform &variable : effect.uniforms)
 		{
 			if (variable.special != special_uniform::none ||
-				variable.annotation_as_uint("nosave"))
+				variable.nosave)
 				continue;
 
 			if (variable.supports_toggle_key())
@@ -1637,7 +1862,7 @@ void reshade::runtime::aurora4_clean_preset(ini_file &preset)
 	{
 		const technique &tech = _techniques[technique_index];
 
-		if (tech.annotation_as_uint("nosave"))
+		if (tech.nosave)
 			continue;
 
 		const std::string unique_name = tech.name + '@' + _effects[tech.effect_index].source_file.filename().u8string();
@@ -1758,14 +1983,17 @@ bool reshade::runtime::switch_to_next_preset(std::filesystem::path filter_path,
 	size_t current_preset_index = std::numeric_limits<size_t>::max();
 	std::vector<std::filesystem::path> preset_paths;
 
-	for (std::filesystem::path preset_path : std::filesystem::directory_iterator(filter_path, std::filesystem::directory_options::skip_permission_denied, ec))
+	// Use the preset catalog rather than loading every file in the directory to check whether it is a preset
+	for (preset_catalog::entry &entry : _preset_catalog.scan(filter_path))
 	{
 		// Skip anything that is not a valid preset file
-		if (!resolve_preset_path(preset_path, ec))
+		if (!entry.valid)
 			continue;
 
+		std::filesystem::path &preset_path = entry.path;
+
 		// Keep track of the index of the current preset in the list of found preset files that is being build
-		if (std::filesystem::equivalent(preset_path, _current_preset_path, ec))
+		if (preset_path == _current_preset_path || std::filesystem::equivalent(preset_path, _current_preset_path, ec))
 		{
 			current_preset_index = preset_paths.size();
 			preset_paths.push_back(std::move(preset_path));
@@ -1949,6 +2177,20 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		effect.permutations.resize(permutation_index + 1);
 	effect::permutation &permutation = effect.permutations[permutation_index];
 
+	// Wrap cache access, so that the time spent on it shows up in the load timings
+	const auto load_cache = [this, &effect, permutation_index](const std::string &id, const std::string &type, std::string &data) {
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+		const bool result = load_effect_cache(id, type, data);
+		record_load_timing(effect, effect_load_phase::cache_io, permutation_index, time_started);
+		return result;
+	};
+	const auto save_cache = [this, &effect, permutation_index](const std::string &id, const std::string &type, const std::string &data) {
+		const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+		const bool result = save_effect_cache(id, type, data);
+		record_load_timing(effect, effect_load_phase::cache_io, permutation_index, time_started);
+		return result;
+	};
+
 	bool preprocessed = effect.preprocessed && permutation_index == 0;
 	bool compiled = effect.compiled && permutation_index == 0;
 	bool source_cached = false;
@@ -1957,8 +2199,52 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	std::string source;
 	std::string errors;
 
-	if (!preprocessed && (preprocess_required || (source_cached = load_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source)) == false))
+	// Effects are often reloaded with one of only a few different sets of preprocessor definitions (e.g. when switching between presets), so check whether this one was compiled recently and is still in memory
+	// Explicit reloads require preprocessing, since changes to included files outside the search paths would not be reflected in the source hash
+	const size_t variant_hash = source_hash ^ std::hash<std::string>()(std::to_string(_renderer_id) + (_no_debug_info ? "" : ";debug_info"));
+	std::shared_ptr<const compiled_effect_variant> variant;
+	std::shared_ptr<const compiled_effect_variant> compiled_variant;
+	if (!preprocessed && !preprocess_required)
+	{
+		// Duplicates of an effect compile to the exact same thing as the effect they were duplicated from (unless bound preprocessor definitions differ, which is reflected in the source hash), so share its compilation result
+		// Only look at what base effects published after they finished loading, since they may still be loading on other threads right now
+		if (permutation_index == 0 && !effect.dup_id.empty())
+		{
+			const std::shared_lock<std::shared_mutex> lock(_reload_mutex);
+
+			if (const auto it = _duplicate_effect_variants.find(variant_hash);
+				it != _duplicate_effect_variants.end())
+				variant = it->second;
+		}
+
+		if (variant == nullptr && _effect_variant_cache_size != 0)
+			variant = find_effect_variant(variant_hash);
+	}
+
+	if (variant != nullptr)
+	{
+		preprocessed = true;
+		skip_optimization = variant->skip_optimization;
+		code_preamble = variant->code_preamble;
+		errors = variant->errors;
+
+		permutation.source_hash = variant->source_hash;
+
+		if (permutation_index == 0)
+		{
+			effect.definitions = variant->definitions;
+			effect.included_files = variant->included_files;
+			compiled_variant = variant;
+		}
+	}
+
+	if (!preprocessed && !preprocess_required)
+		source_cached = load_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
+
+	if (!preprocessed && !source_cached)
 	{
+		const std::chrono::high_resolution_clock::time_point time_preprocess_started = std::chrono::high_resolution_clock::now();
+
 		reshadefx::preprocessor pp;
 		pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
 		pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", _performance_mode ? "1" : "0");
@@ -2008,6 +2294,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		// Load and preprocess the source file
 		preprocessed = pp.append_file(source_file);
 
+		record_load_timing(effect, effect_load_phase::preprocess, permutation_index, time_preprocess_started);
+
 		// Append preprocessor errors to the error list
 		errors += pp.errors();
 
@@ -2066,7 +2354,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 			// Do not cache if any special pragma directives were used, to ensure they are read again next time
 			if (!skip_optimization)
-				source_cached = save_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
+				source_cached = save_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
 		}
 
 		if (permutation_index == 0)
@@ -2112,46 +2400,98 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		}
 	}
 
-	std::unique_ptr<reshadefx::codegen> codegen;
 	if (!compiled && !source.empty())
 	{
-		unsigned shader_model;
-		if (_renderer_id == 0x9000)
-			shader_model = 30; // D3D9
-		else if (_renderer_id < 0xa100)
-			shader_model = 40; // D3D10 (including feature level 9)
-		else if (_renderer_id < 0xb000)
-			shader_model = 41; // D3D10.1
-		else if (_renderer_id < 0xc000)
-			shader_model = 50; // D3D11
+		permutation.source_hash = std::hash<std::string>()(source);
+
+		// Permutations often only differ in macros that the effect does not actually use (e.g. the color space), in which case the preprocessed source is identical to that of the first permutation and everything it compiled to can be reused
+		if (permutation_index != 0)
+		{
+			const effect::permutation &base_permutation = effect.permutations[0];
+
+			if (permutation.source_hash == base_permutation.source_hash &&
+				// D3D9 shaders have the buffer dimensions embedded, so cannot share them between permutations with different dimensions
+				(_renderer_id != 0x9000 || (_effect_permutations[permutation_index].width == _effect_permutations[0].width && _effect_permutations[permutation_index].height == _effect_permutations[0].height)) &&
+				base_permutation.assembly.size() == base_permutation.module.entry_points.size() &&
+				std::all_of(base_permutation.assembly.begin(), base_permutation.assembly.end(),
+					[](const std::pair<const std::string, std::string> &assembly) { return !assembly.second.empty(); }))
+			{
+				permutation.module = base_permutation.module;
+				permutation.generated_code = base_permutation.generated_code;
+				permutation.assembly = base_permutation.assembly;
+				permutation.assembly_text = base_permutation.assembly_text;
+				permutation.assembly_hashes = base_permutation.assembly_hashes;
+
+				compiled = true;
+			}
+		}
+	}
+
+	std::unique_ptr<reshadefx::codegen> codegen;
+	size_t variant_code_preamble_size = 0;
+	size_t variant_errors_size = 0;
+	if (!compiled && (!source.empty() || variant != nullptr))
+	{
+		if (variant != nullptr)
+		{
+			permutation.module = variant->module;
+			permutation.generated_code = variant->generated_code;
+
+			compiled = true;
+		}
 		else
-			shader_model = 51; // D3D12
+		{
+			unsigned shader_model;
+			if (_renderer_id == 0x9000)
+				shader_model = 30; // D3D9
+			else if (_renderer_id < 0xa100)
+				shader_model = 40; // D3D10 (including feature level 9)
+			else if (_renderer_id < 0xb000)
+				shader_model = 41; // D3D10.1
+			else if (_renderer_id < 0xc000)
+				shader_model = 50; // D3D11
+			else
+				shader_model = 51; // D3D12
+
+			if ((_renderer_id & 0xF0000) == 0)
+				codegen.reset(reshadefx::create_codegen_hlsl(shader_model, !_no_debug_info, _performance_mode));
+			else if (_renderer_id < 0x20000)
+				codegen.reset(reshadefx::create_codegen_glsl(false, !_no_debug_info, _performance_mode, false, true));
+			else // Vulkan uses SPIR-V input
+				codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false, !skip_optimization));
+
+			reshadefx::parser parser;
 
-		if ((_renderer_id & 0xF0000) == 0)
-			codegen.reset(reshadefx::create_codegen_hlsl(shader_model, !_no_debug_info, _performance_mode));
-		else if (_renderer_id < 0x20000)
-			codegen.reset(reshadefx::create_codegen_glsl(false, !_no_debug_info, _performance_mode, false, true));
-		else // Vulkan uses SPIR-V input
-			codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false));
+			const std::chrono::high_resolution_clock::time_point time_parse_started = std::chrono::high_resolution_clock::now();
 
-		reshadefx::parser parser;
+			// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
+			compiled = parser.parse(std::move(source), codegen.get());
 
-		// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
-		compiled = parser.parse(std::move(source), codegen.get());
+			record_load_timing(effect, effect_load_phase::parse, permutation_index, time_parse_started);
 
-		// Append parser errors to the error list
-		errors += parser.errors();
+			// Append parser errors to the error list
+			errors += parser.errors();
+
+			// Write result to effect module
+			permutation.module = codegen->module();
+			if (_device->get_api() != api::device_api::vulkan)
+			{
+				const std::chrono::high_resolution_clock::time_point time_codegen_started = std::chrono::high_resolution_clock::now();
+				permutation.generated_code = codegen->finalize_code();
+				record_load_timing(effect, effect_load_phase::codegen, permutation_index, time_codegen_started);
+			}
+		}
 
-		// Write result to effect module
-		permutation.module = codegen->module();
-		if (_device->get_api() != api::device_api::vulkan)
-			permutation.generated_code = codegen->finalize_code();
+		// Remember what the effect looked like before the specialization constants below are filled in, since those are specific to the current preset
+		variant_code_preamble_size = code_preamble.size();
+		variant_errors_size = errors.size();
 
 		if (compiled)
 		{
 			if (permutation_index == 0)
 			{
 				effect.uniforms.clear();
+				effect.special_uniform_updates.clear();
 
 				// Create space for all variables (aligned to 16 bytes)
 				effect.uniform_data_storage.resize((permutation.module.total_uniform_size + 15) & ~15);
@@ -2201,6 +2541,57 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 					effect.uniforms.push_back(std::move(variable));
 				}
+
+				for (size_t uniform_index = 0; uniform_index < effect.uniforms.size(); ++uniform_index)
+				{
+					const uniform &variable = effect.uniforms[uniform_index];
+
+					if (variable.special == special_uniform::none || variable.special == special_uniform::unknown)
+						continue;
+
+					effect::special_uniform_update &update = effect.special_uniform_updates.emplace_back();
+					update.special = variable.special;
+					update.uniform_index = uniform_index;
+					update.offset = variable.offset;
+					update.components = std::min(variable.type.components(), variable.size / 4);
+					// All uniform variables are floating-point in D3D9 (see 'force_floating_point_value' below)
+					update.floating_point = variable.type.is_floating_point() || _renderer_id == 0x9000;
+					update.direct = !variable.type.is_array() && !variable.type.is_matrix();
+					update.key_mode = 0;
+					std::fill_n(update.int_params, 2, 0);
+					std::fill_n(update.float_params, 5, 0.0f);
+
+					switch (variable.special)
+					{
+					case special_uniform::random:
+						update.int_params[0] = variable.annotation_as_int("min", 0, 0);
+						update.int_params[1] = variable.annotation_as_int("max", 0, RAND_MAX);
+						break;
+					case special_uniform::ping_pong:
+						update.float_params[0] = variable.annotation_as_float("min", 0, 0.0f);
+						update.float_params[1] = variable.annotation_as_float("max", 0, 1.0f);
+						update.float_params[2] = variable.annotation_as_float("step", 0);
+						update.float_params[3] = variable.annotation_as_float("step", 1);
+						update.float_params[4] = variable.annotation_as_float("smoothing");
+						break;
+					case special_uniform::key:
+					case special_uniform::mouse_button:
+						update.int_params[0] = variable.annotation_as_int("keycode");
+						if (const std::string_view mode = variable.annotation_as_string("mode");
+							mode == "toggle" || variable.annotation_as_int("toggle"))
+							update.key_mode = 2;
+						else if (mode == "press")
+							update.key_mode = 1;
+						break;
+					case special_uniform::mouse_wheel:
+						update.float_params[0] = variable.annotation_as_float("min");
+						update.float_params[1] = variable.annotation_as_float("max");
+						update.float_params[2] = variable.annotation_as_float("step");
+						if (update.float_params[2] == 0.0f)
+							update.float_params[2] = 1.0f;
+						break;
+					}
+				}
 			}
 			else
 			{
@@ -2322,6 +2713,18 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		}
 	}
 
+	std::unordered_map<std::string, std::string> entry_point_code;
+	const auto finalize_code_for_entry_point = [&](const std::string &entry_point_name) -> const std::string & {
+		if (variant != nullptr)
+			return variant->entry_point_code.at(entry_point_name);
+
+		const std::chrono::high_resolution_clock::time_point time_codegen_started = std::chrono::high_resolution_clock::now();
+		std::string &code = entry_point_code[entry_point_name];
+		code = codegen->finalize_code_for_entry_point(entry_point_name);
+		record_load_timing(effect, effect_load_phase::codegen, permutation_index, time_codegen_started);
+		return code;
+	};
+
 	if (compiled && (preprocessed || source_cached))
 	{
 		if (permutation.assembly.empty())
@@ -2367,7 +2770,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					}
 
 					hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
-					hlsl += codegen->finalize_code_for_entry_point(entry_point.first);
+
+					hlsl += finalize_code_for_entry_point(entry_point.first);
 
 					std::string profile;
 					switch (entry_point.second)
@@ -2423,15 +2827,46 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					hlsl_attributes += "profile=" + profile + ';';
 					hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
 
+					const size_t assembly_hash = std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl);
+					permutation.assembly_hashes[entry_point.first] = assembly_hash;
+
+					// Share compiled shaders with the first permutation if the compiler input is identical (e.g. when only the dimensions of textures differ)
+					if (permutation_index != 0)
+					{
+						const effect::permutation &base_permutation = effect.permutations[0];
+
+						if (const auto it = base_permutation.assembly_hashes.find(entry_point.first);
+							it != base_permutation.assembly_hashes.end() && it->second == assembly_hash && !base_permutation.assembly.at(entry_point.first).empty())
+						{
+							cso = base_permutation.assembly.at(entry_point.first);
+							cso_text = base_permutation.assembly_text.at(entry_point.first);
+							continue;
+						}
+					}
+
+					// Same for the compiled variant this was restored from (compiler input only differs if specialization constants changed)
+					if (variant != nullptr)
+					{
+						if (const auto it = variant->assembly_hashes.find(entry_point.first);
+							it != variant->assembly_hashes.end() && it->second == assembly_hash)
+						{
+							cso = variant->assembly.at(entry_point.first);
+							cso_text = variant->assembly_text.at(entry_point.first);
+							continue;
+						}
+					}
+
 					const std::string cache_id =
 						effect.source_file.stem().u8string() + '-' + entry_point.first + '-' + std::to_string(_renderer_id) + '-' +
-						std::to_string(std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl));
+						std::to_string(assembly_hash);
 
-					if (!load_effect_cache(cache_id, "cso", cso))
+					if (!load_cache(cache_id, "cso", cso))
 					{
 						const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DCompile"));
 						assert(D3DCompile != nullptr);
 
+						const std::chrono::high_resolution_clock::time_point time_compile_started = std::chrono::high_resolution_clock::now();
+
 						com_ptr<ID3DBlob> d3d_compiled, d3d_errors;
 						const HRESULT hr = D3DCompile(
 							hlsl.data(), hlsl.size(),
@@ -2441,6 +2876,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 							compile_flags, 0,
 							&d3d_compiled, &d3d_errors);
 
+						record_load_timing(effect, effect_load_phase::compile, permutation_index, time_compile_started);
+
 						std::string d3d_errors_string;
 						if (d3d_errors != nullptr) // Append warnings to the output error string as well
 							d3d_errors_string.assign(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
@@ -2489,24 +2926,28 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 						cso.resize(d3d_compiled->GetBufferSize());
 						std::memcpy(cso.data(), d3d_compiled->GetBufferPointer(), cso.size());
 
-						save_effect_cache(cache_id, "cso", cso);
+						save_cache(cache_id, "cso", cso);
 					}
 
-					if (!load_effect_cache(cache_id, "asm", cso_text))
+					if (!load_cache(cache_id, "asm", cso_text))
 					{
 						const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DDisassemble"));
 						assert(D3DDisassemble != nullptr);
 
+						const std::chrono::high_resolution_clock::time_point time_compile_started = std::chrono::high_resolution_clock::now();
+
 						com_ptr<ID3DBlob> d3d_disassembled;
 						if (SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
 							cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
 
-						save_effect_cache(cache_id, "asm", cso_text);
+						record_load_timing(effect, effect_load_phase::compile, permutation_index, time_compile_started);
+
+						save_cache(cache_id, "asm", cso_text);
 					}
 				}
 				else
 				{
-					cso = codegen->finalize_code_for_entry_point(entry_point.first);
+					cso = finalize_code_for_entry_point(entry_point.first);
 
 					if (_renderer_id < 0x20000)
 					{
@@ -2518,11 +2959,43 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			}
 		}
 
-		const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+		// Keep the result in memory, so that switching back to this set of preprocessor definitions later is quick (only for the first permutation, since the others do not track definitions and included files)
+		// Duplicated effects share it too, so keep it around whenever duplication is possible, even if the cache is disabled
+		if (compiled && codegen != nullptr && permutation_index == 0 && (_effect_variant_cache_size != 0 || _aurora_feature == 3))
+		{
+			std::shared_ptr<compiled_effect_variant> new_variant = std::make_shared<compiled_effect_variant>();
+			new_variant->source_hash = permutation.source_hash;
+			new_variant->skip_optimization = skip_optimization;
+			new_variant->code_preamble = code_preamble.substr(0, variant_code_preamble_size);
+			new_variant->errors = errors.substr(0, variant_errors_size);
+			new_variant->definitions = effect.definitions;
+			new_variant->included_files = effect.included_files;
+			new_variant->module = codegen->module();
+			new_variant->generated_code = permutation.generated_code;
+			new_variant->entry_point_code = std::move(entry_point_code);
+			// Entry points whose compiled shaders were shared with the first permutation did not need code generated for them yet
+			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : new_variant->module.entry_points)
+				if (new_variant->entry_point_code.find(entry_point.first) == new_variant->entry_point_code.end())
+					new_variant->entry_point_code[entry_point.first] = codegen->finalize_code_for_entry_point(entry_point.first);
+			new_variant->assembly = permutation.assembly;
+			new_variant->assembly_text = permutation.assembly_text;
+			new_variant->assembly_hashes = permutation.assembly_hashes;
+
+			compiled_variant = new_variant;
+			if (_effect_variant_cache_size != 0)
+				add_effect_variant(variant_hash, std::move(new_variant));
+		}
+
+		std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+
+		// Publish the compilation result for duplicates of this effect only now that it is complete
+		if (compiled_variant != nullptr && effect.dup_id.empty() && _aurora_feature == 3)
+			_duplicate_effect_variants[variant_hash] = std::move(compiled_variant);
 
 		for (texture new_texture : permutation.module.textures)
 		{
 			new_texture.effect_index = effect_index;
+			new_texture.transient = new_texture.semantic.empty() && new_texture.render_target && is_transient_texture(permutation.module, new_texture.unique_name);
 
 			if (!new_texture.semantic.empty() && (new_texture.render_target || new_texture.storage_access))
 			{
@@ -2578,15 +3051,19 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 				// Update render target and storage access flags of the existing shared texture, in case they are used as such in this effect
 				existing_texture->render_target |= new_texture.render_target;
 				existing_texture->storage_access |= new_texture.storage_access;
+				// Stop aliasing other textures with this one if this effect depends on its contents (effects that are aliased with it already are reloaded in 'unalias_persistent_textures')
+				existing_texture->transient &= new_texture.transient;
 				continue;
 			}
 
-			if (new_texture.annotation_as_int("pooled") && new_texture.semantic.empty())
+			// Textures explicitly marked as pooled, as well as transient ones (whose lifetime is limited to the execution of a single technique), can share memory with others of the same description
+			if (const bool pooled = new_texture.pooled;
+				(pooled || new_texture.transient) && new_texture.semantic.empty())
 			{
 				// Try to find another pooled texture to share with (and do not share within the same effect)
 				if (const auto existing_texture = std::find_if(_textures.begin(), _textures.end(),
-						[&new_texture](const texture &item) {
-							return item.annotation_as_int("pooled") && std::find(item.shared.begin(), item.shared.end(), new_texture.effect_index) == item.shared.end() && item.matches_description(new_texture);
+						[&new_texture, pooled](const texture &item) {
+							return (pooled ? item.pooled : item.transient) && std::find(item.shared.begin(), item.shared.end(), new_texture.effect_index) == item.shared.end() && item.matches_description(new_texture);
 						});
 					existing_texture != _textures.end())
 				{
@@ -2614,6 +3091,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 					if (std::find(existing_texture->shared.cbegin(), existing_texture->shared.cend(), effect_index) == existing_texture->shared.cend())
 						existing_texture->shared.push_back(effect_index);
+					if (!pooled && std::find(existing_texture->aliased.cbegin(), existing_texture->aliased.cend(), effect_index) == existing_texture->aliased.cend())
+						existing_texture->aliased.push_back(effect_index);
 
 					existing_texture->render_target = true;
 					existing_texture->storage_access = true;
@@ -2641,6 +3120,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 				// Merge annotations
 				existing_technique->annotations.insert(existing_technique->annotations.end(), tech.annotations.begin(), tech.annotations.end());
+				existing_technique->update_annotations();
 				continue;
 			}
 
@@ -2649,20 +3129,47 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			new_technique.effect_index = effect_index;
 
 			new_technique.annotations = tech.annotations; // Do not 'std::move', since technique may be recreated on a reload that only preprocesses and copy this again
+			new_technique.update_annotations();
 
 			new_technique.hidden = new_technique.annotation_as_int("hidden") != 0;
-			new_technique.enabled_in_screenshot = new_technique.annotation_as_int("enabled_in_screenshot", 0, true) != 0;
 
 			// Make space for all permutations in case this technique only exists in a specific one
 			new_technique.permutations.resize(permutation_index + 1);
 			new_technique.permutations[permutation_index].passes.assign(tech.passes.begin(), tech.passes.end());
 
-			if (permutation_index == 0 && new_technique.annotation_as_int("enabled"))
+			if (permutation_index == 0 && new_technique.force_enabled)
 				enable_technique(new_technique);
 
 			_techniques.push_back(std::move(new_technique));
 			_technique_sorting.push_back(_techniques.size() - 1);
 		}
+
+		// Create pipelines on this loading thread already where the device supports creating them from any thread, so that 'create_effect' on the render thread only has to hand them out
+		// Only do so for effects the preset is going to enable (see 'load_current_preset'), the others get their pipelines created on demand in 'create_effect' once one of their techniques is enabled
+		const api::device_api device_api = _device->get_api();
+		bool create_pipelines = compiled && (device_api == api::device_api::d3d11 || device_api == api::device_api::d3d12 || device_api == api::device_api::vulkan);
+		if (create_pipelines && permutation_index == 0)
+		{
+			std::vector<std::string> technique_list;
+			preset.get({}, "Techniques", technique_list);
+
+			create_pipelines = std::any_of(_techniques.cbegin(), _techniques.cend(),
+				[effect_index, &technique_list, &effect_name](const technique &tech) {
+					return tech.effect_index == effect_index && (tech.force_enabled || std::any_of(technique_list.cbegin(), technique_list.cend(),
+						[&tech, &effect_name](const std::string &technique) {
+							const size_t at_pos = technique.find('@');
+							return technique.compare(0, at_pos, tech.name) == 0 && (at_pos == std::string::npos || technique.compare(at_pos + 1, effect_name.size(), effect_name) == 0);
+						}));
+				});
+		}
+
+		lock.unlock();
+
+		if (create_pipelines && permutation.layout == 0 && !create_effect_pipelines(effect_index, permutation_index))
+		{
+			errors += "error: internal compiler error\n";
+			compiled = false;
+		}
 	}
 
 	effect.compiled = compiled;
@@ -2706,6 +3213,8 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 
 	effect::permutation &permutation = effect.permutations[permutation_index];
 
+	const std::chrono::high_resolution_clock::time_point time_texture_creation_started = std::chrono::high_resolution_clock::now();
+
 	// Create textures now, since they are referenced when building samplers below
 	for (texture &tex : _textures)
 	{
@@ -2719,14 +3228,13 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 		}
 	}
 
-	// Build specialization constants
-	std::vector<uint32_t> spec_data;
-	std::vector<uint32_t> spec_constants;
-	for (const reshadefx::uniform &spec_constant : permutation.module.spec_constants)
+	record_load_timing(effect, effect_load_phase::texture_load, permutation_index, time_texture_creation_started);
+
+	// Pipelines are usually created on the loading thread already (see 'load_effect'), so only need to create them here for effects where that was not done
+	if (permutation.layout == 0 && !create_effect_pipelines(effect_index, permutation_index))
 	{
-		uint32_t id = static_cast<uint32_t>(spec_constants.size());
-		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
-		spec_constants.push_back(id);
+		effect.errors += "error: internal compiler error";
+		return false;
 	}
 
 	// Create optional query heap for time measurements
@@ -2739,58 +3247,17 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	// Initialize bindings
 	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
 
-	api::descriptor_range cb_range;
-	cb_range.binding = 0;
-	cb_range.dx_register_index = 0; // b0 (global constant buffer)
-	cb_range.dx_register_space = 0;
-	cb_range.count = 1;
-	cb_range.array_size = 1;
-	cb_range.type = api::descriptor_type::constant_buffer;
-	cb_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
-
-	api::descriptor_range sampler_range;
-	sampler_range.binding = 0;
-	sampler_range.dx_register_index = 0; // s#
-	sampler_range.dx_register_space = 0;
-	sampler_range.count = 0;
-	sampler_range.array_size = 1;
-	sampler_range.type = sampler_with_resource_view ? api::descriptor_type::sampler_with_resource_view : api::descriptor_type::sampler;
-	sampler_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
-
-	api::descriptor_range srv_range;
-	srv_range.binding = 0;
-	srv_range.dx_register_index = 0; // t#
-	srv_range.dx_register_space = 0;
-	srv_range.count = 0;
-	srv_range.array_size = 1;
-	srv_range.type = api::descriptor_type::shader_resource_view;
-	srv_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
-
-	api::descriptor_range uav_range;
-	uav_range.binding = 0;
-	uav_range.dx_register_index = 0; // u#
-	uav_range.dx_register_space = 0;
-	uav_range.count = 0;
-	uav_range.array_size = 1;
-	uav_range.type = api::descriptor_type::unordered_access_view;
-	uav_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
+	api::descriptor_range ranges[4];
+	get_effect_descriptor_ranges(permutation.module, sampler_with_resource_view, ranges);
+	const api::descriptor_range &cb_range = ranges[0];
+	const api::descriptor_range &sampler_range = ranges[1];
+	const api::descriptor_range &srv_range = ranges[2];
+	const api::descriptor_range &uav_range = ranges[3];
 
 	size_t total_pass_count = 0;
 	for (const reshadefx::technique &tech : permutation.module.techniques)
-	{
 		total_pass_count += tech.passes.size();
 
-		for (const reshadefx::pass &pass : tech.passes)
-		{
-			for (const reshadefx::sampler_binding &binding : pass.sampler_bindings)
-				sampler_range.count = std::max(sampler_range.count, binding.entry_point_binding + 1);
-			for (const reshadefx::texture_binding &binding : pass.texture_bindings)
-				srv_range.count = std::max(srv_range.count, binding.entry_point_binding + 1);
-			for (const reshadefx::storage_binding &binding : pass.storage_bindings)
-				uav_range.count = std::max(uav_range.count, binding.entry_point_binding + 1);
-		}
-	}
-
 	std::vector<api::descriptor_table_update> descriptor_writes;
 	descriptor_writes.reserve(
 		static_cast<size_t>(cb_range.count) +
@@ -2805,40 +3272,6 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	std::vector<api::sampler_with_resource_view> sampler_descriptors;
 	sampler_descriptors.resize(std::max(sampler_range.count, srv_range.count) * total_pass_count);
 
-	// Create pipeline layout for this effect
-	{
-		api::pipeline_layout_param layout_params[4];
-		layout_params[0].type = api::pipeline_layout_param_type::descriptor_table;
-		layout_params[0].descriptor_table.count = 1;
-		layout_params[0].descriptor_table.ranges = &cb_range;
-
-		layout_params[1].type = api::pipeline_layout_param_type::descriptor_table;
-		layout_params[1].descriptor_table.count = 1;
-		layout_params[1].descriptor_table.ranges = &sampler_range;
-
-		layout_params[2].type = api::pipeline_layout_param_type::descriptor_table;
-		layout_params[2].descriptor_table.count = 1;
-
-		layout_params[3].type = api::pipeline_layout_param_type::descriptor_table;
-		layout_params[3].descriptor_table.count = 1;
-
-		if (sampler_with_resource_view)
-		{
-			layout_params[2].descriptor_table.ranges = &uav_range;
-		}
-		else
-		{
-			layout_params[2].descriptor_table.ranges = &srv_range;
-			layout_params[3].descriptor_table.ranges = &uav_range;
-		}
-
-		if (!_device->create_pipeline_layout(sampler_with_resource_view ? 3 : 4, layout_params, &permutation.layout))
-		{
-			log::message(log::level::error, "Failed to create pipeline layout for effect file '%s'!", effect.source_file.u8string().c_str());
-			return false;
-		}
-	}
-
 	// Create global constant buffer (except in D3D9, which does not have constant buffers)
 	api::buffer_range cb_buffer_range = {};
 	if (_renderer_id != 0x9000 && !effect.uniform_data_storage.empty())
@@ -2924,86 +3357,22 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			pass.texture_table = shader_resource_view_tables[pass_index_in_effect];
 			pass.storage_table = unordered_access_view_tables[pass_index_in_effect];
 
-			std::vector<api::pipeline_subobject> subobjects;
+			assert(pass.pipeline != 0);
 
-			if (!pass.cs_entry_point.empty())
+			if (pass.cs_entry_point.empty())
 			{
-				api::shader_desc cs_desc = {};
-				const std::string &cs = permutation.assembly.at(pass.cs_entry_point);
-				cs_desc.code = cs.data();
-				cs_desc.code_size = cs.size();
-				if (_renderer_id & 0x20000)
-				{
-					cs_desc.entry_point = pass.cs_entry_point.c_str();
-					cs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-					cs_desc.spec_constant_ids = spec_constants.data();
-					cs_desc.spec_constant_values = spec_data.data();
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::compute_shader, 1, &cs_desc });
-
-				if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
-				{
-					effect.errors += "error: internal compiler error";
-
-					log::message(log::level::error, "Failed to create compute pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
-					return false;
-				}
-			}
-			else
-			{
-				api::shader_desc vs_desc = {};
-				if (!pass.vs_entry_point.empty())
-				{
-					const std::string &vs = permutation.assembly.at(pass.vs_entry_point);
-					vs_desc.code = vs.data();
-					vs_desc.code_size = vs.size();
-					if (_renderer_id & 0x20000)
-					{
-						vs_desc.entry_point = pass.vs_entry_point.c_str();
-						vs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-						vs_desc.spec_constant_ids = spec_constants.data();
-						vs_desc.spec_constant_values = spec_data.data();
-					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::vertex_shader, 1, &vs_desc });
-				}
-
-				api::shader_desc ps_desc = {};
-				if (!pass.ps_entry_point.empty())
-				{
-					const std::string &ps = permutation.assembly.at(pass.ps_entry_point);
-					ps_desc.code = ps.data();
-					ps_desc.code_size = ps.size();
-					if (_renderer_id & 0x20000)
-					{
-						ps_desc.entry_point = pass.ps_entry_point.c_str();
-						ps_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
-						ps_desc.spec_constant_ids = spec_constants.data();
-						ps_desc.spec_constant_values = spec_data.data();
-					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::pixel_shader, 1, &ps_desc });
-				}
-
-				api::format render_target_formats[8] = {};
-
 				if (pass.render_target_names[0].empty())
 				{
+					pass.writes_back_buffer = true;
 					pass.viewport_width = _effect_permutations[permutation_index].width;
 					pass.viewport_height = _effect_permutations[permutation_index].height;
-
-					render_target_formats[0] = api::format_to_default_typed(_effect_permutations[permutation_index].color_format, pass.srgb_write_enable);
-
-					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, 1, &render_target_formats[0] });
 				}
 				else
 				{
-					int render_target_count = 0;
-					for (; render_target_count < 8 && !pass.render_target_names[render_target_count].empty(); ++render_target_count)
+					for (int render_target_index = 0; render_target_index < 8 && !pass.render_target_names[render_target_index].empty(); ++render_target_index)
 					{
 						const auto render_target_texture = std::find_if(_textures.cbegin(), _textures.cend(),
-							[&unique_name = pass.render_target_names[render_target_count]](const texture &item) {
+							[&unique_name = pass.render_target_names[render_target_index]](const texture &item) {
 								return item.unique_name == unique_name && (item.resource != 0 || !item.semantic.empty());
 							});
 						assert(render_target_texture != _textures.cend());
@@ -3017,131 +3386,8 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 								pass.generate_mipmap_views.push_back(render_target_texture->srv[0]);
 						}
 
-						const api::resource_desc res_desc = _device->get_resource_desc(render_target_texture->resource);
-
-						render_target_formats[render_target_count] = api::format_to_default_typed(res_desc.texture.format, pass.srgb_write_enable);
-
-						pass.render_target_views[render_target_count] = render_target_texture->rtv[pass.srgb_write_enable];
-					}
-
-					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, static_cast<uint32_t>(render_target_count), render_target_formats });
-				}
-
-				// Only need to attach stencil if stencil is actually used in this pass
-				if (pass.stencil_enable &&
-					pass.viewport_width == _effect_permutations[permutation_index].width &&
-					pass.viewport_height == _effect_permutations[permutation_index].height)
-				{
-					subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_format, 1, &_effect_permutations[permutation_index].stencil_format });
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::max_vertex_count, 1, &pass.num_vertices });
-
-				api::primitive_topology topology = static_cast<api::primitive_topology>(pass.topology);
-				subobjects.push_back({ api::pipeline_subobject_type::primitive_topology, 1, &topology });
-
-				const auto convert_blend_op = [](reshadefx::blend_op value) {
-					switch (value)
-					{
-					default:
-					case reshadefx::blend_op::add: return api::blend_op::add;
-					case reshadefx::blend_op::subtract: return api::blend_op::subtract;
-					case reshadefx::blend_op::reverse_subtract: return api::blend_op::reverse_subtract;
-					case reshadefx::blend_op::min: return api::blend_op::min;
-					case reshadefx::blend_op::max: return api::blend_op::max;
-					}
-				};
-				const auto convert_blend_factor = [](reshadefx::blend_factor value) {
-					switch (value) {
-					case reshadefx::blend_factor::zero: return api::blend_factor::zero;
-					default:
-					case reshadefx::blend_factor::one: return api::blend_factor::one;
-					case reshadefx::blend_factor::source_color: return api::blend_factor::source_color;
-					case reshadefx::blend_factor::one_minus_source_color: return api::blend_factor::one_minus_source_color;
-					case reshadefx::blend_factor::dest_color: return api::blend_factor::dest_color;
-					case reshadefx::blend_factor::one_minus_dest_color: return api::blend_factor::one_minus_dest_color;
-					case reshadefx::blend_factor::source_alpha: return api::blend_factor::source_alpha;
-					case reshadefx::blend_factor::one_minus_source_alpha: return api::blend_factor::one_minus_source_alpha;
-					case reshadefx::blend_factor::dest_alpha: return api::blend_factor::dest_alpha;
-					case reshadefx::blend_factor::one_minus_dest_alpha: return api::blend_factor::one_minus_dest_alpha;
-					}
-				};
-
-				// Technically should check for 'api::device_caps::independent_blend' support, but render target write masks are supported in D3D9, when rest is not, so just always set ...
-				api::blend_desc blend_state = {};
-				for (int i = 0; i < 8; ++i)
-				{
-					blend_state.blend_enable[i] = pass.blend_enable[i];
-					blend_state.source_color_blend_factor[i] = convert_blend_factor(pass.source_color_blend_factor[i]);
-					blend_state.dest_color_blend_factor[i] = convert_blend_factor(pass.dest_color_blend_factor[i]);
-					blend_state.color_blend_op[i] = convert_blend_op(pass.color_blend_op[i]);
-					blend_state.source_alpha_blend_factor[i] = convert_blend_factor(pass.source_alpha_blend_factor[i]);
-					blend_state.dest_alpha_blend_factor[i] = convert_blend_factor(pass.dest_alpha_blend_factor[i]);
-					blend_state.alpha_blend_op[i] = convert_blend_op(pass.alpha_blend_op[i]);
-					blend_state.render_target_write_mask[i] = pass.render_target_write_mask[i];
-				}
-
-				subobjects.push_back({ api::pipeline_subobject_type::blend_state, 1, &blend_state });
-
-				api::rasterizer_desc rasterizer_state = {};
-				rasterizer_state.cull_mode = api::cull_mode::none;
-
-				subobjects.push_back({ api::pipeline_subobject_type::rasterizer_state, 1, &rasterizer_state });
-
-				const auto convert_stencil_op = [](reshadefx::stencil_op value) {
-					switch (value) {
-					case reshadefx::stencil_op::zero: return api::stencil_op::zero;
-					default:
-					case reshadefx::stencil_op::keep: return api::stencil_op::keep;
-					case reshadefx::stencil_op::replace: return api::stencil_op::replace;
-					case reshadefx::stencil_op::increment_saturate: return api::stencil_op::increment_saturate;
-					case reshadefx::stencil_op::decrement_saturate: return api::stencil_op::decrement_saturate;
-					case reshadefx::stencil_op::invert: return api::stencil_op::invert;
-					case reshadefx::stencil_op::increment: return api::stencil_op::increment;
-					case reshadefx::stencil_op::decrement: return api::stencil_op::decrement;
-					}
-				};
-				const auto convert_stencil_func = [](reshadefx::stencil_func value) {
-					switch (value)
-					{
-					case reshadefx::stencil_func::never: return api::compare_op::never;
-					case reshadefx::stencil_func::less: return api::compare_op::less;
-					case reshadefx::stencil_func::equal: return api::compare_op::equal;
-					case reshadefx::stencil_func::less_equal: return api::compare_op::less_equal;
-					case reshadefx::stencil_func::greater: return api::compare_op::greater;
-					case reshadefx::stencil_func::not_equal: return api::compare_op::not_equal;
-					case reshadefx::stencil_func::greater_equal: return api::compare_op::greater_equal;
-					default:
-					case reshadefx::stencil_func::always: return api::compare_op::always;
+						pass.render_target_views[render_target_index] = render_target_texture->rtv[pass.srgb_write_enable];
 					}
-				};
-
-				api::depth_stencil_desc depth_stencil_state = {};
-				depth_stencil_state.depth_enable = false;
-				depth_stencil_state.depth_write_mask = false;
-				depth_stencil_state.depth_func = api::compare_op::always;
-				depth_stencil_state.stencil_enable = pass.stencil_enable;
-				depth_stencil_state.front_stencil_read_mask = pass.stencil_read_mask;
-				depth_stencil_state.front_stencil_write_mask = pass.stencil_write_mask;
-				depth_stencil_state.front_stencil_func = convert_stencil_func(pass.stencil_comparison_func);
-				depth_stencil_state.front_stencil_fail_op = convert_stencil_op(pass.stencil_fail_op);
-				depth_stencil_state.front_stencil_depth_fail_op = convert_stencil_op(pass.stencil_depth_fail_op);
-				depth_stencil_state.front_stencil_pass_op = convert_stencil_op(pass.stencil_pass_op);
-				depth_stencil_state.back_stencil_read_mask = depth_stencil_state.front_stencil_read_mask;
-				depth_stencil_state.back_stencil_write_mask = depth_stencil_state.front_stencil_write_mask;
-				depth_stencil_state.back_stencil_func = depth_stencil_state.front_stencil_func;
-				depth_stencil_state.back_stencil_fail_op = depth_stencil_state.front_stencil_fail_op;
-				depth_stencil_state.back_stencil_depth_fail_op = depth_stencil_state.front_stencil_depth_fail_op;
-				depth_stencil_state.back_stencil_pass_op = depth_stencil_state.front_stencil_pass_op;
-
-				subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_state, 1, &depth_stencil_state });
-
-				if (!_device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pass.pipeline))
-				{
-					effect.errors += "error: internal compiler error";
-
-					log::message(log::level::error, "Failed to create graphics pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
-					return false;
 				}
 			}
 
@@ -3201,6 +3447,8 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 
 				if (!sampler_texture->semantic.empty())
 				{
+					pass.samples_semantic_texture = true;
+
 					if (sampler_texture->semantic == "COLOR")
 						srv = _effect_permutations[permutation_index].color_srv[info.srgb];
 					else if (const auto it = _texture_semantic_bindings.find(sampler_texture->semantic); it != _texture_semantic_bindings.end())
@@ -3208,6 +3456,10 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 					else
 						srv = _empty_srv;
 
+					// Add-ons may bind the back buffer copy to other semantics as well, so check the resolved view too
+					if (sampler_texture->semantic == "COLOR" || srv == _effect_permutations[permutation_index].color_srv[0] || srv == _effect_permutations[permutation_index].color_srv[1])
+						pass.reads_back_buffer = true;
+
 					// Keep track of the texture descriptor to simplify updating it
 					permutation.texture_semantic_to_binding.push_back({
 						sampler_texture->semantic,
@@ -3220,6 +3472,9 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				else
 				{
 					srv = sampler_texture->srv[info.srgb];
+
+					if (std::find(pass.sampled_resources.cbegin(), pass.sampled_resources.cend(), sampler_texture->resource) == pass.sampled_resources.cend())
+						pass.sampled_resources.push_back(sampler_texture->resource);
 				}
 
 				assert(srv != 0);
@@ -3251,7 +3506,25 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			}
 		}
 
-		tech.permutations[permutation_index].created = true;
+		technique::permutation &tech_permutation = tech.permutations[permutation_index];
+
+		tech_permutation.async_compute = !tech_permutation.passes.empty() && std::all_of(tech_permutation.passes.cbegin(), tech_permutation.passes.cend(),
+			[](const technique::pass &pass) { return !pass.cs_entry_point.empty() && !pass.samples_semantic_texture && pass.generate_mipmap_views.empty(); });
+
+		tech_permutation.accessed_resources.clear();
+		for (const technique::pass &pass : tech_permutation.passes)
+		{
+			for (const api::resource resource : pass.sampled_resources)
+				if (std::find(tech_permutation.accessed_resources.cbegin(), tech_permutation.accessed_resources.cend(), resource) == tech_permutation.accessed_resources.cend())
+					tech_permutation.accessed_resources.push_back(resource);
+			for (const api::resource resource : pass.modified_resources)
+				if (std::find(tech_permutation.accessed_resources.cbegin(), tech_permutation.accessed_resources.cend(), resource) == tech_permutation.accessed_resources.cend())
+					tech_permutation.accessed_resources.push_back(resource);
+		}
+
+		update_aliased_texture_flags(tech, permutation_index);
+
+		tech_permutation.created = true;
 	}
 
 	if (!descriptor_writes.empty())
@@ -3262,8 +3535,342 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 	permutation.assembly.clear();
 #endif
 
+	const std::chrono::high_resolution_clock::time_point time_texture_load_started = std::chrono::high_resolution_clock::now();
+
 	load_textures(effect_index);
 
+	record_load_timing(effect, effect_load_phase::texture_load, permutation_index, time_texture_load_started);
+
+	return true;
+}
+bool reshade::runtime::create_effect_pipelines(size_t effect_index, size_t permutation_index)
+{
+	effect &effect = _effects[effect_index];
+	effect::permutation &permutation = effect.permutations[permutation_index];
+
+	assert(permutation.layout == 0);
+
+	// Create pipeline layout for this effect
+	{
+		const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
+
+		api::descriptor_range ranges[4];
+		get_effect_descriptor_ranges(permutation.module, sampler_with_resource_view, ranges);
+
+		api::pipeline_layout_param layout_params[4];
+		layout_params[0].type = api::pipeline_layout_param_type::descriptor_table;
+		layout_params[0].descriptor_table.count = 1;
+		layout_params[0].descriptor_table.ranges = &ranges[0];
+
+		layout_params[1].type = api::pipeline_layout_param_type::descriptor_table;
+		layout_params[1].descriptor_table.count = 1;
+		layout_params[1].descriptor_table.ranges = &ranges[1];
+
+		layout_params[2].type = api::pipeline_layout_param_type::descriptor_table;
+		layout_params[2].descriptor_table.count = 1;
+
+		layout_params[3].type = api::pipeline_layout_param_type::descriptor_table;
+		layout_params[3].descriptor_table.count = 1;
+
+		if (sampler_with_resource_view)
+		{
+			layout_params[2].descriptor_table.ranges = &ranges[3];
+		}
+		else
+		{
+			layout_params[2].descriptor_table.ranges = &ranges[2];
+			layout_params[3].descriptor_table.ranges = &ranges[3];
+		}
+
+		if (!_device->create_pipeline_layout(sampler_with_resource_view ? 3 : 4, layout_params, &permutation.layout))
+		{
+			log::message(log::level::error, "Failed to create pipeline layout for effect file '%s'!", effect.source_file.u8string().c_str());
+			return false;
+		}
+	}
+
+	// Build specialization constants
+	std::vector<uint32_t> spec_data;
+	std::vector<uint32_t> spec_constants;
+	for (const reshadefx::uniform &spec_constant : permutation.module.spec_constants)
+	{
+		uint32_t id = static_cast<uint32_t>(spec_constants.size());
+		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
+		spec_constants.push_back(id);
+	}
+
+	const auto convert_blend_op = [](reshadefx::blend_op value) {
+		switch (value)
+		{
+		default:
+		case reshadefx::blend_op::add: return api::blend_op::add;
+		case reshadefx::blend_op::subtract: return api::blend_op::subtract;
+		case reshadefx::blend_op::reverse_subtract: return api::blend_op::reverse_subtract;
+		case reshadefx::blend_op::min: return api::blend_op::min;
+		case reshadefx::blend_op::max: return api::blend_op::max;
+		}
+	};
+	const auto convert_blend_factor = [](reshadefx::blend_factor value) {
+		switch (value) {
+		case reshadefx::blend_factor::zero: return api::blend_factor::zero;
+		default:
+		case reshadefx::blend_factor::one: return api::blend_factor::one;
+		case reshadefx::blend_factor::source_color: return api::blend_factor::source_color;
+		case reshadefx::blend_factor::one_minus_source_color: return api::blend_factor::one_minus_source_color;
+		case reshadefx::blend_factor::dest_color: return api::blend_factor::dest_color;
+		case reshadefx::blend_factor::one_minus_dest_color: return api::blend_factor::one_minus_dest_color;
+		case reshadefx::blend_factor::source_alpha: return api::blend_factor::source_alpha;
+		case reshadefx::blend_factor::one_minus_source_alpha: return api::blend_factor::one_minus_source_alpha;
+		case reshadefx::blend_factor::dest_alpha: return api::blend_factor::dest_alpha;
+		case reshadefx::blend_factor::one_minus_dest_alpha: return api::blend_factor::one_minus_dest_alpha;
+		}
+	};
+	const auto convert_stencil_op = [](reshadefx::stencil_op value) {
+		switch (value) {
+		case reshadefx::stencil_op::zero: return api::stencil_op::zero;
+		default:
+		case reshadefx::stencil_op::keep: return api::stencil_op::keep;
+		case reshadefx::stencil_op::replace: return api::stencil_op::replace;
+		case reshadefx::stencil_op::increment_saturate: return api::stencil_op::increment_saturate;
+		case reshadefx::stencil_op::decrement_saturate: return api::stencil_op::decrement_saturate;
+		case reshadefx::stencil_op::invert: return api::stencil_op::invert;
+		case reshadefx::stencil_op::increment: return api::stencil_op::increment;
+		case reshadefx::stencil_op::decrement: return api::stencil_op::decrement;
+		}
+	};
+	const auto convert_stencil_func = [](reshadefx::stencil_func value) {
+		switch (value)
+		{
+		case reshadefx::stencil_func::never: return api::compare_op::never;
+		case reshadefx::stencil_func::less: return api::compare_op::less;
+		case reshadefx::stencil_func::equal: return api::compare_op::equal;
+		case reshadefx::stencil_func::less_equal: return api::compare_op::less_equal;
+		case reshadefx::stencil_func::greater: return api::compare_op::greater;
+		case reshadefx::stencil_func::not_equal: return api::compare_op::not_equal;
+		case reshadefx::stencil_func::greater_equal: return api::compare_op::greater_equal;
+		default:
+		case reshadefx::stencil_func::always: return api::compare_op::always;
+		}
+	};
+
+	// Pipelines of all passes, in the order the techniques and passes appear in the module
+	std::vector<api::pipeline> pipelines;
+
+	const auto destroy_pipelines = [this, &permutation, &pipelines]() {
+		for (const api::pipeline pipeline : pipelines)
+			_device->destroy_pipeline(pipeline);
+
+		_device->destroy_pipeline_layout(permutation.layout);
+		permutation.layout = {};
+	};
+
+	for (const reshadefx::technique &tech : permutation.module.techniques)
+	{
+		for (size_t pass_index = 0; pass_index < tech.passes.size(); ++pass_index)
+		{
+			const reshadefx::pass &pass = tech.passes[pass_index];
+
+			std::vector<api::pipeline_subobject> subobjects;
+
+			api::shader_desc cs_desc = {};
+			api::shader_desc vs_desc = {};
+			api::shader_desc ps_desc = {};
+			api::format render_target_formats[8] = {};
+			api::format stencil_format = _effect_permutations[permutation_index].stencil_format;
+			api::primitive_topology topology = api::primitive_topology::undefined;
+			api::blend_desc blend_state = {};
+			api::rasterizer_desc rasterizer_state = {};
+			api::depth_stencil_desc depth_stencil_state = {};
+			uint32_t max_vertex_count = pass.num_vertices;
+
+			if (!pass.cs_entry_point.empty())
+			{
+				const std::string &cs = permutation.assembly.at(pass.cs_entry_point);
+				cs_desc.code = cs.data();
+				cs_desc.code_size = cs.size();
+				if (_renderer_id & 0x20000)
+				{
+					cs_desc.entry_point = pass.cs_entry_point.c_str();
+					cs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+					cs_desc.spec_constant_ids = spec_constants.data();
+					cs_desc.spec_constant_values = spec_data.data();
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::compute_shader, 1, &cs_desc });
+			}
+			else
+			{
+				if (!pass.vs_entry_point.empty())
+				{
+					const std::string &vs = permutation.assembly.at(pass.vs_entry_point);
+					vs_desc.code = vs.data();
+					vs_desc.code_size = vs.size();
+					if (_renderer_id & 0x20000)
+					{
+						vs_desc.entry_point = pass.vs_entry_point.c_str();
+						vs_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+						vs_desc.spec_constant_ids = spec_constants.data();
+						vs_desc.spec_constant_values = spec_data.data();
+					}
+
+					subobjects.push_back({ api::pipeline_subobject_type::vertex_shader, 1, &vs_desc });
+				}
+
+				if (!pass.ps_entry_point.empty())
+				{
+					const std::string &ps = permutation.assembly.at(pass.ps_entry_point);
+					ps_desc.code = ps.data();
+					ps_desc.code_size = ps.size();
+					if (_renderer_id & 0x20000)
+					{
+						ps_desc.entry_point = pass.ps_entry_point.c_str();
+						ps_desc.spec_constants = static_cast<uint32_t>(permutation.module.spec_constants.size());
+						ps_desc.spec_constant_ids = spec_constants.data();
+						ps_desc.spec_constant_values = spec_data.data();
+					}
+
+					subobjects.push_back({ api::pipeline_subobject_type::pixel_shader, 1, &ps_desc });
+				}
+
+				uint32_t viewport_width = pass.viewport_width;
+				uint32_t viewport_height = pass.viewport_height;
+
+				if (pass.render_target_names[0].empty())
+				{
+					viewport_width = _effect_permutations[permutation_index].width;
+					viewport_height = _effect_permutations[permutation_index].height;
+
+					render_target_formats[0] = api::format_to_default_typed(_effect_permutations[permutation_index].color_format, pass.srgb_write_enable);
+
+					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, 1, &render_target_formats[0] });
+				}
+				else
+				{
+					// The textures are not created yet, so derive the render target formats from their description (another loading thread may be adding textures at the same time)
+					const std::shared_lock<std::shared_mutex> lock(_reload_mutex);
+
+					uint32_t render_target_count = 0;
+					for (; render_target_count < 8 && !pass.render_target_names[render_target_count].empty(); ++render_target_count)
+					{
+						const auto render_target_texture = std::find_if(_textures.cbegin(), _textures.cend(),
+							[&unique_name = pass.render_target_names[render_target_count]](const texture &item) {
+								return item.unique_name == unique_name;
+							});
+						assert(render_target_texture != _textures.cend());
+
+						render_target_formats[render_target_count] = api::format_to_default_typed(convert_texture_format(render_target_texture->format), pass.srgb_write_enable);
+					}
+
+					subobjects.push_back({ api::pipeline_subobject_type::render_target_formats, render_target_count, render_target_formats });
+				}
+
+				// Only need to attach stencil if stencil is actually used in this pass
+				if (pass.stencil_enable &&
+					viewport_width == _effect_permutations[permutation_index].width &&
+					viewport_height == _effect_permutations[permutation_index].height)
+				{
+					subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_format, 1, &stencil_format });
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::max_vertex_count, 1, &max_vertex_count });
+
+				topology = static_cast<api::primitive_topology>(pass.topology);
+				subobjects.push_back({ api::pipeline_subobject_type::primitive_topology, 1, &topology });
+
+				// Technically should check for 'api::device_caps::independent_blend' support, but render target write masks are supported in D3D9, when rest is not, so just always set ...
+				for (int i = 0; i < 8; ++i)
+				{
+					blend_state.blend_enable[i] = pass.blend_enable[i];
+					blend_state.source_color_blend_factor[i] = convert_blend_factor(pass.source_color_blend_factor[i]);
+					blend_state.dest_color_blend_factor[i] = convert_blend_factor(pass.dest_color_blend_factor[i]);
+					blend_state.color_blend_op[i] = convert_blend_op(pass.color_blend_op[i]);
+					blend_state.source_alpha_blend_factor[i] = convert_blend_factor(pass.source_alpha_blend_factor[i]);
+					blend_state.dest_alpha_blend_factor[i] = convert_blend_factor(pass.dest_alpha_blend_factor[i]);
+					blend_state.alpha_blend_op[i] = convert_blend_op(pass.alpha_blend_op[i]);
+					blend_state.render_target_write_mask[i] = pass.render_target_write_mask[i];
+				}
+
+				subobjects.push_back({ api::pipeline_subobject_type::blend_state, 1, &blend_state });
+
+				rasterizer_state.cull_mode = api::cull_mode::none;
+
+				subobjects.push_back({ api::pipeline_subobject_type::rasterizer_state, 1, &rasterizer_state });
+
+				depth_stencil_state.depth_enable = false;
+				depth_stencil_state.depth_write_mask = false;
+				depth_stencil_state.depth_func = api::compare_op::always;
+				depth_stencil_state.stencil_enable = pass.stencil_enable;
+				depth_stencil_state.front_stencil_read_mask = pass.stencil_read_mask;
+				depth_stencil_state.front_stencil_write_mask = pass.stencil_write_mask;
+				depth_stencil_state.front_stencil_func = convert_stencil_func(pass.stencil_comparison_func);
+				depth_stencil_state.front_stencil_fail_op = convert_stencil_op(pass.stencil_fail_op);
+				depth_stencil_state.front_stencil_depth_fail_op = convert_stencil_op(pass.stencil_depth_fail_op);
+				depth_stencil_state.front_stencil_pass_op = convert_stencil_op(pass.stencil_pass_op);
+				depth_stencil_state.back_stencil_read_mask = depth_stencil_state.front_stencil_read_mask;
+				depth_stencil_state.back_stencil_write_mask = depth_stencil_state.front_stencil_write_mask;
+				depth_stencil_state.back_stencil_func = depth_stencil_state.front_stencil_func;
+				depth_stencil_state.back_stencil_fail_op = depth_stencil_state.front_stencil_fail_op;
+				depth_stencil_state.back_stencil_depth_fail_op = depth_stencil_state.front_stencil_depth_fail_op;
+				depth_stencil_state.back_stencil_pass_op = depth_stencil_state.front_stencil_pass_op;
+
+				subobjects.push_back({ api::pipeline_subobject_type::depth_stencil_state, 1, &depth_stencil_state });
+			}
+
+			const std::chrono::high_resolution_clock::time_point time_pipeline_creation_started = std::chrono::high_resolution_clock::now();
+			bool pipeline_created = false;
+			// Only effect pipelines go through the pipeline cache, so that it does not fill up with pipelines of the application or add-ons
+			switch (_device->get_api())
+			{
+			case api::device_api::d3d12:
+				pipeline_created = static_cast<d3d12::device_impl *>(_device)->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pipelines.emplace_back(), true);
+				break;
+			case api::device_api::vulkan:
+				pipeline_created = static_cast<vulkan::device_impl *>(_device)->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pipelines.emplace_back(), true);
+				break;
+			default:
+				pipeline_created = _device->create_pipeline(permutation.layout, static_cast<uint32_t>(subobjects.size()), subobjects.data(), &pipelines.emplace_back());
+				break;
+			}
+			record_load_timing(effect, effect_load_phase::pipeline_creation, permutation_index, time_pipeline_creation_started);
+
+			if (!pipeline_created)
+			{
+				log::message(log::level::error, "Failed to create %s pipeline for pass %zu in technique '%s' in '%s'!", pass.cs_entry_point.empty() ? "graphics" : "compute", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
+
+				pipelines.pop_back();
+				destroy_pipelines();
+				return false;
+			}
+		}
+	}
+
+	// Hand the pipelines to the passes of the techniques, which were created from the same module in 'load_effect'
+	const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+
+	std::vector<technique *> techniques;
+	techniques.reserve(permutation.module.techniques.size());
+	for (const reshadefx::technique &tech_info : permutation.module.techniques)
+	{
+		const auto tech = std::find_if(_techniques.begin(), _techniques.end(),
+			[effect_index, &tech_info](const technique &item) {
+				return item.effect_index == effect_index && item.name == tech_info.name;
+			});
+		if (tech == _techniques.end() || permutation_index >= tech->permutations.size() || tech->permutations[permutation_index].passes.size() != tech_info.passes.size())
+		{
+			log::message(log::level::error, "Failed to find technique '%s' in '%s' for its pipelines!", tech_info.name.c_str(), effect.source_file.u8string().c_str());
+
+			destroy_pipelines();
+			return false;
+		}
+
+		techniques.push_back(&*tech);
+	}
+
+	size_t pipeline_index = 0;
+	for (technique *const tech : techniques)
+		for (technique::pass &pass : tech->permutations[permutation_index].passes)
+			pass.pipeline = pipelines[pipeline_index++];
+
 	return true;
 }
 bool reshade::runtime::create_effect_sampler_state(const reshadefx::sampler_desc &info, api::sampler &sampler)
@@ -3309,6 +3916,13 @@ void reshade::runtime::destroy_effect(size_t effect_index)
 {
 	assert(effect_index < _effects.size());
 
+	// Transition values point into the uniform storage of the effects, the layout of which may change when the effect is reloaded, so resolve them again afterwards
+	if (_is_in_preset_transition)
+	{
+		_preset_transition_values.clear();
+		_preset_transition_values_time = {};
+	}
+
 	for (technique &tech : _techniques)
 	{
 		if (tech.effect_index != effect_index)
@@ -3333,6 +3947,8 @@ void reshade::runtime::destroy_effect(size_t effect_index)
 		_device->destroy_resource(effect.cb);
 		effect.cb = {};
 
+		effect.load_timings.clear();
+
 		_device->destroy_query_heap(effect.query_heap);
 		effect.query_heap = {};
 
@@ -3360,6 +3976,7 @@ void reshade::runtime::destroy_effect(size_t effect_index)
 	_textures.erase(std::remove_if(_textures.begin(), _textures.end(),
 		[this, effect_index](texture &tex) {
 			tex.shared.erase(std::remove(tex.shared.begin(), tex.shared.end(), effect_index), tex.shared.end());
+			tex.aliased.erase(std::remove(tex.aliased.begin(), tex.aliased.end(), effect_index), tex.aliased.end());
 			if (tex.shared.empty())
 			{
 				destroy_texture(tex);
@@ -3601,70 +4218,17 @@ bool reshade::runtime::create_texture(texture &tex)
 		break;
 	}
 
-	api::format format = api::format::unknown;
-	api::format view_format = api::format::unknown;
-	api::format view_format_srgb = api::format::unknown;
+	const api::format format = convert_texture_format(tex.format);
+	api::format view_format = format;
+	api::format view_format_srgb = format;
 
-	switch (tex.format)
+	// Create RGBA8 textures with a typeless format, so that they can be viewed in both linear and sRGB
+	if (format == api::format::r8g8b8a8_typeless)
 	{
-	case reshadefx::texture_format::r8:
-		format = api::format::r8_unorm;
-		break;
-	case reshadefx::texture_format::r16:
-		format = api::format::r16_unorm;
-		break;
-	case reshadefx::texture_format::r16f:
-		format = api::format::r16_float;
-		break;
-	case reshadefx::texture_format::r32i:
-		format = api::format::r32_sint;
-		break;
-	case reshadefx::texture_format::r32u:
-		format = api::format::r32_uint;
-		break;
-	case reshadefx::texture_format::r32f:
-		format = api::format::r32_float;
-		break;
-	case reshadefx::texture_format::rg8:
-		format = api::format::r8g8_unorm;
-		break;
-	case reshadefx::texture_format::rg16:
-		format = api::format::r16g16_unorm;
-		break;
-	case reshadefx::texture_format::rg16f:
-		format = api::format::r16g16_float;
-		break;
-	case reshadefx::texture_format::rg32f:
-		format = api::format::r32g32_float;
-		break;
-	case reshadefx::texture_format::rgba8:
-		format = api::format::r8g8b8a8_typeless;
 		view_format = api::format::r8g8b8a8_unorm;
 		view_format_srgb = api::format::r8g8b8a8_unorm_srgb;
-		break;
-	case reshadefx::texture_format::rgba16:
-		format = api::format::r16g16b16a16_unorm;
-		break;
-	case reshadefx::texture_format::rgba16f:
-		format = api::format::r16g16b16a16_float;
-		break;
-	case reshadefx::texture_format::rgba32i:
-		format = api::format::r32g32b32a32_sint;
-		break;
-	case reshadefx::texture_format::rgba32u:
-		format = api::format::r32g32b32a32_uint;
-		break;
-	case reshadefx::texture_format::rgba32f:
-		format = api::format::r32g32b32a32_float;
-		break;
-	case reshadefx::texture_format::rgb10a2:
-		format = api::format::r10g10b10a2_unorm;
-		break;
 	}
 
-	if (view_format == api::format::unknown)
-		view_format_srgb = view_format = format;
-
 	api::resource_usage usage = api::resource_usage::shader_resource;
 	usage |= api::resource_usage::copy_source; // For texture data download
 	if (tex.semantic.empty())
@@ -3810,7 +4374,9 @@ void reshade::runtime::enable_technique(technique &tech)
 
 	const bool status_changed = !tech.enabled;
 	tech.enabled = true;
-	tech.time_left = tech.annotation_as_int("timeout");
+	tech.time_left = tech.timeout;
+	// Output of passes from a previous time the technique was enabled is outdated, so force a full update
+	tech.last_update_frame = std::numeric_limits<uint64_t>::max();
 
 	// Queue effect file for initialization if it was not fully loaded yet
 	if (!tech.permutations[0].created &&
@@ -4005,6 +4571,7 @@ void reshade::runtime::destroy_effects()
 
 	// Reset the effect list after all resources have been destroyed
 	_effects.clear();
+	_duplicate_effect_variants.clear();
 
 	// Clean up sampler objects
 	for (const auto &[hash, sampler] : _effect_sampler_states)
@@ -4049,17 +4616,96 @@ bool reshade::runtime::save_effect_cache(const std::string &id, const std::strin
 	if (_no_effect_cache)
 		return false;
 
-	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
-	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
+	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
+	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
+
+	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYNO);
+	if (file == nullptr)
+		return false;
+
+	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+	return file_size_written == data.size();
+}
+void reshade::runtime::load_pipeline_cache()
+{
+	// Only D3D12 and Vulkan expose a way to retrieve compiled pipelines, the other APIs rely on the driver to cache them
+	if (_no_effect_cache || (_device->get_api() != api::device_api::d3d12 && _device->get_api() != api::device_api::vulkan))
+		return;
+
+	std::string data;
+	load_effect_cache(pipeline_cache_id(), "pso", data);
+
+	_pipeline_cache_hash = std::hash<std::string>()(data);
+
+	switch (_device->get_api())
+	{
+	case api::device_api::d3d12:
+		if (!static_cast<d3d12::device_impl *>(_device)->create_pipeline_library(std::move(data)))
+			log::message(log::level::warning, "Failed to create pipeline library. Effect pipelines will not be cached.");
+		_pipeline_cache_generation = static_cast<d3d12::device_impl *>(_device)->get_pipeline_library_generation();
+		break;
+	case api::device_api::vulkan:
+		if (!static_cast<vulkan::device_impl *>(_device)->create_pipeline_cache(data))
+			log::message(log::level::warning, "Failed to create pipeline cache. Effect pipelines will not be cached.");
+		_pipeline_cache_generation = static_cast<vulkan::device_impl *>(_device)->get_pipeline_cache_generation();
+		break;
+	default:
+		break;
+	}
+}
+void reshade::runtime::save_pipeline_cache()
+{
+	if (_no_effect_cache)
+		return;
+
+	// Skip serialization entirely if no pipelines were added to the cache since it was last loaded or saved
+	uint32_t generation = 0;
+	switch (_device->get_api())
+	{
+	case api::device_api::d3d12:
+		generation = static_cast<const d3d12::device_impl *>(_device)->get_pipeline_library_generation();
+		break;
+	case api::device_api::vulkan:
+		generation = static_cast<const vulkan::device_impl *>(_device)->get_pipeline_cache_generation();
+		break;
+	default:
+		return;
+	}
+
+	if (generation == _pipeline_cache_generation)
+		return;
+	_pipeline_cache_generation = generation;
 
-	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYNO);
-	if (file == nullptr)
-		return false;
+	std::string data;
+	switch (_device->get_api())
+	{
+	case api::device_api::d3d12:
+		if (!static_cast<const d3d12::device_impl *>(_device)->serialize_pipeline_library(data))
+			return;
+		break;
+	case api::device_api::vulkan:
+		if (!static_cast<const vulkan::device_impl *>(_device)->get_pipeline_cache_data(data))
+			return;
+		break;
+	default:
+		return;
+	}
 
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	return file_size_written == data.size();
+	// Pipelines may have all been found in the cache, in which case there is nothing new to write
+	if (const size_t hash = std::hash<std::string>()(data);
+		hash != _pipeline_cache_hash)
+	{
+		_pipeline_cache_hash = hash;
+		save_effect_cache(pipeline_cache_id(), "pso", data);
+	}
+}
+std::string reshade::runtime::pipeline_cache_id() const
+{
+	// Serialized pipelines are only valid for the device they were created on
+	return "pipelines-" + std::to_string(_renderer_id) + '-' + std::to_string(_vendor_id) + '-' + std::to_string(_device_id);
 }
+
 void reshade::runtime::clear_effect_cache()
 {
 	std::error_code ec;
@@ -4072,7 +4718,7 @@ void reshade::runtime::clear_effect_cache()
 
 		const std::filesystem::path filename = entry.path().filename();
 		const std::filesystem::path extension = entry.path().extension();
-		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm"))
+		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm" && extension != L".pso"))
 			continue;
 
 		std::filesystem::remove(entry, ec);
@@ -4080,6 +4726,122 @@ void reshade::runtime::clear_effect_cache()
 
 	if (ec)
 		log::message(log::level::error, "Failed to clear effect cache directory with error code %d!", ec.value());
+
+	// Also drop compiled variants kept in memory, so that the next reload really starts from scratch
+	const std::unique_lock<std::mutex> lock(_effect_variant_cache_mutex);
+	_effect_variant_cache.clear();
+	_effect_variant_cache_used = 0;
+}
+auto reshade::runtime::find_effect_variant(size_t variant_hash) -> std::shared_ptr<const compiled_effect_variant>
+{
+	const std::unique_lock<std::mutex> lock(_effect_variant_cache_mutex);
+
+	const auto it = std::find_if(_effect_variant_cache.begin(), _effect_variant_cache.end(),
+		[variant_hash](const std::pair<size_t, std::shared_ptr<const compiled_effect_variant>> &entry) { return entry.first == variant_hash; });
+	if (it == _effect_variant_cache.end())
+		return nullptr;
+
+	// Move to the front, so that it is evicted last
+	std::rotate(_effect_variant_cache.begin(), it, it + 1);
+	return _effect_variant_cache.front().second;
+}
+void reshade::runtime::add_effect_variant(size_t variant_hash, std::shared_ptr<const compiled_effect_variant> &&variant)
+{
+	const size_t budget = static_cast<size_t>(_effect_variant_cache_size) * 1024 * 1024;
+	const size_t variant_size = variant->memory_size();
+	if (variant_size > budget)
+		return;
+
+	const std::unique_lock<std::mutex> lock(_effect_variant_cache_mutex);
+
+	// Another thread may have compiled the same variant in the meantime
+	if (std::find_if(_effect_variant_cache.begin(), _effect_variant_cache.end(),
+			[variant_hash](const std::pair<size_t, std::shared_ptr<const compiled_effect_variant>> &entry) { return entry.first == variant_hash; }) != _effect_variant_cache.end())
+		return;
+
+	_effect_variant_cache.emplace(_effect_variant_cache.begin(), variant_hash, std::move(variant));
+	_effect_variant_cache_used += variant_size;
+
+	// Evict least recently used variants until the cache fits into the budget again
+	while (_effect_variant_cache_used > budget)
+	{
+		_effect_variant_cache_used -= _effect_variant_cache.back().second->memory_size();
+		_effect_variant_cache.pop_back();
+	}
+}
+void reshade::runtime::record_load_timing(effect &effect, effect_load_phase phase, size_t permutation_index, std::chrono::high_resolution_clock::time_point start)
+{
+	const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	// Permutations of the same effect are loaded on different threads at the same time, which all append to the same list
+	const std::unique_lock<std::mutex> lock(_load_timings_mutex);
+
+	effect.load_timings.push_back({ phase, permutation_index, std::this_thread::get_id(), start, end });
+}
+void reshade::runtime::save_effect_load_trace() const
+{
+	const auto append_escaped = [](std::string &json, const std::string &value) {
+		for (const char c : value)
+		{
+			if (c == '"' || c == '\\')
+				json += '\\';
+			if (static_cast<unsigned char>(c) >= 0x20)
+				json += c;
+		}
+	};
+
+	// Express all timestamps relative to the first recorded one and assign small sequential numbers to threads, which makes the trace easier to navigate
+	std::chrono::high_resolution_clock::time_point trace_start = std::chrono::high_resolution_clock::time_point::max();
+	for (const effect &effect : _effects)
+		for (const effect::load_timing &timing : effect.load_timings)
+			trace_start = std::min(trace_start, timing.start);
+
+	std::vector<std::thread::id> thread_ids;
+
+	std::string json = "{\"traceEvents\":[";
+	bool first_event = true;
+
+	for (const effect &effect : _effects)
+	{
+		const std::string effect_name = effect.source_file.filename().u8string();
+
+		for (const effect::load_timing &timing : effect.load_timings)
+		{
+			auto thread_it = std::find(thread_ids.begin(), thread_ids.end(), timing.thread_id);
+			if (thread_it == thread_ids.end())
+				thread_it = thread_ids.insert(thread_ids.end(), timing.thread_id);
+
+			char event[256];
+			std::snprintf(event, sizeof(event), "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{\"permutation\":%zu}}",
+				effect_load_phase_name(timing.phase),
+				std::chrono::duration_cast<std::chrono::nanoseconds>(timing.start - trace_start).count() * 1e-3,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(timing.end - timing.start).count() * 1e-3,
+				static_cast<size_t>(std::distance(thread_ids.begin(), thread_it)) + 1,
+				timing.permutation_index);
+
+			if (!first_event)
+				json += ',';
+			first_event = false;
+
+			json += "\n{\"name\":\"";
+			append_escaped(json, effect_name);
+			json += event;
+		}
+	}
+
+	json += "\n]}\n";
+
+	const std::filesystem::path path = g_reshade_base_path / _effect_load_trace_path;
+
+	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYNO);
+	if (file == nullptr)
+	{
+		log::message(log::level::error, "Failed to open effect load trace file '%s'!", path.u8string().c_str());
+		return;
+	}
+
+	fwrite(json.data(), 1, json.size(), file);
+	fclose(file);
 }
 
 auto reshade::runtime::add_effect_permutation(uint32_t width, uint32_t height, api::format color_format, api::format stencil_format, api::color_space color_space) -> size_t
@@ -4226,9 +4988,16 @@ void reshade::runtime::update_effects()
 				thread.join(); // Threads have exited, but still need to join them prior to destruction
 		_worker_threads.clear();
 
+		// Effects that were loaded in parallel may have turned off aliasing for textures that others were already aliased with
+		unalias_persistent_textures();
+
 		// Finished loading effects, so apply preset to figure out which ones need compiling
 		load_current_preset();
 
+		// Nothing left to create, so the load timings are complete already
+		if (_reload_create_queue.empty() && !_effect_load_trace_path.empty())
+			save_effect_load_trace();
+
 #if RESHADE_ADDON
 		invoke_addon_event<addon_event::reshade_set_current_preset_path>(this, _current_preset_path.u8string().c_str());
 #endif
@@ -4263,41 +5032,63 @@ void reshade::runtime::update_effects()
 	if (_reload_remaining_effects != std::numeric_limits<size_t>::max() || _reload_create_queue.empty())
 		return;
 
-	// Pop an effect from the queue
-	const auto [effect_index, permutation_index] = _reload_create_queue.back();
-	_reload_create_queue.pop_back();
-	effect &effect = _effects[effect_index];
+	const std::chrono::high_resolution_clock::time_point time_create_started = std::chrono::high_resolution_clock::now();
 
-	if (!create_effect(effect_index, permutation_index))
+	// Create at least one effect per frame and keep going while there is time left in the budget
+	do
 	{
-		_graphics_queue->wait_idle();
-
-		// Destroy all textures belonging to this effect
-		for (texture &tex : _textures)
-			if (tex.effect_index == effect_index && tex.shared.size() <= 1)
-				destroy_texture(tex);
-		// Disable all techniques belonging to this effect
-		for (technique &tech : _techniques)
-			if (tech.effect_index == effect_index)
-				disable_technique(tech);
+		// Pop an effect from the queue
+		const auto [effect_index, permutation_index] = _reload_create_queue.back();
+		_reload_create_queue.pop_back();
+		effect &effect = _effects[effect_index];
 
-		effect.compiled = false;
-		_last_reload_successful = false;
-	}
+		if (!create_effect(effect_index, permutation_index))
+		{
+			_graphics_queue->wait_idle();
+
+			// Destroy all textures belonging to this effect
+			for (texture &tex : _textures)
+				if (tex.effect_index == effect_index && tex.shared.size() <= 1)
+					destroy_texture(tex);
+			// Disable all techniques belonging to this effect
+			for (technique &tech : _techniques)
+				if (tech.effect_index == effect_index)
+					disable_technique(tech);
+
+			effect.compiled = false;
+			_last_reload_successful = false;
+		}
 
 #if RESHADE_GUI
-	// Update assembly in all code editors after a reload
-	for (editor_instance &instance : _editors)
-	{
-		if (!instance.generated || instance.entry_point_name.empty() || instance.permutation_index != permutation_index || instance.file_path != effect.source_file)
-			continue;
+		// Update assembly in all code editors after a reload
+		for (editor_instance &instance : _editors)
+		{
+			if (!instance.generated || instance.entry_point_name.empty() || instance.permutation_index != permutation_index || instance.file_path != effect.source_file)
+				continue;
 
-		assert(instance.effect_index == effect_index);
+			assert(instance.effect_index == effect_index);
 
-		if (effect.permutations[permutation_index].assembly_text.find(instance.entry_point_name) != effect.permutations[permutation_index].assembly_text.end())
-			open_code_editor(instance);
-	}
+			if (effect.permutations[permutation_index].assembly_text.find(instance.entry_point_name) != effect.permutations[permutation_index].assembly_text.end())
+				open_code_editor(instance);
+		}
 #endif
+	} while (!_reload_create_queue.empty() &&
+		std::chrono::high_resolution_clock::now() - time_create_started < std::chrono::milliseconds(_effect_create_budget));
+
+	if (_reload_create_queue.empty() && !_effect_load_trace_path.empty())
+		save_effect_load_trace();
+
+	if (_reload_create_queue.empty())
+	{
+		// Effects created later may have started sharing textures with techniques that were created before, so update which of those are aliased now that all are created
+		for (technique &tech : _techniques)
+			for (size_t permutation_index = 0; permutation_index < tech.permutations.size(); ++permutation_index)
+				if (tech.permutations[permutation_index].created)
+					update_aliased_texture_flags(tech, permutation_index);
+
+		// Write back any pipelines that were created during this reload, so that the next session can skip their compilation
+		save_pipeline_cache();
+	}
 
 #if RESHADE_ADDON
 	if (_reload_create_queue.empty())
@@ -4326,51 +5117,95 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		)
 		input_lock = _input->lock();
 
+	// Evaluate the sources of special uniform variables that are the same for all variables only once per frame
+	// Single values are padded to four components, to match the behavior of 'set_uniform_value' with scalar arguments
+	const float frame_time[4] = { _last_frame_duration.count() * 1e-6f };
+	const float frame_duration_seconds = _last_frame_duration.count() * 1e-9f;
+	const bool frame_count_even[4] = { (_frame_count % 2) == 0 };
+	const uint32_t frame_count[4] = { static_cast<uint32_t>(_frame_count % UINT_MAX) };
+	const uint32_t timer_ms[4] = { static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count()) };
+	int32_t date[4] = {};
+	bool date_evaluated = false;
+
+#if RESHADE_ADDON
+	// Add-ons can intercept changes to uniform variables, which requires going through 'set_uniform_value'
+	const bool direct_uniform_write = !has_addon_event<addon_event::reshade_set_uniform_value>();
+#else
+	const bool direct_uniform_write = true;
+#endif
+
+	// Write values straight into the uniform storage with the same conversion 'set_uniform_value' would apply
+	const auto write_special_uniform = [this, direct_uniform_write](effect &effect, const effect::special_uniform_update &update, const auto *values, uint32_t count) {
+		if (!direct_uniform_write || !update.direct)
+		{
+			set_uniform_value(effect.uniforms[update.uniform_index], values, count);
+			return;
+		}
+
+		uint8_t *const data = effect.uniform_data_storage.data() + update.offset;
+		for (uint32_t i = 0; i < std::min(count, update.components); ++i)
+		{
+			if (update.floating_point)
+			{
+				const float value = static_cast<float>(values[i]);
+				std::memcpy(data + i * 4, &value, 4);
+			}
+			else
+			{
+				const int32_t value = static_cast<int32_t>(values[i]);
+				std::memcpy(data + i * 4, &value, 4);
+			}
+		}
+	};
+
 	// Update special uniform variables
 	for (effect &effect : _effects)
 	{
 		if (!effect.rendering || (!_effects_enabled && !effect.addon))
 			continue;
 
-		for (uniform &variable : effect.uniforms)
+		for (const effect::special_uniform_update &update : effect.special_uniform_updates)
 		{
-			switch (variable.special)
+			uniform &variable = effect.uniforms[update.uniform_index];
+
+			switch (update.special)
 			{
 				case special_uniform::frame_time:
 				{
-					set_uniform_value(variable, _last_frame_duration.count() * 1e-6f);
+					write_special_uniform(effect, update, frame_time, 4);
 					break;
 				}
 				case special_uniform::frame_count:
 				{
 					if (variable.type.is_boolean())
-						set_uniform_value(variable, (_frame_count % 2) == 0);
+						write_special_uniform(effect, update, frame_count_even, 4);
 					else
-						set_uniform_value(variable, static_cast<unsigned int>(_frame_count % UINT_MAX));
+						write_special_uniform(effect, update, frame_count, 4);
 					break;
 				}
 				case special_uniform::random:
 				{
-					const int min = variable.annotation_as_int("min", 0, 0);
-					const int max = variable.annotation_as_int("max", 0, RAND_MAX);
-					set_uniform_value(variable, min + (std::rand() % (std::abs(max - min) + 1)));
+					const int min = update.int_params[0];
+					const int max = update.int_params[1];
+					const int32_t value[4] = { min + (std::rand() % (std::abs(max - min) + 1)) };
+					write_special_uniform(effect, update, value, 4);
 					break;
 				}
 				case special_uniform::ping_pong:
 				{
-					const float min = variable.annotation_as_float("min", 0, 0.0f);
-					const float max = variable.annotation_as_float("max", 0, 1.0f);
-					const float step_min = variable.annotation_as_float("step", 0);
-					const float step_max = variable.annotation_as_float("step", 1);
+					const float min = update.float_params[0];
+					const float max = update.float_params[1];
+					const float step_min = update.float_params[2];
+					const float step_max = update.float_params[3];
 					float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
-					const float smoothing = variable.annotation_as_float("smoothing");
+					const float smoothing = update.float_params[4];
 
 					float value[2] = { 0, 0 };
 					get_uniform_value(variable, value, 2);
 					if (value[1] >= 0)
 					{
 						increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
+						increment *= frame_duration_seconds;
 
 						if ((value[0] += increment) >= max)
 							value[0] = max, value[1] = -1;
@@ -4378,32 +5213,33 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					else
 					{
 						increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
-						increment *= _last_frame_duration.count() * 1e-9f;
+						increment *= frame_duration_seconds;
 
 						if ((value[0] -= increment) <= min)
 							value[0] = min, value[1] = +1;
 					}
-					set_uniform_value(variable, value, 2);
+					write_special_uniform(effect, update, value, 2);
 					break;
 				}
 				case special_uniform::date:
 				{
-					const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-					struct tm tm; localtime_s(&tm, &t);
-
-					const int value[4] = {
-						tm.tm_year + 1900,
-						tm.tm_mon + 1,
-						tm.tm_mday,
-						tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec
-					};
-					set_uniform_value(variable, value, 4);
+					if (!date_evaluated)
+					{
+						const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+						struct tm tm; localtime_s(&tm, &t);
+
+						date[0] = tm.tm_year + 1900;
+						date[1] = tm.tm_mon + 1;
+						date[2] = tm.tm_mday;
+						date[3] = tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+						date_evaluated = true;
+					}
+					write_special_uniform(effect, update, date, 4);
 					break;
 				}
 				case special_uniform::timer:
 				{
-					const unsigned long long timer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_last_present_time - _start_time).count();
-					set_uniform_value(variable, static_cast<unsigned int>(timer_ms));
+					write_special_uniform(effect, update, timer_ms, 4);
 					break;
 				}
 				case special_uniform::key:
@@ -4411,21 +5247,21 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
+					if (const int keycode = update.int_params[0];
 						keycode > 7 && keycode < 256)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
+						bool value[4] = {};
+						if (update.key_mode == 2)
 						{
-							bool current_value = false;
-							get_uniform_value(variable, &current_value);
+							get_uniform_value(variable, value);
 							if (_input->is_key_pressed(keycode))
-								set_uniform_value(variable, !current_value);
+								value[0] = !value[0];
 						}
-						else if (mode == "press")
-							set_uniform_value(variable, _input->is_key_pressed(keycode));
+						else if (update.key_mode == 1)
+							value[0] = _input->is_key_pressed(keycode);
 						else
-							set_uniform_value(variable, _input->is_key_down(keycode));
+							value[0] = _input->is_key_down(keycode);
+						write_special_uniform(effect, update, value, 4);
 					}
 					break;
 				}
@@ -4434,7 +5270,8 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					set_uniform_value(variable, _input->mouse_position_x(), _input->mouse_position_y());
+					const uint32_t value[4] = { _input->mouse_position_x(), _input->mouse_position_y() };
+					write_special_uniform(effect, update, value, 4);
 					break;
 				}
 				case special_uniform::mouse_delta:
@@ -4442,7 +5279,8 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					set_uniform_value(variable, _input->mouse_movement_delta_x(), _input->mouse_movement_delta_y());
+					const int32_t value[4] = { _input->mouse_movement_delta_x(), _input->mouse_movement_delta_y() };
+					write_special_uniform(effect, update, value, 4);
 					break;
 				}
 				case special_uniform::mouse_button:
@@ -4450,21 +5288,21 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
+					if (const int keycode = update.int_params[0];
 						keycode >= 0 && keycode < 5)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
+						bool value[4] = {};
+						if (update.key_mode == 2)
 						{
-							bool current_value = false;
-							get_uniform_value(variable, &current_value);
+							get_uniform_value(variable, value);
 							if (_input->is_mouse_button_pressed(keycode))
-								set_uniform_value(variable, !current_value);
+								value[0] = !value[0];
 						}
-						else if (mode == "press")
-							set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
+						else if (update.key_mode == 1)
+							value[0] = _input->is_mouse_button_pressed(keycode);
 						else
-							set_uniform_value(variable, _input->is_mouse_button_down(keycode));
+							value[0] = _input->is_mouse_button_down(keycode);
+						write_special_uniform(effect, update, value, 4);
 					}
 					break;
 				}
@@ -4473,11 +5311,9 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					const float min = variable.annotation_as_float("min");
-					const float max = variable.annotation_as_float("max");
-					float step = variable.annotation_as_float("step");
-					if (step == 0.0f)
-						step  = 1.0f;
+					const float min = update.float_params[0];
+					const float max = update.float_params[1];
+					const float step = update.float_params[2];
 
 					float value[2] = { 0, 0 };
 					get_uniform_value(variable, value, 2);
@@ -4488,13 +5324,14 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 						value[0] = std::max(value[0], min);
 						value[0] = std::min(value[0], max);
 					}
-					set_uniform_value(variable, value, 2);
+					write_special_uniform(effect, update, value, 2);
 					break;
 				}
 #if RESHADE_GUI
 				case special_uniform::overlay_open:
 				{
-					set_uniform_value(variable, _show_overlay);
+					const bool value[4] = { _show_overlay };
+					write_special_uniform(effect, update, value, 4);
 					break;
 				}
 				case special_uniform::overlay_active:
@@ -4502,13 +5339,17 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 				{
 					// These are set in 'draw_variable_editor' when overlay is open
 					if (!_show_overlay)
-						set_uniform_value(variable, 0);
+					{
+						const int32_t value[4] = {};
+						write_special_uniform(effect, update, value, 4);
+					}
 					break;
 				}
 #endif
 				case special_uniform::screenshot:
 				{
-					set_uniform_value(variable, _should_save_screenshot);
+					const bool value[4] = { _should_save_screenshot };
+					write_special_uniform(effect, update, value, 4);
 					break;
 				}
 			}
@@ -4553,6 +5394,35 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 	cmd_list->begin_debug_event("ReShade effects");
 #endif
 
+	// The application rendered a new frame since the last time, so the back buffer needs to be copied again before it is sampled
+	_effect_permutations[permutation_index].color_tex_source = {};
+
+	// The compute queue is synchronized with the graphics queue using fences, which only works when rendering on the immediate command list of the graphics queue
+	// Only D3D12 has a compute queue for this, which is created the first time async compute is used, so that nothing is allocated for it while the option is off
+	bool use_async_compute = _async_compute && _device->get_api() == api::device_api::d3d12 && !_is_vr && cmd_list == _graphics_queue->get_immediate_command_list();
+#if RESHADE_ADDON
+	// Add-ons expect to be able to record commands after every technique on the command list effects are rendered with
+	if (has_addon_event<addon_event::reshade_render_technique>())
+		use_async_compute = false;
+#endif
+	if (use_async_compute && _compute_queue == nullptr &&
+		(_compute_queue = static_cast<d3d12::device_impl *>(_device)->create_async_compute_queue()) == nullptr)
+	{
+		log::message(log::level::error, "Failed to create async compute queue!");
+
+		_async_compute = use_async_compute = false;
+	}
+	if (use_async_compute && _async_compute_begin_fence == 0 && (
+		!_device->create_fence(_async_compute_begin_value, api::fence_flags::none, &_async_compute_begin_fence) ||
+		!_device->create_fence(_async_compute_end_value, api::fence_flags::none, &_async_compute_end_fence)))
+	{
+		log::message(log::level::error, "Failed to create async compute synchronization fences!");
+
+		_device->destroy_fence(_async_compute_begin_fence);
+		_async_compute_begin_fence = {};
+		_async_compute = use_async_compute = false;
+	}
+
 	// Render all enabled techniques
 	for (size_t technique_index : _technique_sorting)
 	{
@@ -4569,7 +5439,22 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 			continue;
 		}
 
-		render_technique(tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
+		const technique::permutation &tech_permutation = tech.permutations[permutation_index];
+
+		// Textures that are aliased with other effects share memory with resources that are not tracked here, so techniques accessing them always have to run on the graphics queue
+		if (use_async_compute && tech_permutation.async_compute && !tech_permutation.accesses_aliased_texture)
+		{
+			render_technique_async(tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
+		}
+		else
+		{
+			// Wait for techniques on the compute queue to finish before accessing any of their resources on the graphics queue
+			if (std::any_of(tech_permutation.accessed_resources.cbegin(), tech_permutation.accessed_resources.cend(),
+					[this](api::resource resource) { return std::find(_async_compute_resources.cbegin(), _async_compute_resources.cend(), resource) != _async_compute_resources.cend(); }))
+				join_async_compute(cmd_list);
+
+			render_technique(tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
+		}
 
 		if (tech.time_left > 0)
 		{
@@ -4579,6 +5464,9 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		}
 	}
 
+	// Make sure all work on the compute queue finished before the frame is presented (this also means that waiting for the graphics queue to become idle implies the compute queue is idle too)
+	join_async_compute(cmd_list);
+
 #ifndef NDEBUG
 	cmd_list->end_debug_event();
 #endif
@@ -4595,8 +5483,18 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	const effect &effect = _effects[tech.effect_index];
 	const effect::permutation &permutation = effect.permutations[permutation_index];
 
+	// Compute queues do not support the pixel shader resource state, so resources of techniques running on the async compute queue are kept in the non-pixel shader resource state instead (see 'render_technique_async')
+	const bool is_async_compute = _compute_queue != nullptr && cmd_list == _compute_queue->get_immediate_command_list();
+	const api::resource_usage shader_resource_state = is_async_compute ? api::resource_usage::shader_resource_non_pixel : api::resource_usage::shader_resource;
+
+	// GPU durations are needed both for the statistics in the overlay and for the governor (timestamps on the compute queue may use a different frequency than those on the graphics queue, so are skipped)
+	const bool measure_gpu_duration = _timestamp_frequency != 0 && effect.query_heap != 0 && permutation_index == 0 && !is_async_compute && (_gpu_time_budget > 0.0f
 #if RESHADE_GUI
-	if (_gather_gpu_statistics && _timestamp_frequency != 0 && effect.query_heap != 0 && permutation_index == 0)
+		|| _gather_gpu_statistics
+#endif
+		);
+
+	if (measure_gpu_duration)
 	{
 		// Evaluate queries from oldest frame in queue
 		if (uint64_t timestamps[2];
@@ -4606,9 +5504,30 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, tech.query_base_index + (_frame_count % 4) * 2);
 	}
 
+#if RESHADE_GUI
 	const std::chrono::high_resolution_clock::time_point time_technique_started = std::chrono::high_resolution_clock::now();
 #endif
 
+	// Techniques with a reduced update rate only execute all passes every few frames and otherwise just the passes that write to the back buffer (using the output of the skipped passes from the last full update)
+	bool full_update = true;
+	if (permutation_index != 0)
+	{
+		// Intermediate textures are shared between permutations, so rendering another permutation overwrites the output the next update would reuse
+		tech.last_update_frame = std::numeric_limits<uint64_t>::max();
+	}
+	else if (const unsigned int update_rate = std::max(tech.update_rate, _gpu_time_budget > 0.0f ? tech.governor_update_rate : 1u);
+		update_rate > 1)
+	{
+		// Effects may be rendered multiple times per frame to different targets (e.g. by add-ons), in which case the output of the last update belongs to another target and cannot be reused
+		if (tech.last_update_frame != std::numeric_limits<uint64_t>::max() && tech.last_update_target == back_buffer_resource && (_frame_count - tech.last_update_frame) < update_rate)
+			full_update = false;
+		else
+		{
+			tech.last_update_frame = _frame_count;
+			tech.last_update_target = back_buffer_resource;
+		}
+	}
+
 #ifndef NDEBUG
 	cmd_list->begin_debug_event(tech.name.c_str());
 #endif
@@ -4628,66 +5547,86 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
 
 	bool is_effect_stencil_cleared = false;
-	bool needs_implicit_back_buffer_copy = true; // First pass always needs the back buffer updated
+
+	// Barriers are queued up and only submitted right before the next command that depends on them, so that transitions of consecutive steps are merged into a single call
+	const auto add_barrier = [this](api::resource resource, api::resource_usage state_old, api::resource_usage state_new) {
+		_pending_barrier_resources.push_back(resource);
+		_pending_barrier_state_old.push_back(state_old);
+		_pending_barrier_state_new.push_back(state_new);
+	};
+	const auto flush_barriers = [this, cmd_list]() {
+		if (_pending_barrier_resources.empty())
+			return;
+		cmd_list->barrier(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_state_old.data(), _pending_barrier_state_new.data());
+		_pending_barrier_resources.clear();
+		_pending_barrier_state_old.clear();
+		_pending_barrier_state_new.clear();
+	};
+
+	effect_permutation &color_permutation = _effect_permutations[permutation_index];
+
+	// Consecutive passes usually share the constant buffer and sampler tables (and often the viewport), so only bind what actually changed since the previous pass
+	bind_state_tracker bind_state;
 
 	for (size_t pass_index = 0; pass_index < tech.permutations[permutation_index].passes.size(); ++pass_index)
 	{
-		if (needs_implicit_back_buffer_copy)
+		const technique::pass &pass = tech.permutations[permutation_index].passes[pass_index];
+
+		// Textures that are aliased with other effects (see 'load_effect') do not keep their contents between frames, so passes writing to them cannot be skipped
+		if (!full_update && !pass.writes_back_buffer && !pass.modifies_aliased_texture)
+			continue;
+
+		// Only copy the back buffer when this pass actually samples it and it was written since the last copy (by a previous pass or technique)
+		if (pass.reads_back_buffer && color_permutation.color_tex_source != back_buffer_resource)
 		{
-			// Save back buffer of previous pass
-			const api::resource resources[2] = { back_buffer_resource, _effect_permutations[permutation_index].color_tex};
-			const api::resource_usage state_old[2] = { api::resource_usage::render_target, api::resource_usage::shader_resource };
-			const api::resource_usage state_new[2] = { api::resource_usage::copy_source, api::resource_usage::copy_dest };
+			add_barrier(back_buffer_resource, api::resource_usage::render_target, api::resource_usage::copy_source);
+			add_barrier(color_permutation.color_tex, api::resource_usage::shader_resource, api::resource_usage::copy_dest);
+			flush_barriers();
 
-			cmd_list->barrier(2, resources, state_old, state_new);
-			cmd_list->copy_texture_region(back_buffer_resource, 0, nullptr, _effect_permutations[permutation_index].color_tex, 0, nullptr);
-			cmd_list->barrier(2, resources, state_new, state_old);
-		}
+			cmd_list->copy_texture_region(back_buffer_resource, 0, nullptr, color_permutation.color_tex, 0, nullptr);
 
-		const technique::pass &pass = tech.permutations[permutation_index].passes[pass_index];
+			add_barrier(back_buffer_resource, api::resource_usage::copy_source, api::resource_usage::render_target);
+			add_barrier(color_permutation.color_tex, api::resource_usage::copy_dest, api::resource_usage::shader_resource);
+
+			color_permutation.color_tex_source = back_buffer_resource;
+		}
 
 #ifndef NDEBUG
 		cmd_list->begin_debug_event((pass.name.empty() ? "Pass " + std::to_string(pass_index) : pass.name).c_str());
 #endif
 
-		const uint32_t num_barriers = static_cast<uint32_t>(pass.modified_resources.size());
-
 		if (!pass.cs_entry_point.empty())
 		{
-			// Compute shaders do not write to the back buffer, so no update necessary
-			needs_implicit_back_buffer_copy = false;
-
+			// Compute shaders do not write to the back buffer, so the copy of it stays valid
 			cmd_list->bind_pipeline(api::pipeline_stage::all_compute, pass.pipeline);
 
-			temp_mem<api::resource_usage> state_old, state_new;
-			std::fill_n(state_old.p, num_barriers, api::resource_usage::shader_resource);
-			std::fill_n(state_new.p, num_barriers, api::resource_usage::unordered_access);
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_old.p, state_new.p);
+			for (const api::resource resource : pass.modified_resources)
+				add_barrier(resource, shader_resource_state, api::resource_usage::unordered_access);
+			flush_barriers();
 
-			// Reset bindings on every pass (since they get invalidated by the call to 'generate_mipmaps' below)
 			if (effect.cb != 0)
-				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, 0, permutation.cb_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_compute, permutation.layout, 0, permutation.cb_table);
 			if (permutation.sampler_table != 0)
 				assert(!sampler_with_resource_view),
-				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, 1, permutation.sampler_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_compute, permutation.layout, 1, permutation.sampler_table);
 			if (!pass.texture_bindings.empty())
-				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, sampler_with_resource_view ? 1 : 2, pass.texture_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_compute, permutation.layout, sampler_with_resource_view ? 1 : 2, pass.texture_table);
 			if (!pass.storage_bindings.empty())
-				cmd_list->bind_descriptor_table(api::shader_stage::all_compute, permutation.layout, sampler_with_resource_view ? 2 : 3, pass.storage_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_compute, permutation.layout, sampler_with_resource_view ? 2 : 3, pass.storage_table);
 
 			cmd_list->dispatch(pass.viewport_width, pass.viewport_height, pass.viewport_dispatch_z);
 
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_new.p, state_old.p);
+			for (const api::resource resource : pass.modified_resources)
+				add_barrier(resource, api::resource_usage::unordered_access, shader_resource_state);
 		}
 		else
 		{
 			cmd_list->bind_pipeline(api::pipeline_stage::all_graphics, pass.pipeline);
 
 			// Transition resource state for render targets
-			temp_mem<api::resource_usage> state_old, state_new;
-			std::fill_n(state_old.p, num_barriers, api::resource_usage::shader_resource);
-			std::fill_n(state_new.p, num_barriers, api::resource_usage::render_target);
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_old.p, state_new.p);
+			for (const api::resource resource : pass.modified_resources)
+				add_barrier(resource, api::resource_usage::shader_resource, api::resource_usage::render_target);
+			flush_barriers();
 
 			// Setup render targets
 			uint32_t render_target_count = 0;
@@ -4696,15 +5635,14 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 			if (pass.render_target_names[0].empty())
 			{
-				needs_implicit_back_buffer_copy = true;
+				// Invalidate the copy of the back buffer, so that the next pass sampling it updates it again
+				color_permutation.color_tex_source = {};
 
 				render_target[0].view = pass.srgb_write_enable ? back_buffer_rtv_srgb : back_buffer_rtv;
 				render_target_count = 1;
 			}
 			else
 			{
-				needs_implicit_back_buffer_copy = false;
-
 				for (int i = 0; i < 8 && pass.render_target_views[i] != 0; ++i, ++render_target_count)
 					render_target[i].view = pass.render_target_views[i];
 			}
@@ -4728,15 +5666,18 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 			cmd_list->begin_render_pass(render_target_count, render_target, depth_stencil.view != 0 ? &depth_stencil : nullptr);
 
-			// Reset bindings on every pass (since they get invalidated by the call to 'generate_mipmaps' below)
+			// Setting render targets in D3D9 resets the viewport to cover the entire render target
+			if (_renderer_id == 0x9000)
+				bind_state.invalidate_viewport_and_scissor_rect();
+
 			if (effect.cb != 0)
-				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, 0, permutation.cb_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_graphics, permutation.layout, 0, permutation.cb_table);
 			if (permutation.sampler_table != 0)
 				assert(!sampler_with_resource_view),
-				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, 1, permutation.sampler_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_graphics, permutation.layout, 1, permutation.sampler_table);
 			// Setup shader resources after binding render targets, to ensure any OM bindings by the application are unset at this point (e.g. a depth buffer that was bound to the OM and is now bound as shader resource)
 			if (!pass.texture_bindings.empty())
-				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, permutation.layout, sampler_with_resource_view ? 1 : 2, pass.texture_table);
+				bind_state.bind_descriptor_table(cmd_list, api::shader_stage::all_graphics, permutation.layout, sampler_with_resource_view ? 1 : 2, pass.texture_table);
 
 			const api::viewport viewport = {
 				0.0f, 0.0f,
@@ -4744,14 +5685,14 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 				static_cast<float>(pass.viewport_height),
 				0.0f, 1.0f
 			};
-			cmd_list->bind_viewports(0, 1, &viewport);
+			bind_state.bind_viewport(cmd_list, viewport);
 
 			const api::rect scissor_rect = {
 				0, 0,
 				static_cast<int32_t>(pass.viewport_width),
 				static_cast<int32_t>(pass.viewport_height)
 			};
-			cmd_list->bind_scissor_rects(0, 1, &scissor_rect);
+			bind_state.bind_scissor_rect(cmd_list, scissor_rect);
 
 			if (_renderer_id == 0x9000)
 			{
@@ -4792,18 +5733,32 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			cmd_list->end_render_pass();
 
 			// Transition resource state back to shader access
-			cmd_list->barrier(num_barriers, pass.modified_resources.data(), state_new.p, state_old.p);
+			for (const api::resource resource : pass.modified_resources)
+				add_barrier(resource, api::resource_usage::render_target, api::resource_usage::shader_resource);
 		}
 
 		// Generate mipmaps for modified resources
-		for (const api::resource_view modified_texture : pass.generate_mipmap_views)
-			cmd_list->generate_mipmaps(modified_texture);
+		if (!pass.generate_mipmap_views.empty())
+		{
+			flush_barriers();
+
+			for (const api::resource_view modified_texture : pass.generate_mipmap_views)
+				cmd_list->generate_mipmaps(modified_texture);
+
+			// Mipmap generation may be implemented with its own pipeline and bindings, which replace those of the effect
+			bind_state.invalidate();
+		}
 
 #ifndef NDEBUG
 		cmd_list->end_debug_event();
 #endif
 	}
 
+	flush_barriers();
+
+	_binds_issued += bind_state.issued;
+	_binds_skipped += bind_state.skipped;
+
 #ifndef NDEBUG
 	cmd_list->end_debug_event();
 #endif
@@ -4812,10 +5767,10 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	const std::chrono::high_resolution_clock::time_point time_technique_finished = std::chrono::high_resolution_clock::now();
 
 	tech.average_cpu_duration.append(std::chrono::duration_cast<std::chrono::nanoseconds>(time_technique_finished - time_technique_started).count());
+#endif
 
-	if (_gather_gpu_statistics && _timestamp_frequency != 0 && effect.query_heap != 0 && permutation_index == 0)
+	if (measure_gpu_duration)
 		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, tech.query_base_index + (_frame_count % 4) * 2 + 1);
-#endif
 
 #if RESHADE_ADDON
 	if (_is_in_api_call)
@@ -4824,8 +5779,158 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	_is_in_api_call = true;
 	invoke_addon_event<addon_event::reshade_render_technique>(const_cast<runtime *>(this), api::effect_technique { reinterpret_cast<uintptr_t>(&tech) }, cmd_list, back_buffer_rtv, back_buffer_rtv_srgb);
 	_is_in_api_call = false;
+
+	// Add-ons may have modified the back buffer in the callback above
+	if (has_addon_event<addon_event::reshade_render_technique>())
+		color_permutation.color_tex_source = {};
 #endif
 }
+void reshade::runtime::render_technique_async(technique &tech, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index)
+{
+	assert(_pending_barrier_resources.empty());
+
+	// Move resources into a state that is supported on the compute queue, unless that already happened for another technique that was not joined yet
+	for (const api::resource resource : tech.permutations[permutation_index].accessed_resources)
+	{
+		if (std::find(_async_compute_resources.cbegin(), _async_compute_resources.cend(), resource) != _async_compute_resources.cend())
+			continue;
+
+		_async_compute_resources.push_back(resource);
+
+		_pending_barrier_resources.push_back(resource);
+		_pending_barrier_state_old.push_back(api::resource_usage::shader_resource);
+		_pending_barrier_state_new.push_back(api::resource_usage::shader_resource_non_pixel);
+	}
+
+	if (!_pending_barrier_resources.empty())
+	{
+		cmd_list->barrier(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_state_old.data(), _pending_barrier_state_new.data());
+		_pending_barrier_resources.clear();
+		_pending_barrier_state_old.clear();
+		_pending_barrier_state_new.clear();
+	}
+
+	// Make the compute queue wait for all preceding work on the graphics queue, which produced the inputs of this technique (signaling also submits the commands recorded on the graphics queue so far)
+	_async_compute_begin_value++;
+
+	if (!_graphics_queue->signal(_async_compute_begin_fence, _async_compute_begin_value) ||
+		!_compute_queue->wait(_async_compute_begin_fence, _async_compute_begin_value))
+	{
+		// Cannot start the compute work without its dependency, so render the technique on the graphics queue instead (after moving its resources back into the graphics queue state)
+		join_async_compute(cmd_list);
+		render_technique(tech, cmd_list, back_buffer_resource, back_buffer_rtv, back_buffer_rtv_srgb, permutation_index);
+		return;
+	}
+
+	render_technique(tech, _compute_queue->get_immediate_command_list(), back_buffer_resource, back_buffer_rtv, back_buffer_rtv_srgb, permutation_index);
+
+	// Submit the commands recorded for this technique, the graphics queue waits on this signal before accessing any of its resources again (see 'join_async_compute')
+	_async_compute_end_value++;
+
+	if (!_compute_queue->signal(_async_compute_end_fence, _async_compute_end_value))
+	{
+		// The graphics queue would wait forever for a value that is never signaled, so wait for the compute queue on the CPU instead and only have it wait for what was signaled before
+		_compute_queue->wait_idle();
+		_async_compute_end_value--;
+	}
+}
+void reshade::runtime::join_async_compute(api::command_list *cmd_list)
+{
+	if (_async_compute_resources.empty())
+		return;
+
+	// Commands recorded so far do not depend on the work on the compute queue, so submit them before the wait, so that they can still overlap with it
+	_graphics_queue->flush_immediate_command_list();
+	_graphics_queue->wait(_async_compute_end_fence, _async_compute_end_value);
+
+	assert(_pending_barrier_resources.empty());
+
+	for (const api::resource resource : _async_compute_resources)
+	{
+		_pending_barrier_resources.push_back(resource);
+		_pending_barrier_state_old.push_back(api::resource_usage::shader_resource_non_pixel);
+		_pending_barrier_state_new.push_back(api::resource_usage::shader_resource);
+	}
+
+	cmd_list->barrier(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_state_old.data(), _pending_barrier_state_new.data());
+	_pending_barrier_resources.clear();
+	_pending_barrier_state_old.clear();
+	_pending_barrier_state_new.clear();
+
+	_async_compute_resources.clear();
+}
+void reshade::runtime::update_technique_governor()
+{
+	// Only adjust every few frames, so that the moving averages of the GPU durations have time to reflect the previous adjustment
+	if (_gpu_time_budget <= 0.0f || _timestamp_frequency == 0 || (_frame_count % 30) != 0)
+		return;
+
+	uint64_t total_gpu_duration = 0;
+	technique *most_expensive_technique = nullptr;
+	technique *most_reduced_technique = nullptr;
+
+	for (technique &tech : _techniques)
+	{
+		if (!tech.enabled)
+			continue;
+
+		total_gpu_duration += tech.average_gpu_duration;
+
+		if (tech.governor_update_rate < 8 && (most_expensive_technique == nullptr || tech.average_gpu_duration > most_expensive_technique->average_gpu_duration))
+			most_expensive_technique = &tech;
+		if (tech.governor_update_rate > 1 && (most_reduced_technique == nullptr || tech.governor_update_rate > most_reduced_technique->governor_update_rate))
+			most_reduced_technique = &tech;
+	}
+
+	const uint64_t budget = static_cast<uint64_t>(_gpu_time_budget * 1000000.0f);
+
+	// Halve the update rate of the most expensive technique while over budget, and only restore update rates once there is enough headroom to avoid oscillating between the two
+	if (total_gpu_duration > budget && most_expensive_technique != nullptr)
+		most_expensive_technique->governor_update_rate *= 2;
+	else if (total_gpu_duration < budget / 2 && most_reduced_technique != nullptr)
+		most_reduced_technique->governor_update_rate /= 2;
+}
+bool reshade::runtime::is_aliased_texture_resource(api::resource resource) const
+{
+	return std::any_of(_textures.cbegin(), _textures.cend(),
+		[resource](const texture &item) {
+			return item.resource == resource && item.shared.size() > 1 && (item.transient || item.pooled);
+		});
+}
+void reshade::runtime::update_aliased_texture_flags(technique &tech, size_t permutation_index) const
+{
+	technique::permutation &tech_permutation = tech.permutations[permutation_index];
+
+	tech_permutation.accesses_aliased_texture = false;
+
+	for (technique::pass &pass : tech_permutation.passes)
+	{
+		pass.modifies_aliased_texture = std::any_of(pass.modified_resources.cbegin(), pass.modified_resources.cend(), [this](api::resource resource) { return is_aliased_texture_resource(resource); });
+
+		tech_permutation.accesses_aliased_texture |= pass.modifies_aliased_texture ||
+			std::any_of(pass.sampled_resources.cbegin(), pass.sampled_resources.cend(), [this](api::resource resource) { return is_aliased_texture_resource(resource); });
+	}
+}
+void reshade::runtime::unalias_persistent_textures()
+{
+	// A texture stops being transient when an effect that depends on its contents starts sharing it by name, which can happen after other effects were already aliased with it (depending on the order in which effects finish loading)
+	// Those have to get a dedicated texture again, which requires updating the texture references in their modules, so simply reload them (which aliases them with another transient texture if there is one)
+	for (texture &tex : _textures)
+	{
+		if (tex.transient || tex.aliased.empty())
+			continue;
+
+		for (const size_t effect_index : tex.aliased)
+		{
+			tex.shared.erase(std::remove(tex.shared.begin(), tex.shared.end(), effect_index), tex.shared.end());
+
+			if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), std::make_pair(effect_index, size_t(0))) == _reload_required_effects.cend())
+				_reload_required_effects.emplace_back(effect_index, 0);
+		}
+
+		tex.aliased.clear();
+	}
+}
 
 void reshade::runtime::save_texture(const texture &tex)
 {
@@ -5415,7 +6520,7 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 		const bool include_preset =
 			_screenshot_include_preset &&
 			postfix != "Before" && postfix != "Overlay" &&
-			ini_file::flush_cache(_current_preset_path);
+			ini_file::flush_cache(_current_preset_path, false);
 
 		// Play screenshot sound
 		if (!_screenshot_sound_path.empty())
@@ -5480,12 +6585,12 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 			{
 				execute_screenshot_post_save_command(screenshot_path, screenshot_count, postfix);
 
-				if (include_preset)
+				// Preset was queued for writing to disk, so can just copy it over to the new location once that finished
+				if (include_preset && ini_file::wait_for_flush(_current_preset_path))
 				{
 					std::filesystem::path screenshot_preset_path = screenshot_path;
 					screenshot_preset_path.replace_extension(L".ini");
 
-					// Preset was flushed to disk, so can just copy it over to the new location
 					if (!std::filesystem::copy_file(_current_preset_path, screenshot_preset_path, std::filesystem::copy_options::overwrite_existing, ec))
 						log::message(log::level::error, "Failed to copy preset file for screenshot to '%s' with error code %d!", screenshot_preset_path.u8string().c_str(), ec.value());
 				}
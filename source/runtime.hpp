@@ -8,10 +8,12 @@
 #include "reshade_api.hpp"
 #include "state_block.hpp"
 #include "imgui_code_editor.hpp"
+#include "preset_catalog.hpp"
 #include <chrono>
 #include <memory>
 #include <filesystem>
 #include <atomic>
+#include <mutex>
 #include <shared_mutex>
 
 class ini_file;
@@ -23,6 +25,8 @@ namespace reshade
 	struct uniform;
 	struct texture;
 	struct technique;
+	struct compiled_effect_variant;
+	enum class effect_load_phase;
 
 	/// <summary>
 	/// The main ReShade post-processing effect runtime.
@@ -181,6 +185,7 @@ namespace reshade
 		bool check_preset_feature(int feature) const;
 		void load_current_preset();
 		void save_current_preset(ini_file &preset) const;
+		void update_preset_transition();
 		void aurora4_clean_preset(ini_file &preset);
 		void detach_current_flair() const;
 
@@ -188,6 +193,7 @@ namespace reshade
 
 		bool load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, size_t permutation_index, bool force_load = false, bool preprocess_required = false);
 		bool create_effect(size_t effect_index, size_t permutation_index);
+		bool create_effect_pipelines(size_t effect_index, size_t permutation_index);
 		bool create_effect_sampler_state(const reshadefx::sampler_desc &desc, api::sampler &sampler);
 		void destroy_effect(size_t effect_index);
 
@@ -208,11 +214,26 @@ namespace reshade
 		bool load_effect_cache(const std::string &id, const std::string &type, std::string &data) const;
 		bool save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const;
 		void clear_effect_cache();
+		void record_load_timing(effect &effect, effect_load_phase phase, size_t permutation_index, std::chrono::high_resolution_clock::time_point start);
+		void save_effect_load_trace() const;
+
+		auto find_effect_variant(size_t variant_hash) -> std::shared_ptr<const compiled_effect_variant>;
+		void add_effect_variant(size_t variant_hash, std::shared_ptr<const compiled_effect_variant> &&variant);
+
+		void load_pipeline_cache();
+		void save_pipeline_cache();
+		std::string pipeline_cache_id() const;
 
 		auto add_effect_permutation(uint32_t width, uint32_t height, api::format color_format, api::format stencil_format, api::color_space color_space) -> size_t;
 
 		void update_effects();
 		void render_technique(technique &technique, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index);
+		void render_technique_async(technique &technique, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index);
+		void join_async_compute(api::command_list *cmd_list);
+		void update_technique_governor();
+		bool is_aliased_texture_resource(api::resource resource) const;
+		void update_aliased_texture_flags(technique &tech, size_t permutation_index) const;
+		void unalias_persistent_textures();
 
 		void save_texture(const texture &texture);
 		void update_texture(texture &texture, uint32_t width, uint32_t height, uint32_t depth, const void *pixels);
@@ -290,6 +311,7 @@ namespace reshade
 		bool _performance_mode = false;
 		bool _effect_load_skipping = false;
 		unsigned int _effect_load_delay = 0;
+		unsigned int _effect_create_budget = 0;
 		unsigned int _reload_key_data[4] = {};
 		unsigned int _performance_mode_key_data[4] = {};
 		bool _ui_bind_support = true;
@@ -301,12 +323,21 @@ namespace reshade
 		std::vector<std::pair<size_t, size_t>> _reload_required_effects;
 
 		std::filesystem::path _effect_cache_path;
+		std::filesystem::path _effect_load_trace_path;
+		std::mutex _load_timings_mutex;
+		uint32_t _pipeline_cache_generation = 0;
+		size_t _pipeline_cache_hash = 0;
+		unsigned int _effect_variant_cache_size = 128; // In MiB, zero disables the cache
+		size_t _effect_variant_cache_used = 0;
+		std::vector<std::pair<size_t, std::shared_ptr<const compiled_effect_variant>>> _effect_variant_cache; // Ordered from most to least recently used
+		std::mutex _effect_variant_cache_mutex;
 		std::vector<std::filesystem::path> _effect_search_paths;
 		std::vector<std::filesystem::path> _texture_search_paths;
 
 		std::atomic<bool> _last_reload_successful = true;
 		std::shared_mutex _reload_mutex;
 		std::vector<std::pair<size_t, size_t>> _reload_create_queue;
+		std::unordered_map<size_t, std::shared_ptr<const compiled_effect_variant>> _duplicate_effect_variants; // Compilation results of finished base effects, protected by '_reload_mutex'
 		std::atomic<size_t> _reload_remaining_effects = std::numeric_limits<size_t>::max();
 		void *_d3d_compiler_module = nullptr;
 
@@ -333,6 +364,7 @@ namespace reshade
 			api::format color_format = api::format::unknown;
 			api::resource color_tex = {};
 			api::resource_view color_srv[2] = {};
+			api::resource color_tex_source = {}; // Back buffer that the color texture currently holds an up-to-date copy of
 			api::format stencil_format = api::format::unknown;
 			api::resource stencil_tex = {};
 			api::resource_view stencil_dsv = {};
@@ -357,8 +389,29 @@ namespace reshade
 
 		api::state_block _app_state = {};
 
+		std::vector<api::resource> _pending_barrier_resources;
+		std::vector<api::resource_usage> _pending_barrier_state_old;
+		std::vector<api::resource_usage> _pending_barrier_state_new;
+
 		api::fence _queue_sync_fence = {};
 		uint64_t _queue_sync_value = 0;
+
+		bool _async_compute = false;
+		api::command_queue *_compute_queue = nullptr; // Only created once async compute is first used
+		api::fence _async_compute_begin_fence = {};
+		api::fence _async_compute_end_fence = {};
+		uint64_t _async_compute_begin_value = 0;
+		uint64_t _async_compute_end_value = 0;
+		std::vector<api::resource> _async_compute_resources; // Resources accessed by techniques that were submitted to the compute queue and not joined with the graphics queue yet
+
+		float _gpu_time_budget = 0.0f; // Time in milliseconds that rendering effects may take on the GPU each frame before the governor starts to reduce technique update rates (zero to disable)
+		uint64_t _timestamp_frequency = 0;
+
+		// Number of pipeline state binds issued and skipped as redundant while rendering effects in the current and last frame
+		uint32_t _binds_issued = 0;
+		uint32_t _binds_skipped = 0;
+		uint32_t _last_frame_binds_issued = 0;
+		uint32_t _last_frame_binds_skipped = 0;
 		#pragma endregion
 
 		#pragma region Screenshot
@@ -400,12 +453,26 @@ namespace reshade
 		bool _is_in_preset_transition = false;
 		std::chrono::high_resolution_clock::time_point _last_preset_switching_time;
 
+		// Floating-point uniform values are resolved once when a transition starts, so that every frame of the transition only has to interpolate between them
+		struct preset_transition_value
+		{
+			size_t effect_index;
+			uint32_t offset; // Byte offset into the uniform data storage of the effect
+			float from;
+			float to;
+		};
+		std::vector<preset_transition_value> _preset_transition_values;
+		std::chrono::high_resolution_clock::time_point _preset_transition_values_time;
+		unsigned int _preset_transition_curve = 0; // 0 = linear, 1 = ease in and out, 2 = ease out
+
 		struct preset_shortcut
 		{
 			std::filesystem::path preset_path;
 			unsigned int key_data[4] = {};
 		};
 		std::vector<preset_shortcut> _preset_shortcuts;
+
+		preset_catalog _preset_catalog;
 		#pragma endregion
 
 #if RESHADE_GUI
@@ -491,6 +558,8 @@ namespace reshade
 		bool _preset_is_modified = false;
 		bool _inherit_current_preset = false;
 		std::filesystem::path _template_preset_path;
+		std::filesystem::path _preset_browser_directory;
+		std::vector<std::filesystem::path> _preset_browser_invalid_paths;
 		bool _was_preprocessor_popup_edited = false;
 		size_t _focused_effect = std::numeric_limits<size_t>::max();
 		size_t opened_effect_tab = std::numeric_limits<size_t>::max();
@@ -526,13 +595,12 @@ namespace reshade
 		bool _gather_gpu_statistics = false;
 		api::resource_view _preview_texture = {};
 		unsigned int _preview_size[3] = { 0, 0, 0xFFFFFFFF };
-		uint64_t _timestamp_frequency = 0;
 		#pragma endregion
 
 		#pragma region Overlay Log
 		char _log_filter[32] = {};
 		bool _log_wordwrap = false;
-		uintmax_t _last_log_size;
+		size_t _log_next_line = 0;
 		std::vector<std::string> _log_lines;
 		#pragma endregion
 
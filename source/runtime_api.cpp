@@ -8,7 +8,7 @@
 #include "ini_file.hpp"
 #include "addon_manager.hpp"
 #include "input.hpp"
-#include <algorithm> // std::all_of, std::find, std::find_if, std::for_each, std::remove_if
+#include <algorithm> // std::all_of, std::any_of, std::find, std::find_if, std::for_each, std::remove_if
 
 extern bool resolve_path(std::filesystem::path &path, std::error_code &ec);
 extern bool resolve_preset_path(std::filesystem::path &path, std::error_code &ec);
@@ -218,9 +218,7 @@ bool reshade::runtime::get_annotation_bool_from_uniform_variable(api::effect_uni
 		const uniform &variable = *reinterpret_cast<const uniform *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_int(name, i + array_index) != 0;
@@ -239,9 +237,7 @@ bool reshade::runtime::get_annotation_float_from_uniform_variable(api::effect_un
 		const uniform &variable = *reinterpret_cast<const uniform *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_float(name, i + array_index);
@@ -260,9 +256,7 @@ bool reshade::runtime::get_annotation_int_from_uniform_variable(api::effect_unif
 		const uniform &variable = *reinterpret_cast<const uniform *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_int(name, array_index + i);
@@ -281,9 +275,7 @@ bool reshade::runtime::get_annotation_uint_from_uniform_variable(api::effect_uni
 		const uniform &variable = *reinterpret_cast<const uniform *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_uint(name, array_index + i);
@@ -302,9 +294,7 @@ bool reshade::runtime::get_annotation_string_from_uniform_variable(api::effect_u
 		const uniform &variable = *reinterpret_cast<const uniform *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			const std::string_view annotation = variable.annotation_as_string(name);
 
@@ -563,9 +553,7 @@ bool reshade::runtime::get_annotation_bool_from_texture_variable(api::effect_tex
 		const texture &variable = *reinterpret_cast<const texture *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_int(name, array_index + i) != 0;
@@ -584,9 +572,7 @@ bool reshade::runtime::get_annotation_float_from_texture_variable(api::effect_te
 		const texture &variable = *reinterpret_cast<const texture *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_float(name, array_index + i);
@@ -605,9 +591,7 @@ bool reshade::runtime::get_annotation_int_from_texture_variable(api::effect_text
 		const texture &variable = *reinterpret_cast<const texture *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_int(name, array_index + i);
@@ -626,9 +610,7 @@ bool reshade::runtime::get_annotation_uint_from_texture_variable(api::effect_tex
 		const texture &variable = *reinterpret_cast<const texture *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = variable.annotation_as_uint(name, array_index + i);
@@ -647,9 +629,7 @@ bool reshade::runtime::get_annotation_string_from_texture_variable(api::effect_t
 		const texture &variable = *reinterpret_cast<const texture *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(variable.annotations.cbegin(), variable.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != variable.annotations.cend())
+		if (variable.annotation_lookup.find(variable.annotations, name) != nullptr)
 		{
 			const std::string_view annotation = variable.annotation_as_string(name);
 
@@ -786,6 +766,41 @@ void reshade::runtime::update_texture_bindings(const char *semantic, api::resour
 	if (descriptor_writes.empty())
 		return; // Avoid waiting on graphics queue when nothing changes
 
+	// Add-ons may bind the back buffer copy to this semantic or replace it, so update which passes need the back buffer copied before them (see 'load_effect')
+	for (technique &tech : _techniques)
+	{
+		const effect &effect_data = _effects[tech.effect_index];
+		if (!effect_data.compiled)
+			continue;
+
+		for (size_t permutation_index = 0; permutation_index < _effect_permutations.size(); ++permutation_index)
+		{
+			if (permutation_index >= effect_data.permutations.size() || permutation_index >= tech.permutations.size())
+				break;
+
+			const effect_permutation &color_permutation = _effect_permutations[permutation_index];
+			const std::vector<effect::binding> &bindings = effect_data.permutations[permutation_index].texture_semantic_to_binding;
+
+			for (technique::pass &pass : tech.permutations[permutation_index].passes)
+			{
+				if (!pass.samples_semantic_texture)
+					continue;
+
+				pass.reads_back_buffer = std::any_of(bindings.cbegin(), bindings.cend(),
+					[this, &pass, &color_permutation](const effect::binding &binding) {
+						if (binding.table != pass.texture_table)
+							return false;
+						if (binding.semantic == "COLOR")
+							return true;
+						const auto it = _texture_semantic_bindings.find(binding.semantic);
+						return it != _texture_semantic_bindings.end() &&
+							(it->second.first == color_permutation.color_srv[0] || it->second.first == color_permutation.color_srv[1] ||
+							 it->second.second == color_permutation.color_srv[0] || it->second.second == color_permutation.color_srv[1]);
+					});
+			}
+		}
+	}
+
 	// Make sure all previous frames have finished before updating descriptors (since they may be in use otherwise)
 	if (_is_initialized && (_device->get_api() == api::device_api::d3d12 || _device->get_api() == api::device_api::vulkan))
 		_graphics_queue->wait_idle();
@@ -889,9 +904,7 @@ bool reshade::runtime::get_annotation_bool_from_technique(api::effect_technique
 		const auto& tech = *reinterpret_cast<const technique *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != tech.annotations.cend())
+		if (tech.annotation_lookup.find(tech.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = tech.annotation_as_int(name, array_index + i) != 0;
@@ -910,9 +923,7 @@ bool reshade::runtime::get_annotation_float_from_technique(api::effect_technique
 		const auto &tech = *reinterpret_cast<const technique *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != tech.annotations.cend())
+		if (tech.annotation_lookup.find(tech.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = tech.annotation_as_float(name, array_index + i);
@@ -931,9 +942,7 @@ bool reshade::runtime::get_annotation_int_from_technique(api::effect_technique h
 		const auto &tech = *reinterpret_cast<const technique *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != tech.annotations.cend())
+		if (tech.annotation_lookup.find(tech.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = tech.annotation_as_int(name, array_index + i);
@@ -952,9 +961,7 @@ bool reshade::runtime::get_annotation_uint_from_technique(api::effect_technique
 		const auto &tech = *reinterpret_cast<const technique *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != tech.annotations.cend())
+		if (tech.annotation_lookup.find(tech.annotations, name) != nullptr)
 		{
 			for (size_t i = 0; i < count; ++i)
 				values[i] = tech.annotation_as_uint(name, array_index + i);
@@ -973,9 +980,7 @@ bool reshade::runtime::get_annotation_string_from_technique(api::effect_techniqu
 		const auto &tech = *reinterpret_cast<const technique *>(handle.handle);
 		const std::string_view name(name_in);
 
-		if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
-				[&](const reshadefx::annotation &annotation) { return annotation.name == name; });
-			it != tech.annotations.cend())
+		if (tech.annotation_lookup.find(tech.annotations, name) != nullptr)
 		{
 			const std::string_view annotation = tech.annotation_as_string(name);
 
@@ -1382,6 +1387,9 @@ void reshade::runtime::render_technique(api::effect_technique handle, api::comma
 	_is_in_api_call = true;
 #endif
 
+	// Cannot know what happened to the back buffer since the last call, so always copy it again
+	_effect_permutations[permutation_index].color_tex_source = {};
+
 	render_technique(*tech, cmd_list, back_buffer_resource, rtv, rtv_srgb, permutation_index);
 
 #if RESHADE_ADDON
@@ -25,7 +25,7 @@
 #include <cctype> // std::tolower
 #include <cstdlib> // std::lldiv, std::strtol
 #include <cstring> // std::memcmp, std::memcpy
-#include <algorithm> // std::any_of, std::count_if, std::find, std::find_if, std::max, std::min, std::replace, std::rotate, std::search, std::swap, std::transform
+#include <algorithm> // std::any_of, std::count_if, std::fill_n, std::find, std::find_if, std::max, std::min, std::replace, std::rotate, std::search, std::sort, std::swap, std::transform
 #include <stb_image.h>
 
 extern bool resolve_path(std::filesystem::path &path, std::error_code &ec);
@@ -1860,6 +1860,7 @@ void reshade::runtime::draw_gui_home()
 		if (ImGui::ButtonEx((_current_preset_path.stem().u8string() + "###browse_button").c_str(), ImVec2(browse_button_width, 0), ImGuiButtonFlags_NoNavFocus))
 		{
 			_file_selection_path = _current_preset_path;
+			_preset_browser_directory.clear(); // Scan the directory again every time the browser is opened, in case files were changed in the meantime
 			ImGui::OpenPopup("##browse");
 		}
 		if (_show_preset_description && !_description.empty() && ImGui::IsItemHovered(ImGuiHoveredFlags_ForTooltip))
@@ -2037,13 +2038,31 @@ void reshade::runtime::draw_gui_home()
 		}
 
 		ImGui::SetNextWindowPos(browse_button_pos + ImVec2(-_imgui_context->Style.WindowPadding.x, ImGui::GetFrameHeightWithSpacing()));
-		if (imgui::file_dialog("##browse", _file_selection_path, std::max(browse_button_width, 24.0f * _font_size), { L".ini", L".txt" }, { _config_path, g_reshade_base_path / L"ReShade.ini" }))
+		std::vector<std::filesystem::path> hidden_paths = { _config_path, g_reshade_base_path / L"ReShade.ini" };
+		// Only list files that are presets, which the preset catalog knows without having to load them
+		// The scan is only repeated when the browser is opened or navigates to another directory, rather than every frame
+		if (ImGui::IsPopupOpen("##browse") && !_file_selection_path.empty())
+		{
+			if (_preset_browser_directory.empty() || _file_selection_path.parent_path() != _preset_browser_directory)
+			{
+				_preset_browser_directory = _file_selection_path.parent_path();
+				_preset_browser_invalid_paths.clear();
+
+				for (preset_catalog::entry &entry : _preset_catalog.scan(_preset_browser_directory))
+					if (!entry.valid)
+						_preset_browser_invalid_paths.push_back(std::move(entry.path));
+			}
+
+			hidden_paths.insert(hidden_paths.end(), _preset_browser_invalid_paths.cbegin(), _preset_browser_invalid_paths.cend());
+		}
+
+		if (imgui::file_dialog("##browse", _file_selection_path, std::max(browse_button_width, 24.0f * _font_size), { L".ini", L".txt" }, hidden_paths))
 		{
 			std::error_code ec;
 			resolve_path(_file_selection_path, ec);
 
 			// Check that this is actually a valid preset file
-			if (ini_file::load_cache(_file_selection_path).has({}, "Techniques"))
+			if (_preset_catalog.is_valid_preset(_file_selection_path))
 			{
 				reload_preset = true;
 				ini_file::clear_cache(_current_preset_path);
@@ -2051,7 +2070,6 @@ void reshade::runtime::draw_gui_home()
 			}
 			else
 			{
-				ini_file::clear_cache(_file_selection_path);
 				ImGui::OpenPopup("##preseterror");
 			}
 		}
@@ -2596,6 +2614,15 @@ void reshade::runtime::draw_gui_settings()
 				"Recommended for multiple presets that contain the same effects, otherwise set this to zero.\n"
 				"Values are in milliseconds."));
 
+			ImGui::BeginDisabled(_preset_transition_duration == 0);
+			std::string preset_transition_curve_items = _(
+				"Linear\n"
+				"Ease in and out\n"
+				"Ease out\n");
+			std::replace(preset_transition_curve_items.begin(), preset_transition_curve_items.end(), '\n', '\0');
+			modified |= ImGui::Combo(_("Preset transition curve"), reinterpret_cast<int *>(&_preset_transition_curve), preset_transition_curve_items.c_str());
+			ImGui::EndDisabled();
+
 			ImGui::Spacing();
 		}
 
@@ -2617,6 +2644,33 @@ void reshade::runtime::draw_gui_settings()
 			_effect_load_delay = std::max<int>(_effect_load_delay, 0);
 		}
 
+		if (ImGui::SliderInt(_("Effect creation budget"), reinterpret_cast<int *>(&_effect_create_budget), 0, 100, "%d ms"))
+		{
+			modified = true;
+			_effect_create_budget = std::max<int>(_effect_create_budget, 0);
+		}
+		ImGui::SetItemTooltip(_("Time per frame that may be spent on creating the resources and pipelines of loaded effects.\nAt least one effect is created every frame, regardless of this value."));
+
+		if (ImGui::SliderInt(_("Compiled effect memory cache"), reinterpret_cast<int *>(&_effect_variant_cache_size), 0, 1024, _effect_variant_cache_size != 0 ? "%d MiB" : _("Disabled")))
+		{
+			modified = true;
+			_effect_variant_cache_size = std::max<int>(_effect_variant_cache_size, 0);
+		}
+		ImGui::SetItemTooltip(_("Amount of memory that may be used to keep recently compiled effects around.\nSwitching to a preset with preprocessor definitions that were used recently then skips preprocessing and compiling the affected effects."));
+
+		if (ImGui::SliderFloat(_("Effect GPU time budget"), &_gpu_time_budget, 0.0f, 33.0f, _gpu_time_budget > 0.0f ? "%.1f ms" : _("Disabled")))
+		{
+			modified = true;
+			_gpu_time_budget = std::max(_gpu_time_budget, 0.0f);
+		}
+		ImGui::SetItemTooltip(_("Time per frame that rendering effects may take on the GPU.\nWhen exceeded, the update rate of the most expensive techniques is reduced automatically until rendering fits the budget again."));
+
+		if (_device->get_api() == api::device_api::d3d12 && !_is_vr)
+		{
+			modified |= ImGui::Checkbox(_("Render compute techniques asynchronously"), &_async_compute);
+			ImGui::SetItemTooltip(_("Executes techniques that only consist of compute passes on a separate compute queue, so that they can overlap with the graphics passes of other techniques."));
+		}
+
 		modified |= ImGui::Checkbox(_("Do not load effects when startup"), &_no_reload_on_init);
 
 		if (ImGui::Checkbox(_("Load only enabled effects"), &_effect_load_skipping))
@@ -3045,6 +3099,8 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::TextUnformatted(_("Resolution:"));
 		ImGui::Text(_("Frame %llu:"), _frame_count + 1);
 		ImGui::TextUnformatted(_("Post-Processing:"));
+		ImGui::TextUnformatted(_("Preset Save:"));
+		ImGui::TextUnformatted(_("Preset Cache:"));
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
@@ -3083,6 +3139,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%ux%u", _effect_permutations[0].width, _effect_permutations[0].height);
 		ImGui::Text("%.2f fps", _imgui_context->IO.Framerate);
 		ImGui::Text("%*.3f ms CPU", cpu_digits + 4, post_processing_time_cpu * 1e-6f);
+		ImGui::Text("%.3f ms", ini_file::last_flush_latency().count() * 1e-3f);
+		const ini_file::cache_statistics ini_cache_stats = ini_file::get_cache_statistics();
+		ImGui::Text("%llu hits, %llu misses, %llu reloads", ini_cache_stats.hits, ini_cache_stats.misses, ini_cache_stats.reloads);
 
 		ImGui::EndGroup();
 		ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
@@ -3170,6 +3229,70 @@ void reshade::runtime::draw_gui_statistics()
 		}
 
 		ImGui::EndGroup();
+
+		ImGui::Text(_("Redundant binds skipped: %u of %u"), _last_frame_binds_skipped, _last_frame_binds_skipped + _last_frame_binds_issued);
+	}
+
+	if (ImGui::CollapsingHeader(_("Effect Loading")) && !is_loading())
+	{
+		constexpr size_t num_phases = static_cast<size_t>(effect_load_phase::count);
+
+		struct effect_load_statistics
+		{
+			size_t effect_index;
+			float total_duration;
+			float phase_durations[num_phases];
+		};
+
+		std::vector<effect_load_statistics> load_statistics;
+		for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+		{
+			if (_effects[effect_index].load_timings.empty())
+				continue;
+
+			effect_load_statistics &statistics = load_statistics.emplace_back();
+			statistics.effect_index = effect_index;
+			statistics.total_duration = 0.0f;
+			std::fill_n(statistics.phase_durations, num_phases, 0.0f);
+
+			for (const effect::load_timing &timing : _effects[effect_index].load_timings)
+			{
+				const float duration = std::chrono::duration_cast<std::chrono::nanoseconds>(timing.end - timing.start).count() * 1e-6f;
+				statistics.total_duration += duration;
+				statistics.phase_durations[static_cast<size_t>(timing.phase)] += duration;
+			}
+		}
+
+		// Show the effects that took the longest to load first
+		std::sort(load_statistics.begin(), load_statistics.end(),
+			[](const effect_load_statistics &lhs, const effect_load_statistics &rhs) { return lhs.total_duration > rhs.total_duration; });
+
+		if (ImGui::BeginTable("##load_timings", static_cast<int>(2 + num_phases), ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_ScrollX))
+		{
+			ImGui::TableSetupColumn(_("Effect"));
+			ImGui::TableSetupColumn(_("Total"));
+			for (size_t phase = 0; phase < num_phases; ++phase)
+				ImGui::TableSetupColumn(effect_load_phase_name(static_cast<effect_load_phase>(phase)));
+			ImGui::TableHeadersRow();
+
+			for (const effect_load_statistics &statistics : load_statistics)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(_effects[statistics.effect_index].source_file.filename().u8string().c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f ms", statistics.total_duration);
+
+				for (size_t phase = 0; phase < num_phases; ++phase)
+				{
+					ImGui::TableNextColumn();
+					if (statistics.phase_durations[phase] != 0.0f)
+						ImGui::Text("%.3f ms", statistics.phase_durations[phase]);
+				}
+			}
+
+			ImGui::EndTable();
+		}
 	}
 
 	if (ImGui::CollapsingHeader(_("Render Targets & Textures"), ImGuiTreeNodeFlags_DefaultOpen) && !is_loading())
@@ -3193,6 +3316,7 @@ void reshade::runtime::draw_gui_statistics()
 		// Variables used to calculate memory size of textures
 		lldiv_t memory_view;
 		int64_t post_processing_memory_size = 0;
+		int64_t pooled_memory_size = 0;
 		const char *memory_size_unit;
 
 		for (const texture &tex : _textures)
@@ -3211,6 +3335,10 @@ void reshade::runtime::draw_gui_statistics()
 
 			post_processing_memory_size += memory_size;
 
+			// Every additional effect using a pooled texture would otherwise have allocated its own copy
+			if (tex.transient || tex.pooled)
+				pooled_memory_size += memory_size * static_cast<int64_t>(tex.shared.size() - 1);
+
 			if (memory_size >= 1024 * 1024)
 			{
 				memory_view = std::lldiv(memory_size, 1024 * 1024);
@@ -3222,7 +3350,7 @@ void reshade::runtime::draw_gui_statistics()
 				memory_view = std::lldiv(memory_size, 1024);
 				memory_size_unit = "KiB";
 			}
-			ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_Text), "%s%s", tex.unique_name.c_str(), tex.shared.size() > 1 ? " (pooled)" : "");
+			ImGui::TextColored(ImGui::GetStyleColorVec4(ImGuiCol_Text), "%s%s", tex.unique_name.c_str(), tex.shared.size() > 1 ? (tex.transient ? " (aliased)" : " (pooled)") : "");
 			switch (tex.type)
 			{
 			case reshadefx::texture_type::texture_1d:
@@ -3425,6 +3553,23 @@ void reshade::runtime::draw_gui_statistics()
 		}
 
 		ImGui::Text(_("Total memory usage: %lld.%03lld %s"), memory_view.quot, memory_view.rem, memory_size_unit);
+
+		if (pooled_memory_size != 0)
+		{
+			if (pooled_memory_size >= 1024 * 1024)
+			{
+				memory_view = std::lldiv(pooled_memory_size, 1024 * 1024);
+				memory_view.rem /= 1000;
+				memory_size_unit = "MiB";
+			}
+			else
+			{
+				memory_view = std::lldiv(pooled_memory_size, 1024);
+				memory_size_unit = "KiB";
+			}
+
+			ImGui::Text(_("Memory saved by texture pooling: %lld.%03lld %s"), memory_view.quot, memory_view.rem, memory_size_unit);
+		}
 	}
 }
 void reshade::runtime::draw_gui_log()
@@ -3442,30 +3587,32 @@ void reshade::runtime::draw_gui_log()
 	ImGui::SameLine();
 
 	if (ImGui::Button(_("Clear Log"), ImVec2(8.0f * _font_size, 0.0f)))
+	{
 		// Close and open the stream again, which will clear the file too
 		log::open_log_file(log_path, ec);
+		_log_lines.clear();
+	}
 
 	ImGui::Spacing();
 
 	if (ImGui::BeginChild("##log", ImVec2(0, -(ImGui::GetFrameHeightWithSpacing() + _imgui_context->Style.ItemSpacing.y)), ImGuiChildFlags_Borders, _log_wordwrap ? 0 : ImGuiWindowFlags_AlwaysHorizontalScrollbar))
 	{
-		const uintmax_t file_size = std::filesystem::file_size(log_path, ec);
-		if (filter_changed || _last_log_size != file_size)
+		// Only need to filter all lines again when the filter changed, otherwise just filter the lines that were logged since the last frame
+		if (filter_changed)
 		{
 			_log_lines.clear();
+			_log_next_line = 0;
+		}
 
-			if (FILE *const file = _wfsopen(log_path.c_str(), L"r", SH_DENYNO))
-			{
-				char line_data[2048];
-				while (fgets(line_data, sizeof(line_data), file))
-					if (string_contains(line_data, _log_filter))
-						_log_lines.push_back(line_data);
-
-				fclose(file);
-			}
+		std::vector<std::string> new_log_lines;
+		log::get_recent_lines(_log_next_line, new_log_lines);
+		for (std::string &line : new_log_lines)
+			if (string_contains(line, _log_filter))
+				_log_lines.push_back(std::move(line));
 
-			_last_log_size = file_size;
-		}
+		// Drop the oldest lines, so that this does not keep growing while the log window is open
+		if (_log_lines.size() > log::max_recent_lines)
+			_log_lines.erase(_log_lines.begin(), _log_lines.end() - log::max_recent_lines);
 
 		ImGuiListClipper clipper;
 		clipper.Begin(static_cast<int>(_log_lines.size()), ImGui::GetTextLineHeightWithSpacing());
@@ -4122,7 +4269,7 @@ void reshade::runtime::draw_variable_editor()
 		{
 			// Reset all uniform variables
 			for (uniform &variable_it : effect.uniforms)
-				if (variable_it.special == special_uniform::none && !variable_it.annotation_as_uint("noreset"))
+				if (variable_it.special == special_uniform::none && !variable_it.noreset)
 				{
 					if (_ui_bind_support && !variable_it.annotation_as_string("ui_bind").empty())
 					{
@@ -4219,7 +4366,7 @@ void reshade::runtime::draw_variable_editor()
 			reshade::uniform &variable = effect.uniforms[variable_index];
 
 			// Skip hidden and special variables
-			if (variable.annotation_as_int("hidden") || variable.special != special_uniform::none)
+			if (variable.hidden || variable.special != special_uniform::none)
 			{
 				if (variable.special == special_uniform::overlay_active)
 					active_variable_index = variable_index;
@@ -4269,7 +4416,7 @@ void reshade::runtime::draw_variable_editor()
 									_("Do you really want to reset all values in '%s' to their defaults?"), current_category.c_str()))
 							{
 								for (uniform &variable_it : effect.uniforms)
-									if (variable_it.special == special_uniform::none && !variable_it.annotation_as_uint("noreset") &&
+									if (variable_it.special == special_uniform::none && !variable_it.noreset &&
 										variable_it.annotation_as_string("ui_category") == category)
 									{
 										if (_ui_bind_support && effect.definition_bindings.count(variable.name))
@@ -4402,7 +4549,7 @@ void reshade::runtime::draw_variable_editor()
 					ImGui::PopTextWrapPos();
 				}
 
-				ImGui::BeginDisabled(variable.annotation_as_uint("noedit") != 0);
+				ImGui::BeginDisabled(variable.noedit);
 
 				std::string_view label = get_localized_annotation(variable, "ui_label", _current_language);
 				if (label.empty())
@@ -4591,7 +4738,7 @@ void reshade::runtime::draw_variable_editor()
 				ImGui::EndPopup();
 			}
 
-			if (!is_default_value && !variable.annotation_as_uint("noreset"))
+			if (!is_default_value && !variable.noreset)
 			{
 				ImGui::SameLine();
 				if (ImGui::SmallButton(ICON_FK_UNDO))
@@ -4617,7 +4764,7 @@ void reshade::runtime::draw_variable_editor()
 			ImGui::PopID();
 
 			// A value has changed, so save the current preset
-			if (modified && !variable.annotation_as_uint("nosave"))
+			if (modified && !variable.nosave)
 			{
 				if (_aurora_feature == 4 && _current_flair != ":" && !effect.flair_touched)
 					effect.flair_touched = true;
@@ -4987,7 +5134,7 @@ void reshade::runtime::draw_technique_editor()
 				ImGui::Separator();
 
 			// Prevent user from disabling the technique when it is set to always be enabled via annotation
-			const bool force_enabled = tech.annotation_as_int("enabled");
+			const bool force_enabled = tech.force_enabled;
 
 #if RESHADE_ADDON
 			if (bool was_enabled = tech.enabled;
@@ -4998,7 +5145,7 @@ void reshade::runtime::draw_technique_editor()
 			else
 #endif
 			{
-				ImGui::BeginDisabled(tech.annotation_as_uint("noedit") != 0);
+				ImGui::BeginDisabled(tech.noedit);
 
 				// Gray out disabled techniques
 				ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(tech.enabled ? ImGuiCol_Text : ImGuiCol_TextDisabled));
@@ -5099,6 +5246,20 @@ void reshade::runtime::draw_technique_editor()
 						_preset_is_modified = true;
 				}
 
+				ImGui::SetNextItemWidth(18.0f * _font_size);
+				if (int update_rate = static_cast<int>(tech.update_rate);
+					ImGui::SliderInt("##update_rate", &update_rate, 1, 8, update_rate > 1 ? _("Update every %d frames") : _("Update every frame"), ImGuiSliderFlags_AlwaysClamp))
+				{
+					tech.update_rate = static_cast<unsigned int>(update_rate);
+
+					if (_auto_save_preset)
+						save_current_preset();
+					else
+						_preset_is_modified = true;
+				}
+				if (_gpu_time_budget > 0.0f && tech.governor_update_rate > 1)
+					ImGui::SetItemTooltip(_("Currently updated every %u frames to stay within the GPU time budget."), tech.governor_update_rate);
+
 				const bool is_not_top = index > 0;
 				const bool is_not_bottom = index < _technique_sorting.size() - 1;
 
@@ -5340,7 +5501,7 @@ void reshade::runtime::draw_technique_editor()
 				dup_effect.included_files = _effects[make_effect_dup].included_files;
 				dup_effect.dup_id = std::move(make_dup_name);
 				_effects.emplace_back(dup_effect);
-				load_effect(dup_effect.source_file, ini_file::load_cache(_current_preset_path), _effects.size() - 1, 0, true, true);
+				load_effect(dup_effect.source_file, ini_file::load_cache(_current_preset_path), _effects.size() - 1, 0, true);
 #if RESHADE_ADDON
 				invoke_addon_event<addon_event::reshade_reloaded_effects>(this);
 #endif
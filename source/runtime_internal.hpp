@@ -7,9 +7,40 @@
 
 #include "effect_module.hpp"
 #include "moving_average.hpp"
+#include <chrono>
+#include <thread>
+#include <cstring> // std::memcmp
+#include <numeric> // std::iota
 
 namespace reshade
 {
+	/// <summary>
+	/// Order of a list of annotations sorted by name, so that looking up an annotation is a binary search instead of a linear search with string comparisons.
+	/// Has to be updated whenever the list of annotations changes.
+	/// </summary>
+	struct annotation_index
+	{
+		void update(const std::vector<reshadefx::annotation> &annotations)
+		{
+			sorted.resize(annotations.size());
+			std::iota(sorted.begin(), sorted.end(), 0u);
+			// Keep order of annotations with the same name, so that the first one is found like before
+			std::stable_sort(sorted.begin(), sorted.end(),
+				[&annotations](uint32_t lhs, uint32_t rhs) { return annotations[lhs].name < annotations[rhs].name; });
+		}
+
+		const reshadefx::annotation *find(const std::vector<reshadefx::annotation> &annotations, const std::string_view name) const
+		{
+			assert(sorted.size() == annotations.size());
+
+			const auto it = std::lower_bound(sorted.cbegin(), sorted.cend(), name,
+				[&annotations](uint32_t index, const std::string_view name) { return annotations[index].name < name; });
+			return it != sorted.cend() && annotations[*it].name == name ? &annotations[*it] : nullptr;
+		}
+
+		std::vector<uint32_t> sorted;
+	};
+
 	enum class special_uniform
 	{
 		none,
@@ -33,34 +64,37 @@ namespace reshade
 
 	struct texture : reshadefx::texture
 	{
-		texture(const reshadefx::texture &init) : reshadefx::texture(init) {}
+		texture(const reshadefx::texture &init) : reshadefx::texture(init) { update_annotations(); }
+
+		void update_annotations()
+		{
+			annotation_lookup.update(annotations);
+
+			pooled = annotation_as_int("pooled") != 0;
+		}
 
 		auto annotation_as_int(const std::string_view ann_name, size_t i = 0, int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_int[i] : static_cast<int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_uint(const std::string_view ann_name, size_t i = 0, unsigned int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_uint[i] : static_cast<unsigned int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_float(const std::string_view ann_name, size_t i = 0, float default_value = 0.0f) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_floating_point() ? it->value.as_float[i] : static_cast<float>(it->value.as_int[i])) : default_value;
 		}
 		auto annotation_as_string(const std::string_view ann_name, const std::string_view default_value = std::string_view()) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() ? std::string_view(it->value.string_data) : default_value;
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr ? std::string_view(it->value.string_data) : default_value;
 		}
 
 		bool matches_description(const reshadefx::texture &desc) const
@@ -70,8 +104,13 @@ namespace reshade
 
 		size_t effect_index = std::numeric_limits<size_t>::max();
 
+		annotation_index annotation_lookup;
+
 		std::vector<size_t> shared;
+		std::vector<size_t> aliased; // Effects in 'shared' that only use this texture in place of a transient texture of their own
 		bool loaded = false;
+		bool pooled = false;
+		bool transient = false;
 
 		api::resource resource = {};
 		api::resource_view srv[2] = {};
@@ -81,34 +120,40 @@ namespace reshade
 
 	struct uniform : reshadefx::uniform
 	{
-		uniform(const reshadefx::uniform &init) : reshadefx::uniform(init) {}
+		uniform(const reshadefx::uniform &init) : reshadefx::uniform(init) { update_annotations(); }
+
+		void update_annotations()
+		{
+			annotation_lookup.update(annotations);
+
+			hidden = annotation_as_int("hidden") != 0;
+			nosave = annotation_as_uint("nosave") != 0;
+			noedit = annotation_as_uint("noedit") != 0;
+			noreset = annotation_as_uint("noreset") != 0;
+		}
 
 		auto annotation_as_int(const std::string_view ann_name, size_t i = 0, int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_int[i] : static_cast<int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_uint(const std::string_view ann_name, size_t i = 0, unsigned int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_uint[i] : static_cast<unsigned int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_float(const std::string_view ann_name, size_t i = 0, float default_value = 0.0f) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_floating_point() ? it->value.as_float[i] : static_cast<float>(it->value.as_int[i])) : default_value;
 		}
 		auto annotation_as_string(const std::string_view ann_name, const std::string_view default_value = std::string_view()) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr ?
 				std::string_view(it->value.string_data) : default_value;
 		}
 
@@ -122,10 +167,17 @@ namespace reshade
 			return ui_type == "list" || ui_type == "combo" || ui_type == "radio";
 		}
 
+		annotation_index annotation_lookup;
+
 		size_t effect_index = std::numeric_limits<size_t>::max();
 		unsigned int toggle_key_data[4] = {};
 
 		special_uniform special = special_uniform::none;
+
+		bool hidden = false;
+		bool nosave = false;
+		bool noedit = false;
+		bool noreset = false;
 	};
 
 	struct technique
@@ -134,43 +186,61 @@ namespace reshade
 		size_t effect_index = std::numeric_limits<size_t>::max();
 
 		std::vector<reshadefx::annotation> annotations;
+		annotation_index annotation_lookup;
+
+		void update_annotations()
+		{
+			annotation_lookup.update(annotations);
+
+			nosave = annotation_as_uint("nosave") != 0;
+			noedit = annotation_as_uint("noedit") != 0;
+			force_enabled = annotation_as_int("enabled") != 0;
+			enabled_in_screenshot = annotation_as_int("enabled_in_screenshot", 0, true) != 0;
+			timeout = annotation_as_int("timeout");
+		}
 
 		auto annotation_as_int(const std::string_view ann_name, size_t i = 0, int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_int[i] : static_cast<int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_uint(const std::string_view ann_name, size_t i = 0, unsigned int default_value = 0) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_integral() ? it->value.as_uint[i] : static_cast<unsigned int>(it->value.as_float[i])) : default_value;
 		}
 		auto annotation_as_float(const std::string_view ann_name, size_t i = 0, float default_value = 0.0f) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() && i < 16 ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr && i < 16 ?
 				(it->type.is_floating_point() ? it->value.as_float[i] : static_cast<float>(it->value.as_int[i])) : default_value;
 		}
 		auto annotation_as_string(const std::string_view ann_name, const std::string_view default_value = std::string_view()) const
 		{
-			const auto it = std::find_if(annotations.cbegin(), annotations.cend(),
-				[ann_name](const reshadefx::annotation &annotation) { return annotation.name == ann_name; });
-			return it != annotations.cend() ?
+			const reshadefx::annotation *const it = annotation_lookup.find(annotations, ann_name);
+			return it != nullptr ?
 				std::string_view(it->value.string_data) : default_value;
 		}
 
 		unsigned int toggle_key_data[4] = {};
 
 		bool hidden = false;
+		bool nosave = false;
+		bool noedit = false;
 		bool enabled = false;
+		bool force_enabled = false;
 		bool enabled_in_screenshot = true;
+		int timeout = 0;
 		int64_t time_left = 0;
 
+		// Number of frames between full updates of the technique, in between only passes that write to the back buffer are executed and reuse the output of the other passes from the last full update
+		unsigned int update_rate = 1;
+		unsigned int governor_update_rate = 1;
+		uint64_t last_update_frame = std::numeric_limits<uint64_t>::max();
+		api::resource last_update_target = {};
+
 		struct pass : public reshadefx::pass
 		{
 			pass(const reshadefx::pass &init) : reshadefx::pass(init) {}
@@ -180,13 +250,23 @@ namespace reshade
 			api::descriptor_table texture_table = {};
 			api::descriptor_table storage_table = {};
 			std::vector<api::resource> modified_resources;
+			std::vector<api::resource> sampled_resources;
 			std::vector<api::resource_view> generate_mipmap_views;
+			bool reads_back_buffer = false;
+			bool writes_back_buffer = false;
+			bool samples_semantic_texture = false;
+			bool modifies_aliased_texture = false;
 		};
 
 		struct permutation
 		{
 			std::vector<pass> passes;
 			bool created = false;
+
+			// Techniques that only consist of compute passes which neither access textures provided from outside the effect nor generate mipmaps can run on the async compute queue
+			bool async_compute = false;
+			bool accesses_aliased_texture = false;
+			std::vector<api::resource> accessed_resources;
 		};
 
 		std::vector<permutation> permutations;
@@ -196,6 +276,163 @@ namespace reshade
 		moving_average<uint64_t, 60> average_gpu_duration;
 	};
 
+	/// <summary>
+	/// Tracks the descriptor tables, viewport and scissor rectangle the effect runtime last bound on a command list, so that binding the same state again for consecutive passes can be skipped.
+	/// Pipelines are not tracked, since every pass has its own.
+	/// </summary>
+	struct bind_state_tracker
+	{
+		void bind_descriptor_table(api::command_list *cmd_list, api::shader_stage stages, api::pipeline_layout layout, uint32_t param, api::descriptor_table table)
+		{
+			assert(param < 4);
+
+			const size_t type = stages == api::shader_stage::all_compute ? 1 : 0;
+			if (layouts[type] != layout)
+			{
+				// Switching the layout invalidates all tables bound with the previous one
+				layouts[type] = layout;
+				std::fill_n(tables[type], 4, api::descriptor_table { 0 });
+			}
+			else if (tables[type][param] == table && table != 0)
+			{
+				skipped++;
+				return;
+			}
+
+			cmd_list->bind_descriptor_table(stages, layout, param, table);
+			tables[type][param] = table;
+			issued++;
+		}
+
+		void bind_viewport(api::command_list *cmd_list, const api::viewport &viewport)
+		{
+			if (viewport_valid && std::memcmp(&viewport, &last_viewport, sizeof(viewport)) == 0)
+			{
+				skipped++;
+				return;
+			}
+
+			cmd_list->bind_viewports(0, 1, &viewport);
+			last_viewport = viewport;
+			viewport_valid = true;
+			issued++;
+		}
+
+		void bind_scissor_rect(api::command_list *cmd_list, const api::rect &scissor_rect)
+		{
+			if (scissor_rect_valid && std::memcmp(&scissor_rect, &last_scissor_rect, sizeof(scissor_rect)) == 0)
+			{
+				skipped++;
+				return;
+			}
+
+			cmd_list->bind_scissor_rects(0, 1, &scissor_rect);
+			last_scissor_rect = scissor_rect;
+			scissor_rect_valid = true;
+			issued++;
+		}
+
+		/// <summary>
+		/// Forgets all tracked state, so that the next binds are issued again. Needs to be called whenever something other than this tracker may have changed bindings on the command list.
+		/// </summary>
+		void invalidate()
+		{
+			std::fill_n(layouts, 2, api::pipeline_layout { 0 });
+			std::fill_n(tables[0], 4, api::descriptor_table { 0 });
+			std::fill_n(tables[1], 4, api::descriptor_table { 0 });
+			invalidate_viewport_and_scissor_rect();
+		}
+		void invalidate_viewport_and_scissor_rect()
+		{
+			viewport_valid = false;
+			scissor_rect_valid = false;
+		}
+
+		api::pipeline_layout layouts[2] = {};
+		api::descriptor_table tables[2][4] = {};
+		api::viewport last_viewport = {};
+		api::rect last_scissor_rect = {};
+		bool viewport_valid = false;
+		bool scissor_rect_valid = false;
+
+		uint32_t issued = 0;
+		uint32_t skipped = 0;
+	};
+
+	enum class effect_load_phase
+	{
+		cache_io,
+		preprocess,
+		parse,
+		codegen,
+		compile,
+		pipeline_creation,
+		texture_load,
+		count
+	};
+
+	inline const char *effect_load_phase_name(effect_load_phase phase)
+	{
+		switch (phase)
+		{
+		case effect_load_phase::cache_io:
+			return "Cache I/O";
+		case effect_load_phase::preprocess:
+			return "Preprocess";
+		case effect_load_phase::parse:
+			return "Parse";
+		case effect_load_phase::codegen:
+			return "Code generation";
+		case effect_load_phase::compile:
+			return "Compile";
+		case effect_load_phase::pipeline_creation:
+			return "Pipeline creation";
+		case effect_load_phase::texture_load:
+			return "Texture load";
+		default:
+			return "Unknown";
+		}
+	}
+
+	/// <summary>
+	/// Result of preprocessing, parsing and compiling an effect with one particular set of preprocessor definitions.
+	/// These are kept in memory, so that switching back to a set that was used recently (e.g. by changing to another preset) does not have to repeat that work.
+	/// </summary>
+	struct compiled_effect_variant
+	{
+		size_t source_hash = 0;
+		bool skip_optimization = false;
+		std::string code_preamble;
+		std::string errors;
+
+		std::vector<std::filesystem::path> included_files;
+		std::vector<std::pair<std::string, std::string>> definitions;
+
+		// Module as returned by the code generator (before any specialization constants were filled in or textures were renamed)
+		reshadefx::effect_module module;
+		std::string generated_code;
+		std::unordered_map<std::string, std::string> entry_point_code;
+		std::unordered_map<std::string, std::string> assembly;
+		std::unordered_map<std::string, std::string> assembly_text;
+		std::unordered_map<std::string, size_t> assembly_hashes;
+
+		size_t memory_size() const
+		{
+			// Rough estimate that only accounts for the larger allocations, which is good enough to keep the cache within budget
+			size_t size = sizeof(*this) + code_preamble.size() + errors.size() + generated_code.size();
+			for (const std::pair<const std::string, std::string> &code : entry_point_code)
+				size += code.first.size() + code.second.size();
+			for (const std::pair<const std::string, std::string> &code : assembly)
+				size += code.first.size() + code.second.size();
+			for (const std::pair<const std::string, std::string> &code : assembly_text)
+				size += code.first.size() + code.second.size();
+			size += (module.uniforms.size() + module.spec_constants.size()) * sizeof(reshadefx::uniform);
+			size += module.textures.size() * sizeof(reshadefx::texture) + module.samplers.size() * sizeof(reshadefx::sampler) + module.storages.size() * sizeof(reshadefx::storage);
+			size += module.techniques.size() * sizeof(reshadefx::technique);
+			return size;
+		}
+	};
+
 	struct effect
 	{
 		std::filesystem::path source_file;
@@ -215,6 +452,22 @@ namespace reshade
 		std::vector<uint8_t> uniform_data_storage;
 		api::resource cb = {};
 
+		struct special_uniform_update
+		{
+			special_uniform special;
+			size_t uniform_index;
+			uint32_t offset;
+			uint32_t components;
+			bool floating_point;
+			bool direct; // Arrays and matrices are padded in the uniform storage, so cannot be written to directly
+			uint8_t key_mode; // 0 = down, 1 = press, 2 = toggle
+			int int_params[2]; // Minimum and maximum for random values, key code for keys and mouse buttons
+			float float_params[5]; // Minimum, maximum, step range and smoothing for ping-pong values, minimum, maximum and step for mouse wheel values
+		};
+
+		// Special uniform variables with their annotations already evaluated, so that updating them every frame does not have to go through all variables
+		std::vector<special_uniform_update> special_uniform_updates;
+
 		struct binding
 		{
 			std::string semantic;
@@ -231,6 +484,10 @@ namespace reshade
 			std::unordered_map<std::string, std::string> assembly;
 			std::unordered_map<std::string, std::string> assembly_text;
 
+			// Hashes of the compiler input, used to share work with the first permutation when it turns out to be identical
+			size_t source_hash = 0;
+			std::unordered_map<std::string, size_t> assembly_hashes;
+
 			api::pipeline_layout layout = {};
 			api::descriptor_table cb_table = {};
 			api::descriptor_table sampler_table = {};
@@ -242,8 +499,20 @@ namespace reshade
 
 		api::query_heap query_heap = {};
 
+		struct load_timing
+		{
+			effect_load_phase phase;
+			size_t permutation_index;
+			std::thread::id thread_id;
+			std::chrono::high_resolution_clock::time_point start;
+			std::chrono::high_resolution_clock::time_point end;
+		};
+
+		std::vector<load_timing> load_timings; // Appended to by multiple loading threads, so only modify through 'runtime::record_load_timing'
+
 		std::unordered_map<std::string, std::pair<std::string, std::string>> definition_bindings;
 		std::string dup_id = "";
 		bool flair_touched = false;
 	};
+
 }
@@ -461,6 +461,9 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 	INIT_DISPATCH_PTR(DestroyImageView);
 	INIT_DISPATCH_PTR(CreateShaderModule);
 	INIT_DISPATCH_PTR(DestroyShaderModule);
+	INIT_DISPATCH_PTR(CreatePipelineCache);
+	INIT_DISPATCH_PTR(DestroyPipelineCache);
+	INIT_DISPATCH_PTR(GetPipelineCacheData);
 	INIT_DISPATCH_PTR(CreateGraphicsPipelines);
 	INIT_DISPATCH_PTR(CreateComputePipelines);
 	INIT_DISPATCH_PTR(DestroyPipeline);
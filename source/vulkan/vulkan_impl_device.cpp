@@ -141,6 +141,8 @@ reshade::vulkan::device_impl::~device_impl()
 
 	vk.DestroyPrivateDataSlot(_orig, _private_data_slot, nullptr);
 
+	vk.DestroyPipelineCache(_orig, _pipeline_cache, nullptr);
+
 	vk.DestroyDescriptorPool(_orig, _descriptor_pool, nullptr);
 	for (uint32_t i = 0; i < 4; ++i)
 		vk.DestroyDescriptorPool(_orig, _transient_descriptor_pool[i], nullptr);
@@ -1088,6 +1090,17 @@ bool reshade::vulkan::device_impl::create_shader_module(VkShaderStageFlagBits st
 
 bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline)
 {
+	return create_pipeline(layout, subobject_count, subobjects, out_pipeline, false);
+}
+bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline, bool use_pipeline_cache)
+{
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	if (use_pipeline_cache)
+	{
+		const std::shared_lock<std::shared_mutex> lock(_pipeline_cache_mutex);
+		pipeline_cache = _pipeline_cache;
+	}
+
 	VkRenderPass render_pass = VK_NULL_HANDLE;
 	std::vector<VkShaderModule> shaders;
 
@@ -1467,8 +1480,12 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateComputePipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateComputePipelines(_orig, pipeline_cache, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
+			// There is no telling whether the cache was hit, so assume the cache changed whenever it was used
+			if (pipeline_cache != VK_NULL_HANDLE)
+				_pipeline_cache_generation.fetch_add(1, std::memory_order_relaxed);
+
 			vk.DestroyShaderModule(_orig, create_info.stage.module, nullptr);
 
 			*out_pipeline = { (uint64_t)object };
@@ -1726,8 +1743,11 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateGraphicsPipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateGraphicsPipelines(_orig, pipeline_cache, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
+			if (pipeline_cache != VK_NULL_HANDLE)
+				_pipeline_cache_generation.fetch_add(1, std::memory_order_relaxed);
+
 			if (render_pass != VK_NULL_HANDLE)
 				vk.DestroyRenderPass(_orig, render_pass, nullptr);
 
@@ -2367,6 +2387,43 @@ bool reshade::vulkan::device_impl::get_pipeline_shader_group_handles(api::pipeli
 	return vk.GetRayTracingShaderGroupHandlesKHR(_orig, (VkPipeline)pipeline.handle, first, count, static_cast<size_t>(count) * static_cast<size_t>(handle_size), out_handles) == VK_SUCCESS;
 }
 
+bool reshade::vulkan::device_impl::create_pipeline_cache(const std::string &initial_data)
+{
+	const std::unique_lock<std::shared_mutex> lock(_pipeline_cache_mutex);
+
+	if (_pipeline_cache != VK_NULL_HANDLE)
+		return true;
+
+	// Implementations ignore initial data that is incompatible with the current device or driver, so it is safe to pass in whatever was stored previously
+	VkPipelineCacheCreateInfo create_info { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	create_info.initialDataSize = initial_data.size();
+	create_info.pInitialData = initial_data.data();
+
+	return vk.CreatePipelineCache(_orig, &create_info, nullptr, &_pipeline_cache) == VK_SUCCESS;
+}
+bool reshade::vulkan::device_impl::get_pipeline_cache_data(std::string &data) const
+{
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	{
+		const std::shared_lock<std::shared_mutex> lock(_pipeline_cache_mutex);
+		pipeline_cache = _pipeline_cache;
+	}
+
+	if (pipeline_cache == VK_NULL_HANDLE)
+		return false;
+
+	size_t size = 0;
+	if (vk.GetPipelineCacheData(_orig, pipeline_cache, &size, nullptr) != VK_SUCCESS)
+		return false;
+
+	data.resize(size);
+	if (vk.GetPipelineCacheData(_orig, pipeline_cache, &size, data.data()) < VK_SUCCESS)
+		return false;
+	data.resize(size);
+
+	return true;
+}
+
 void reshade::vulkan::device_impl::advance_transient_descriptor_pool()
 {
 	if (_push_descriptor_ext)
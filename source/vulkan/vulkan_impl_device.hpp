@@ -12,6 +12,7 @@
 #include <vk_layer_dispatch_table.h>
 
 #include "reshade_api_object_impl.hpp"
+#include <atomic>
 #include <shared_mutex>
 #include <unordered_map>
 
@@ -72,6 +73,7 @@ namespace reshade::vulkan
 		void update_buffer_region(const void *data, api::resource resource, uint64_t offset, uint64_t size) final;
 		void update_texture_region(const api::subresource_data &data, api::resource resource, uint32_t subresource, const api::subresource_box *box) final;
 
+		bool create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline, bool use_pipeline_cache);
 		bool create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline) final;
 		void destroy_pipeline(api::pipeline pipeline) final;
 
@@ -106,6 +108,10 @@ namespace reshade::vulkan
 
 		bool get_pipeline_shader_group_handles(api::pipeline pipeline, uint32_t first, uint32_t count, void *out_handles) final;
 
+		bool create_pipeline_cache(const std::string &initial_data);
+		bool get_pipeline_cache_data(std::string &data) const;
+		uint32_t get_pipeline_cache_generation() const { return _pipeline_cache_generation.load(std::memory_order_relaxed); }
+
 		void advance_transient_descriptor_pool();
 
 		command_list_immediate_impl *get_immediate_command_list();
@@ -176,6 +182,11 @@ namespace reshade::vulkan
 
 		VkPrivateDataSlot _private_data_slot = VK_NULL_HANDLE;
 
+		// Only guards creation of the cache, since pipeline caches are internally synchronized
+		mutable std::shared_mutex _pipeline_cache_mutex;
+		VkPipelineCache _pipeline_cache = VK_NULL_HANDLE;
+		std::atomic<uint32_t> _pipeline_cache_generation = 0;
+
 		std::shared_mutex _mutex;
 		std::unordered_map<size_t, VkRenderPassBeginInfo> _render_pass_lookup;
 	};
@@ -7,8 +7,43 @@
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
 #include "version.h"
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <cstdio> // std::snprintf
+#include <cstring> // std::memcpy, std::strchr, std::strcmp
+
+static size_t count_spirv_instructions(const std::basic_string<char> &spirv)
+{
+	size_t count = 0;
+
+	// Skip the 5 word header and then walk the instruction stream (the high 16 bits of the first word of each instruction are its word count)
+	for (size_t offset = 5 * sizeof(uint32_t); offset + sizeof(uint32_t) <= spirv.size(); ++count)
+	{
+		uint32_t word;
+		std::memcpy(&word, spirv.data() + offset, sizeof(word));
+
+		const uint32_t word_count = word >> 16;
+		if (word_count == 0)
+			break;
+
+		offset += word_count * sizeof(uint32_t);
+	}
+
+	return count;
+}
+
+struct phase_timing
+{
+	std::string name;
+	std::chrono::high_resolution_clock::time_point start;
+	std::chrono::high_resolution_clock::time_point end;
+};
+
+static void record_phase_timing(std::vector<phase_timing> &timings, std::string name, std::chrono::high_resolution_clock::time_point start)
+{
+	timings.push_back({ std::move(name), start, std::chrono::high_resolution_clock::now() });
+}
 
 static void print_usage(const char *path)
 {
@@ -35,6 +70,11 @@ Options:
   --spec-constants          Convert uniform variables to specialization constants.
   --vulkan-semantics        Generate GLSL/SPIR-V code under Vulkan semantics, instead of OpenGL semantics.
 
+  -O                        Run the built-in SPIR-V optimization passes.
+  --stats                   Print the SPIR-V instruction count of the module and each entry point (before and after optimization with -O).
+  --time                    Print the time spent preprocessing, parsing and generating code for the module and each entry point.
+  --trace <file>            Write the same timings as a Chrome trace event file (can be opened with "chrome://tracing" or Perfetto).
+
   -Zi                       Enable debug information.
 	)", path);
 }
@@ -45,6 +85,7 @@ int main(int argc, char *argv[])
 	const char *preprocess = nullptr;
 	const char *errorfile = nullptr;
 	const char *objectfile = nullptr;
+	const char *tracefile = nullptr;
 	const char *buffer_width = "800";
 	const char *buffer_height = "600";
 	bool print_glsl = false;
@@ -53,6 +94,9 @@ int main(int argc, char *argv[])
 	bool invert_y_axis = false;
 	bool spec_constants = false;
 	bool vulkan_semantics = false;
+	bool optimize = false;
+	bool print_stats = false;
+	bool print_timings = false;
 	unsigned int shader_model = 50;
 
 	reshadefx::preprocessor pp;
@@ -102,6 +146,12 @@ int main(int argc, char *argv[])
 				spec_constants = true;
 			else if (0 == std::strcmp(arg, "--vulkan-semantics"))
 				vulkan_semantics = true;
+			else if (0 == std::strcmp(arg, "-O"))
+				optimize = true;
+			else if (0 == std::strcmp(arg, "--stats"))
+				print_stats = true;
+			else if (0 == std::strcmp(arg, "--time"))
+				print_timings = true;
 
 			if (i + 1 >= argc)
 				continue;
@@ -111,6 +161,8 @@ int main(int argc, char *argv[])
 				errorfile = argv[++i];
 			else if (0 == std::strcmp(arg, "-Fo"))
 				objectfile = argv[++i];
+			else if (0 == std::strcmp(arg, "--trace"))
+				tracefile = argv[++i];
 			else if (0 == std::strcmp(arg, "--shader-model"))
 				shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
 			else if (0 == std::strcmp(arg, "--width"))
@@ -141,7 +193,13 @@ int main(int argc, char *argv[])
 	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
 	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
 
-	if (!pp.append_file(filename))
+	std::vector<phase_timing> timings;
+
+	const std::chrono::high_resolution_clock::time_point time_preprocess_started = std::chrono::high_resolution_clock::now();
+	const bool preprocessed = pp.append_file(filename);
+	record_phase_timing(timings, "Preprocess", time_preprocess_started);
+
+	if (!preprocessed)
 	{
 		if (errorfile == nullptr)
 			std::cout << pp.errors() << std::endl;
@@ -165,10 +223,15 @@ int main(int argc, char *argv[])
 	else if (print_hlsl)
 		backend.reset(reshadefx::create_codegen_hlsl(shader_model, debug_info, spec_constants));
 	else
-		backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
+		backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, false, invert_y_axis, optimize));
 
 	reshadefx::parser parser;
-	if (!parser.parse(pp.output(), backend.get()))
+
+	const std::chrono::high_resolution_clock::time_point time_parse_started = std::chrono::high_resolution_clock::now();
+	const bool parsed = parser.parse(pp.output(), backend.get());
+	record_phase_timing(timings, "Parse", time_parse_started);
+
+	if (!parsed)
 	{
 		if (errorfile == nullptr)
 			std::cout << pp.errors() << parser.errors() << std::endl;
@@ -177,7 +240,78 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
+	const std::chrono::high_resolution_clock::time_point time_codegen_started = std::chrono::high_resolution_clock::now();
 	std::basic_string<char> code = backend->finalize_code();
+	record_phase_timing(timings, "Code generation", time_codegen_started);
+
+	if (print_timings || tracefile != nullptr)
+	{
+		// The runtime generates code separately for every entry point, so measure that too
+		for (const std::pair<std::string, reshadefx::shader_type> &entry_point : backend->module().entry_points)
+		{
+			const std::chrono::high_resolution_clock::time_point time_entry_point_codegen_started = std::chrono::high_resolution_clock::now();
+			backend->finalize_code_for_entry_point(entry_point.first);
+			record_phase_timing(timings, "Code generation (" + entry_point.first + ')', time_entry_point_codegen_started);
+		}
+	}
+
+	if (print_timings)
+	{
+		for (const phase_timing &timing : timings)
+			printf("%-48s %10.3f ms\n", timing.name.c_str(), std::chrono::duration_cast<std::chrono::nanoseconds>(timing.end - timing.start).count() * 1e-6);
+	}
+
+	if (tracefile != nullptr)
+	{
+		std::ofstream trace(tracefile);
+		trace << "{\"traceEvents\":[";
+
+		for (size_t i = 0; i < timings.size(); ++i)
+		{
+			char event[128];
+			std::snprintf(event, sizeof(event), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+				std::chrono::duration_cast<std::chrono::nanoseconds>(timings[i].start - timings[0].start).count() * 1e-3,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(timings[i].end - timings[i].start).count() * 1e-3);
+
+			// Entry point names only consist of identifier characters, so do not need escaping
+			trace << (i != 0 ? ",\n" : "\n") << "{\"name\":\"" << timings[i].name << event;
+		}
+
+		trace << "\n]}\n";
+	}
+
+	if (print_stats && !print_glsl && !print_hlsl)
+	{
+		// Compile the same source again without optimization to be able to compare against it
+		std::unique_ptr<reshadefx::codegen> reference_backend;
+		if (optimize)
+		{
+			reference_backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, false, invert_y_axis, false));
+
+			reshadefx::parser reference_parser;
+			reference_parser.parse(pp.output(), reference_backend.get());
+		}
+
+		const auto print_instruction_count = [&reference_backend](const std::string &name, const std::basic_string<char> &optimized_code, const std::basic_string<char> &reference_code) {
+			const size_t count = count_spirv_instructions(optimized_code);
+			if (reference_backend == nullptr)
+			{
+				printf("%-32s %8zu instructions\n", name.c_str(), count);
+				return;
+			}
+
+			const size_t reference_count = count_spirv_instructions(reference_code);
+			printf("%-32s %8zu -> %8zu instructions (%+.1f%%)\n", name.c_str(), reference_count, count,
+				reference_count != 0 ? (static_cast<double>(count) - static_cast<double>(reference_count)) * 100.0 / reference_count : 0.0);
+		};
+
+		print_instruction_count("<module>", code, reference_backend != nullptr ? reference_backend->finalize_code() : std::basic_string<char>());
+
+		for (const std::pair<std::string, reshadefx::shader_type> &entry_point : backend->module().entry_points)
+			print_instruction_count(entry_point.first,
+				backend->finalize_code_for_entry_point(entry_point.first),
+				reference_backend != nullptr ? reference_backend->finalize_code_for_entry_point(entry_point.first) : std::basic_string<char>());
+	}
 
 	if (print_glsl || print_hlsl)
 	{